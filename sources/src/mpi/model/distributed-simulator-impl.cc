@@ -176,14 +176,29 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
           for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
             {
               Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
-              // only works for p2p links currently
-              if (!localNetDevice->IsPointToPoint ())
+              Ptr<Channel> channel = localNetDevice->GetChannel ();
+              if (channel == 0)
                 {
                   continue;
                 }
-              Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
+
+              // shared channels that span several systems announce the
+              // smallest delay of their remote receptions themselves
+              if (!localNetDevice->IsPointToPoint ())
                 {
+                  struct TypeId::AttributeInformation info;
+                  if (!channel->GetInstanceTypeId ().LookupAttributeByName ("Lookahead", &info))
+                    {
+                      continue;
+                    }
+                  TimeValue lookAhead;
+                  channel->GetAttribute ("Lookahead", lookAhead);
+                  if (lookAhead.Get ().IsStrictlyPositive ()
+                      && lookAhead.Get () < DistributedSimulatorImpl::m_lookAhead)
+                    {
+                      DistributedSimulatorImpl::m_lookAhead = lookAhead.Get ();
+                      m_grantedTime = lookAhead.Get ();
+                    }
                   continue;
                 }
 
@@ -28,6 +28,7 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include <algorithm>
 #include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("PropagationLossModel");
@@ -38,6 +39,10 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (PropagationLossModel);
 
+// The epochs of all models are taken from a single counter, such that the
+// latest epoch within a chain advances with every change of any of its models
+static uint64_t g_changeEpoch = 0;
+
 TypeId 
 PropagationLossModel::GetTypeId (void)
 {
@@ -48,7 +53,8 @@ PropagationLossModel::GetTypeId (void)
 }
 
 PropagationLossModel::PropagationLossModel ()
-  : m_next (0)
+  : m_next (0),
+    m_changeEpoch (0)
 {
 }
 
@@ -60,6 +66,7 @@ void
 PropagationLossModel::SetNext (Ptr<PropagationLossModel> next)
 {
   m_next = next;
+  NotifyChange ();
 }
 
 Ptr<PropagationLossModel>
@@ -81,6 +88,77 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+void
+PropagationLossModel::CalcRxPower (double txPowerDbm,
+                                   Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const std::vector<double> &x,
+                                   const std::vector<double> &y,
+                                   const std::vector<double> &z,
+                                   std::vector<double> &rxPowerDbm) const
+{
+  NS_ASSERT (x.size () == b.size () && y.size () == b.size () && z.size () == b.size ());
+  rxPowerDbm.assign (b.size (), txPowerDbm);
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      model->DoCalcRxPower (a, b, x, y, z, rxPowerDbm);
+    }
+}
+
+void
+PropagationLossModel::DoCalcRxPower (Ptr<MobilityModel> a,
+                                     const std::vector<Ptr<MobilityModel> > &b,
+                                     const std::vector<double> &x,
+                                     const std::vector<double> &y,
+                                     const std::vector<double> &z,
+                                     std::vector<double> &rxPowerDbm) const
+{
+  for (uint32_t i = 0; i < b.size (); i++)
+    {
+      rxPowerDbm[i] = DoCalcRxPower (rxPowerDbm[i], a, b[i]);
+    }
+}
+
+bool
+PropagationLossModel::IsDeterministic (void) const
+{
+  return false;
+}
+
+double
+PropagationLossModel::CalcDeterministicRxPower (double txPowerDbm,
+                                                Ptr<MobilityModel> a,
+                                                Ptr<MobilityModel> b,
+                                                Ptr<PropagationLossModel> &rest) const
+{
+  const PropagationLossModel *model = this;
+  double self = txPowerDbm;
+  while (model != 0 && model->IsDeterministic ())
+    {
+      self = model->DoCalcRxPower (self, a, b);
+      model = PeekPointer (model->m_next);
+    }
+  rest = const_cast<PropagationLossModel *> (model);
+  return self;
+}
+
+uint64_t
+PropagationLossModel::GetChangeEpoch (void) const
+{
+  uint64_t epoch = 0;
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      epoch = std::max (epoch, model->m_changeEpoch);
+    }
+  return epoch;
+}
+
+void
+PropagationLossModel::NotifyChange (void)
+{
+  m_changeEpoch = ++g_changeEpoch;
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -156,7 +234,8 @@ FriisPropagationLossModel::GetTypeId (void)
                    MakeDoubleChecker<double> ())
     .AddAttribute ("SystemLoss", "The system loss",
                    DoubleValue (1.0),
-                   MakeDoubleAccessor (&FriisPropagationLossModel::m_systemLoss),
+                   MakeDoubleAccessor (&FriisPropagationLossModel::SetSystemLoss,
+                                       &FriisPropagationLossModel::GetSystemLoss),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("MinDistance", 
                    "The distance under which the propagation model refuses to give results (m)",
@@ -175,6 +254,7 @@ void
 FriisPropagationLossModel::SetSystemLoss (double systemLoss)
 {
   m_systemLoss = systemLoss;
+  NotifyChange ();
 }
 double
 FriisPropagationLossModel::GetSystemLoss (void) const
@@ -185,6 +265,7 @@ void
 FriisPropagationLossModel::SetMinDistance (double minDistance)
 {
   m_minDistance = minDistance;
+  NotifyChange ();
 }
 double
 FriisPropagationLossModel::GetMinDistance (void) const
@@ -198,6 +279,7 @@ FriisPropagationLossModel::SetFrequency (double frequency)
   m_frequency = frequency;
   static const double C = 299792458.0; // speed of light in vacuum
   m_lambda = C / frequency;
+  NotifyChange ();
 }
 
 double
@@ -266,12 +348,42 @@ FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + pr;
 }
 
+void
+FriisPropagationLossModel::DoCalcRxPower (Ptr<MobilityModel> a,
+                                          const std::vector<Ptr<MobilityModel> > &b,
+                                          const std::vector<double> &x,
+                                          const std::vector<double> &y,
+                                          const std::vector<double> &z,
+                                          std::vector<double> &rxPowerDbm) const
+{
+  // Same as the scalar version, without virtual calls or branches
+  Vector position = a->GetPosition ();
+  double numerator = m_lambda * m_lambda;
+  uint32_t n = rxPowerDbm.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = x[i] - position.x;
+      double dy = y[i] - position.y;
+      double dz = z[i] - position.z;
+      double distance = std::sqrt (dx * dx + dy * dy + dz * dz);
+      double denominator = 16 * PI * PI * distance * distance * m_systemLoss;
+      double pr = 10 * std::log10 (numerator / denominator);
+      rxPowerDbm[i] = (distance <= m_minDistance) ? rxPowerDbm[i] : rxPowerDbm[i] + pr;
+    }
+}
+
 int64_t
 FriisPropagationLossModel::DoAssignStreams (int64_t stream)
 {
   return 0;
 }
 
+bool
+FriisPropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -293,7 +405,8 @@ TwoRayGroundPropagationLossModel::GetTypeId (void)
                    MakeDoubleChecker<double> ())
     .AddAttribute ("SystemLoss", "The system loss",
                    DoubleValue (1.0),
-                   MakeDoubleAccessor (&TwoRayGroundPropagationLossModel::m_systemLoss),
+                   MakeDoubleAccessor (&TwoRayGroundPropagationLossModel::SetSystemLoss,
+                                       &TwoRayGroundPropagationLossModel::GetSystemLoss),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("MinDistance",
                    "The distance under which the propagation model refuses to give results (m)",
@@ -304,7 +417,8 @@ TwoRayGroundPropagationLossModel::GetTypeId (void)
     .AddAttribute ("HeightAboveZ",
                    "The height of the antenna (m) above the node's Z coordinate",
                    DoubleValue (0),
-                   MakeDoubleAccessor (&TwoRayGroundPropagationLossModel::m_heightAboveZ),
+                   MakeDoubleAccessor (&TwoRayGroundPropagationLossModel::SetHeightAboveZ,
+                                       &TwoRayGroundPropagationLossModel::GetHeightAboveZ),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -317,6 +431,7 @@ void
 TwoRayGroundPropagationLossModel::SetSystemLoss (double systemLoss)
 {
   m_systemLoss = systemLoss;
+  NotifyChange ();
 }
 double
 TwoRayGroundPropagationLossModel::GetSystemLoss (void) const
@@ -327,6 +442,7 @@ void
 TwoRayGroundPropagationLossModel::SetMinDistance (double minDistance)
 {
   m_minDistance = minDistance;
+  NotifyChange ();
 }
 double
 TwoRayGroundPropagationLossModel::GetMinDistance (void) const
@@ -337,6 +453,13 @@ void
 TwoRayGroundPropagationLossModel::SetHeightAboveZ (double heightAboveZ)
 {
   m_heightAboveZ = heightAboveZ;
+  NotifyChange ();
+}
+
+double
+TwoRayGroundPropagationLossModel::GetHeightAboveZ (void) const
+{
+  return m_heightAboveZ;
 }
 
 void
@@ -345,6 +468,7 @@ TwoRayGroundPropagationLossModel::SetFrequency (double frequency)
   m_frequency = frequency;
   static const double C = 299792458.0; // speed of light in vacuum
   m_lambda = C / frequency;
+  NotifyChange ();
 }
 
 double
@@ -441,12 +565,61 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+void
+TwoRayGroundPropagationLossModel::DoCalcRxPower (Ptr<MobilityModel> a,
+                                                 const std::vector<Ptr<MobilityModel> > &b,
+                                                 const std::vector<double> &x,
+                                                 const std::vector<double> &y,
+                                                 const std::vector<double> &z,
+                                                 std::vector<double> &rxPowerDbm) const
+{
+  // Same as the scalar version, without virtual calls
+  Vector position = a->GetPosition ();
+  double txAntHeight = position.z + m_heightAboveZ;
+  double numerator = m_lambda * m_lambda;
+  uint32_t n = rxPowerDbm.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = x[i] - position.x;
+      double dy = y[i] - position.y;
+      double dz = z[i] - position.z;
+      double distance = std::sqrt (dx * dx + dy * dy + dz * dz);
+      if (distance <= m_minDistance)
+        {
+          continue;
+        }
+      double rxAntHeight = z[i] + m_heightAboveZ;
+      double dCross = (4 * PI * txAntHeight * rxAntHeight) / m_lambda;
+      double tmp;
+      if (distance <= dCross)
+        {
+          tmp = PI * distance;
+          double denominator = 16 * tmp * tmp * m_systemLoss;
+          rxPowerDbm[i] += 10 * std::log10 (numerator / denominator);
+        }
+      else
+        {
+          tmp = txAntHeight * rxAntHeight;
+          double rayNumerator = tmp * tmp;
+          tmp = distance * distance;
+          double rayDenominator = tmp * tmp * m_systemLoss;
+          rxPowerDbm[i] += 10 * std::log10 (rayNumerator / rayDenominator);
+        }
+    }
+}
+
 int64_t
 TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
 {
   return 0;
 }
 
+bool
+TwoRayGroundPropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (LogDistancePropagationLossModel);
@@ -460,17 +633,20 @@ LogDistancePropagationLossModel::GetTypeId (void)
     .AddAttribute ("Exponent",
                    "The exponent of the Path Loss propagation model",
                    DoubleValue (3.0),
-                   MakeDoubleAccessor (&LogDistancePropagationLossModel::m_exponent),
+                   MakeDoubleAccessor (&LogDistancePropagationLossModel::SetPathLossExponent,
+                                       &LogDistancePropagationLossModel::GetPathLossExponent),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("ReferenceDistance",
                    "The distance at which the reference loss is calculated (m)",
                    DoubleValue (1.0),
-                   MakeDoubleAccessor (&LogDistancePropagationLossModel::m_referenceDistance),
+                   MakeDoubleAccessor (&LogDistancePropagationLossModel::SetReferenceDistance,
+                                       &LogDistancePropagationLossModel::GetReferenceDistance),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("ReferenceLoss",
                    "The reference loss at reference distance (dB). (Default is Friis at 1m with 5.15 GHz)",
                    DoubleValue (46.6777),
-                   MakeDoubleAccessor (&LogDistancePropagationLossModel::m_referenceLoss),
+                   MakeDoubleAccessor (&LogDistancePropagationLossModel::SetReferenceLoss,
+                                       &LogDistancePropagationLossModel::GetReferenceLoss),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -485,18 +661,42 @@ void
 LogDistancePropagationLossModel::SetPathLossExponent (double n)
 {
   m_exponent = n;
+  NotifyChange ();
 }
 void
 LogDistancePropagationLossModel::SetReference (double referenceDistance, double referenceLoss)
 {
   m_referenceDistance = referenceDistance;
   m_referenceLoss = referenceLoss;
+  NotifyChange ();
 }
 double
 LogDistancePropagationLossModel::GetPathLossExponent (void) const
 {
   return m_exponent;
 }
+void
+LogDistancePropagationLossModel::SetReferenceDistance (double referenceDistance)
+{
+  m_referenceDistance = referenceDistance;
+  NotifyChange ();
+}
+double
+LogDistancePropagationLossModel::GetReferenceDistance (void) const
+{
+  return m_referenceDistance;
+}
+void
+LogDistancePropagationLossModel::SetReferenceLoss (double referenceLoss)
+{
+  m_referenceLoss = referenceLoss;
+  NotifyChange ();
+}
+double
+LogDistancePropagationLossModel::GetReferenceLoss (void) const
+{
+  return m_referenceLoss;
+}
 
 double
 LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
@@ -529,12 +729,41 @@ LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + rxc;
 }
 
+void
+LogDistancePropagationLossModel::DoCalcRxPower (Ptr<MobilityModel> a,
+                                                const std::vector<Ptr<MobilityModel> > &b,
+                                                const std::vector<double> &x,
+                                                const std::vector<double> &y,
+                                                const std::vector<double> &z,
+                                                std::vector<double> &rxPowerDbm) const
+{
+  // Same as the scalar version, without virtual calls or branches
+  Vector position = a->GetPosition ();
+  uint32_t n = rxPowerDbm.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = x[i] - position.x;
+      double dy = y[i] - position.y;
+      double dz = z[i] - position.z;
+      double distance = std::sqrt (dx * dx + dy * dy + dz * dz);
+      double pathLossDb = 10 * m_exponent * std::log10 (distance / m_referenceDistance);
+      double rxc = -m_referenceLoss - pathLossDb;
+      rxPowerDbm[i] = (distance <= m_referenceDistance) ? rxPowerDbm[i] : rxPowerDbm[i] + rxc;
+    }
+}
+
 int64_t
 LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
   return 0;
 }
 
+bool
+LogDistancePropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -548,37 +777,44 @@ ThreeLogDistancePropagationLossModel::GetTypeId (void)
     .AddAttribute ("Distance0",
                    "Beginning of the first (near) distance field",
                    DoubleValue (1.0),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_distance0),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetDistance0,
+                                       &ThreeLogDistancePropagationLossModel::GetDistance0),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("Distance1",
                    "Beginning of the second (middle) distance field.",
                    DoubleValue (200.0),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_distance1),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetDistance1,
+                                       &ThreeLogDistancePropagationLossModel::GetDistance1),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("Distance2",
                    "Beginning of the third (far) distance field.",
                    DoubleValue (500.0),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_distance2),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetDistance2,
+                                       &ThreeLogDistancePropagationLossModel::GetDistance2),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("Exponent0",
                    "The exponent for the first field.",
                    DoubleValue (1.9),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_exponent0),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetExponent0,
+                                       &ThreeLogDistancePropagationLossModel::GetExponent0),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("Exponent1",
                    "The exponent for the second field.",
                    DoubleValue (3.8),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_exponent1),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetExponent1,
+                                       &ThreeLogDistancePropagationLossModel::GetExponent1),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("Exponent2",
                    "The exponent for the third field.",
                    DoubleValue (3.8),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_exponent2),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetExponent2,
+                                       &ThreeLogDistancePropagationLossModel::GetExponent2),
                    MakeDoubleChecker<double> ())
     .AddAttribute ("ReferenceLoss",
                    "The reference loss at distance d0 (dB). (Default is Friis at 1m with 5.15 GHz)",
                    DoubleValue (46.6777),
-                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::m_referenceLoss),
+                   MakeDoubleAccessor (&ThreeLogDistancePropagationLossModel::SetReferenceLoss,
+                                       &ThreeLogDistancePropagationLossModel::GetReferenceLoss),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -589,6 +825,97 @@ ThreeLogDistancePropagationLossModel::ThreeLogDistancePropagationLossModel ()
 {
 }
 
+void
+ThreeLogDistancePropagationLossModel::SetDistance0 (double distance)
+{
+  m_distance0 = distance;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetDistance0 (void) const
+{
+  return m_distance0;
+}
+
+void
+ThreeLogDistancePropagationLossModel::SetDistance1 (double distance)
+{
+  m_distance1 = distance;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetDistance1 (void) const
+{
+  return m_distance1;
+}
+
+void
+ThreeLogDistancePropagationLossModel::SetDistance2 (double distance)
+{
+  m_distance2 = distance;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetDistance2 (void) const
+{
+  return m_distance2;
+}
+
+void
+ThreeLogDistancePropagationLossModel::SetExponent0 (double exponent)
+{
+  m_exponent0 = exponent;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetExponent0 (void) const
+{
+  return m_exponent0;
+}
+
+void
+ThreeLogDistancePropagationLossModel::SetExponent1 (double exponent)
+{
+  m_exponent1 = exponent;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetExponent1 (void) const
+{
+  return m_exponent1;
+}
+
+void
+ThreeLogDistancePropagationLossModel::SetExponent2 (double exponent)
+{
+  m_exponent2 = exponent;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetExponent2 (void) const
+{
+  return m_exponent2;
+}
+
+void
+ThreeLogDistancePropagationLossModel::SetReferenceLoss (double referenceLoss)
+{
+  m_referenceLoss = referenceLoss;
+  NotifyChange ();
+}
+
+double
+ThreeLogDistancePropagationLossModel::GetReferenceLoss (void) const
+{
+  return m_referenceLoss;
+}
+
 double 
 ThreeLogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                                      Ptr<MobilityModel> a,
@@ -630,12 +957,62 @@ ThreeLogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm - pathLossDb;
 }
 
+void
+ThreeLogDistancePropagationLossModel::DoCalcRxPower (Ptr<MobilityModel> a,
+                                                     const std::vector<Ptr<MobilityModel> > &b,
+                                                     const std::vector<double> &x,
+                                                     const std::vector<double> &y,
+                                                     const std::vector<double> &z,
+                                                     std::vector<double> &rxPowerDbm) const
+{
+  // Same as the scalar version, without virtual calls. The loss at the
+  // distance at which a field starts is calculated once for all destinations.
+  Vector position = a->GetPosition ();
+  double loss1 = m_referenceLoss + 10 * m_exponent0 * std::log10 (m_distance1 / m_distance0);
+  double loss2 = loss1 + 10 * m_exponent1 * std::log10 (m_distance2 / m_distance1);
+  uint32_t n = rxPowerDbm.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = x[i] - position.x;
+      double dy = y[i] - position.y;
+      double dz = z[i] - position.z;
+      double distance = std::sqrt (dx * dx + dy * dy + dz * dz);
+      double pathLossDb;
+      if (distance < m_distance0)
+        {
+          pathLossDb = 0;
+        }
+      else if (distance < m_distance1)
+        {
+          pathLossDb = m_referenceLoss
+            + 10 * m_exponent0 * std::log10 (distance / m_distance0);
+        }
+      else if (distance < m_distance2)
+        {
+          pathLossDb = loss1
+            + 10 * m_exponent1 * std::log10 (distance / m_distance1);
+        }
+      else
+        {
+          pathLossDb = loss2
+            + 10 * m_exponent2 * std::log10 (distance / m_distance2);
+        }
+      rxPowerDbm[i] -= pathLossDb;
+    }
+}
+
 int64_t
 ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
   return 0;
 }
 
+bool
+ThreeLogDistancePropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (NakagamiPropagationLossModel);
@@ -762,7 +1139,8 @@ FixedRssLossModel::GetTypeId (void)
     .AddConstructor<FixedRssLossModel> ()
     .AddAttribute ("Rss", "The fixed receiver Rss.",
                    DoubleValue (-150.0),
-                   MakeDoubleAccessor (&FixedRssLossModel::m_rss),
+                   MakeDoubleAccessor (&FixedRssLossModel::SetRss,
+                                       &FixedRssLossModel::GetRss),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -780,6 +1158,13 @@ void
 FixedRssLossModel::SetRss (double rss)
 {
   m_rss = rss;
+  NotifyChange ();
+}
+
+double
+FixedRssLossModel::GetRss (void) const
+{
+  return m_rss;
 }
 
 double
@@ -796,6 +1181,12 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+FixedRssLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel);
@@ -888,7 +1279,8 @@ RangePropagationLossModel::GetTypeId (void)
     .AddAttribute ("MaxRange",
                    "Maximum Transmission Range (meters)",
                    DoubleValue (250),
-                   MakeDoubleAccessor (&RangePropagationLossModel::m_range),
+                   MakeDoubleAccessor (&RangePropagationLossModel::SetMaxRange,
+                                       &RangePropagationLossModel::GetMaxRange),
                    MakeDoubleChecker<double> ())
   ;
   return tid;
@@ -898,6 +1290,19 @@ RangePropagationLossModel::RangePropagationLossModel ()
 {
 }
 
+void
+RangePropagationLossModel::SetMaxRange (double range)
+{
+  m_range = range;
+  NotifyChange ();
+}
+
+double
+RangePropagationLossModel::GetMaxRange (void) const
+{
+  return m_range;
+}
+
 double
 RangePropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                           Ptr<MobilityModel> a,
@@ -914,12 +1319,39 @@ RangePropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+void
+RangePropagationLossModel::DoCalcRxPower (Ptr<MobilityModel> a,
+                                          const std::vector<Ptr<MobilityModel> > &b,
+                                          const std::vector<double> &x,
+                                          const std::vector<double> &y,
+                                          const std::vector<double> &z,
+                                          std::vector<double> &rxPowerDbm) const
+{
+  // Same as the scalar version, without virtual calls or branches
+  Vector position = a->GetPosition ();
+  uint32_t n = rxPowerDbm.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = x[i] - position.x;
+      double dy = y[i] - position.y;
+      double dz = z[i] - position.z;
+      double distance = std::sqrt (dx * dx + dy * dy + dz * dz);
+      rxPowerDbm[i] = (distance <= m_range) ? rxPowerDbm[i] : -1000;
+    }
+}
+
 int64_t
 RangePropagationLossModel::DoAssignStreams (int64_t stream)
 {
   return 0;
 }
 
+bool
+RangePropagationLossModel::IsDeterministic (void) const
+{
+  return true;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -85,6 +86,28 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param b the mobility models of the destinations
+   * \param x the x coordinates of the positions of the destinations
+   * \param y the y coordinates of the positions of the destinations
+   * \param z the z coordinates of the positions of the destinations
+   * \param rxPowerDbm set to the reception power at each destination after
+   * adding/multiplying propagation loss (in dBm)
+   *
+   * Calculates the same reception powers as calling CalcRxPower for every
+   * destination, in order. Models which override DoCalcRxPower for a batch of
+   * destinations evaluate all of them in a single loop over the positions.
+   */
+  void CalcRxPower (double txPowerDbm,
+                    Ptr<MobilityModel> a,
+                    const std::vector<Ptr<MobilityModel> > &b,
+                    const std::vector<double> &x,
+                    const std::vector<double> &y,
+                    const std::vector<double> &z,
+                    std::vector<double> &rxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -98,12 +121,66 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \returns true if the receive power calculated by this model (without
+   * the models chained to it) depends on nothing but the transmit power and
+   * the positions of the source and the destination, i.e. if it may be
+   * cached for as long as neither moves. The default is false.
+   */
+  virtual bool IsDeterministic (void) const;
+
+  /**
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param b the mobility model of the destination
+   * \param rest set to the first model of the chain which is not
+   * deterministic, or to zero if all of them are
+   * \returns the reception power after the deterministic models at the
+   * beginning of the chain (in dBm)
+   *
+   * Passing the result to the CalcRxPower method of rest (if any) yields
+   * the same reception power as CalcRxPower, so that callers can cache the
+   * result of this method.
+   */
+  double CalcDeterministicRxPower (double txPowerDbm,
+                                   Ptr<MobilityModel> a,
+                                   Ptr<MobilityModel> b,
+                                   Ptr<PropagationLossModel> &rest) const;
+
+  /**
+   * \returns the epoch of the last change of the chain starting at this
+   * model, i.e. of a parameter of one of its models or of the chain itself.
+   *
+   * Callers which cache the results of CalcRxPower or
+   * CalcDeterministicRxPower have to discard them when the epoch changes.
+   */
+  uint64_t GetChangeEpoch (void) const;
+
+protected:
+  /**
+   * Advances the change epoch of this model (see GetChangeEpoch).
+   * Subclasses call it whenever a parameter which affects the reception
+   * power changes.
+   */
+  void NotifyChange (void);
+
 private:
   PropagationLossModel (const PropagationLossModel &o);
   PropagationLossModel &operator = (const PropagationLossModel &o);
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const = 0;
+  /**
+   * Applies the loss of this model to the reception powers of a batch of
+   * destinations (see CalcRxPower). The default implementation calls
+   * DoCalcRxPower for every destination.
+   */
+  virtual void DoCalcRxPower (Ptr<MobilityModel> a,
+                              const std::vector<Ptr<MobilityModel> > &b,
+                              const std::vector<double> &x,
+                              const std::vector<double> &y,
+                              const std::vector<double> &z,
+                              std::vector<double> &rxPowerDbm) const;
 
   /**
    * Subclasses must implement this; those not using random variables
@@ -112,6 +189,7 @@ private:
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
   Ptr<PropagationLossModel> m_next;
+  uint64_t m_changeEpoch;
 };
 
 /**
@@ -182,6 +260,7 @@ class FriisPropagationLossModel : public PropagationLossModel
 public:
   static TypeId GetTypeId (void);
   FriisPropagationLossModel ();
+  virtual bool IsDeterministic (void) const;
   /**
    * \param frequency (Hz)
    *
@@ -224,6 +303,12 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPower (Ptr<MobilityModel> a,
+                              const std::vector<Ptr<MobilityModel> > &b,
+                              const std::vector<double> &x,
+                              const std::vector<double> &y,
+                              const std::vector<double> &z,
+                              std::vector<double> &rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
   double DbmToW (double dbm) const;
   double DbmFromW (double w) const;
@@ -268,6 +353,7 @@ class TwoRayGroundPropagationLossModel : public PropagationLossModel
 public:
   static TypeId GetTypeId (void);
   TwoRayGroundPropagationLossModel ();
+  virtual bool IsDeterministic (void) const;
 
   /**
    * \param frequency (Hz)
@@ -310,6 +396,10 @@ public:
    * Set the model antenna height above the node's Z coordinate
    */
   void SetHeightAboveZ (double heightAboveZ);
+  /**
+   * \returns the model antenna height above the node's Z coordinate
+   */
+  double GetHeightAboveZ (void) const;
 
 private:
   TwoRayGroundPropagationLossModel (const TwoRayGroundPropagationLossModel &o);
@@ -317,6 +407,12 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPower (Ptr<MobilityModel> a,
+                              const std::vector<Ptr<MobilityModel> > &b,
+                              const std::vector<double> &x,
+                              const std::vector<double> &y,
+                              const std::vector<double> &z,
+                              std::vector<double> &rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
   double DbmToW (double dbm) const;
   double DbmFromW (double w) const;
@@ -354,6 +450,7 @@ class LogDistancePropagationLossModel : public PropagationLossModel
 public:
   static TypeId GetTypeId (void);
   LogDistancePropagationLossModel ();
+  virtual bool IsDeterministic (void) const;
 
   /**
    * \param n the path loss exponent.
@@ -370,9 +467,19 @@ public:
 private:
   LogDistancePropagationLossModel (const LogDistancePropagationLossModel &o);
   LogDistancePropagationLossModel & operator = (const LogDistancePropagationLossModel &o);
+  void SetReferenceDistance (double referenceDistance);
+  double GetReferenceDistance (void) const;
+  void SetReferenceLoss (double referenceLoss);
+  double GetReferenceLoss (void) const;
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPower (Ptr<MobilityModel> a,
+                              const std::vector<Ptr<MobilityModel> > &b,
+                              const std::vector<double> &x,
+                              const std::vector<double> &y,
+                              const std::vector<double> &z,
+                              std::vector<double> &rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
   static Ptr<PropagationLossModel> CreateDefaultReference (void);
 
@@ -426,6 +533,7 @@ class ThreeLogDistancePropagationLossModel : public PropagationLossModel
 public:
   static TypeId GetTypeId (void);
   ThreeLogDistancePropagationLossModel ();
+  virtual bool IsDeterministic (void) const;
 
   // Parameters are all accessible via attributes.
 
@@ -433,9 +541,31 @@ private:
   ThreeLogDistancePropagationLossModel (const ThreeLogDistancePropagationLossModel& o);
   ThreeLogDistancePropagationLossModel& operator= (const ThreeLogDistancePropagationLossModel& o);
 
+  // Attribute accessors, which advance the change epoch
+  void SetDistance0 (double distance);
+  double GetDistance0 (void) const;
+  void SetDistance1 (double distance);
+  double GetDistance1 (void) const;
+  void SetDistance2 (double distance);
+  double GetDistance2 (void) const;
+  void SetExponent0 (double exponent);
+  double GetExponent0 (void) const;
+  void SetExponent1 (double exponent);
+  double GetExponent1 (void) const;
+  void SetExponent2 (double exponent);
+  double GetExponent2 (void) const;
+  void SetReferenceLoss (double referenceLoss);
+  double GetReferenceLoss (void) const;
+
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPower (Ptr<MobilityModel> a,
+                              const std::vector<Ptr<MobilityModel> > &b,
+                              const std::vector<double> &x,
+                              const std::vector<double> &y,
+                              const std::vector<double> &z,
+                              std::vector<double> &rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   double m_distance0;
@@ -518,12 +648,17 @@ public:
 
   FixedRssLossModel ();
   virtual ~FixedRssLossModel ();
+  virtual bool IsDeterministic (void) const;
   /**
    * \param rss (dBm) the received signal strength
    *
    * Set the received signal strength (RSS) in dBm.
    */
   void SetRss (double rss);
+  /**
+   * \returns the received signal strength (RSS) in dBm.
+   */
+  double GetRss (void) const;
 
 private:
   FixedRssLossModel (const FixedRssLossModel &o);
@@ -592,12 +727,21 @@ class RangePropagationLossModel : public PropagationLossModel
 public:
   static TypeId GetTypeId (void);
   RangePropagationLossModel ();
+  virtual bool IsDeterministic (void) const;
 private:
   RangePropagationLossModel (const RangePropagationLossModel& o);
   RangePropagationLossModel& operator= (const RangePropagationLossModel& o);
+  void SetMaxRange (double range);
+  double GetMaxRange (void) const;
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPower (Ptr<MobilityModel> a,
+                              const std::vector<Ptr<MobilityModel> > &b,
+                              const std::vector<double> &x,
+                              const std::vector<double> &y,
+                              const std::vector<double> &z,
+                              std::vector<double> &rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 private:
   double m_range;
@@ -436,6 +436,84 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class BatchPropagationLossModelTestCase : public TestCase
+{
+public:
+  BatchPropagationLossModelTestCase ();
+  virtual ~BatchPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckBatch (Ptr<PropagationLossModel> lossModel, std::string name);
+};
+
+BatchPropagationLossModelTestCase::BatchPropagationLossModelTestCase ()
+  : TestCase ("Check batch CalcRxPower against the per-destination CalcRxPower")
+{
+}
+
+BatchPropagationLossModelTestCase::~BatchPropagationLossModelTestCase ()
+{
+}
+
+void
+BatchPropagationLossModelTestCase::CheckBatch (Ptr<PropagationLossModel> lossModel, std::string name)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 1.5));
+
+  // includes a destination at the source, one inside the reference distance
+  // and some beyond the breakpoints and the maximum range
+  double distances[] = { 0.0, 0.5, 1.0, 42.0, 127.1, 150.0, 400.0, 2500.0 };
+  std::vector<Ptr<MobilityModel> > b;
+  std::vector<double> x, y, z;
+  for (uint32_t i = 0; i < sizeof (distances) / sizeof (distances[0]); i++)
+    {
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (distances[i], 0.5 * i, 1.5 + 0.25 * i));
+      Vector position = mobility->GetPosition ();
+      b.push_back (mobility);
+      x.push_back (position.x);
+      y.push_back (position.y);
+      z.push_back (position.z);
+    }
+
+  double txPowerDbm = 16.0206;
+  std::vector<double> rxPowerDbm;
+  lossModel->CalcRxPower (txPowerDbm, a, b, x, y, z, rxPowerDbm);
+  NS_TEST_ASSERT_MSG_EQ (rxPowerDbm.size (), b.size (), name << ": got unexpected number of results");
+  for (uint32_t i = 0; i < b.size (); i++)
+    {
+      double expected = lossModel->CalcRxPower (txPowerDbm, a, b[i]);
+      NS_TEST_EXPECT_MSG_EQ (rxPowerDbm[i], expected, name << ": got unexpected rcv power for destination " << i);
+    }
+}
+
+void
+BatchPropagationLossModelTestCase::DoRun (void)
+{
+  CheckBatch (CreateObject<FriisPropagationLossModel> (), "Friis");
+  CheckBatch (CreateObject<TwoRayGroundPropagationLossModel> (), "TwoRayGround");
+  CheckBatch (CreateObject<LogDistancePropagationLossModel> (), "LogDistance");
+  CheckBatch (CreateObject<ThreeLogDistancePropagationLossModel> (), "ThreeLogDistance");
+
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  range->SetAttribute ("MaxRange", DoubleValue (127.2));
+  CheckBatch (range, "Range");
+
+  // a chain mixing overridden and default batch implementations
+  Ptr<LogDistancePropagationLossModel> chain = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<FixedRssLossModel> fixed = CreateObject<FixedRssLossModel> ();
+  fixed->SetRss (-60.0);
+  Ptr<RangePropagationLossModel> chainRange = CreateObject<RangePropagationLossModel> ();
+  chainRange->SetAttribute ("MaxRange", DoubleValue (300.0));
+  chain->SetNext (chainRange);
+  CheckBatch (chain, "LogDistance+Range");
+  chainRange->SetNext (fixed);
+  CheckBatch (chain, "LogDistance+Range+FixedRss");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +528,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new BatchPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
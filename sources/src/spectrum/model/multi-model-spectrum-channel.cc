@@ -282,6 +282,29 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
 
 
+      // The propagation gain of all receivers is calculated at once
+      std::vector<Ptr<MobilityModel> > receiverMobilities;
+      std::vector<double> x, y, z, propagationGainsDb;
+      if (txMobility && m_propagationLoss)
+        {
+          for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
+               rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+               ++rxPhyIterator)
+            {
+              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+                {
+                  Vector position = receiverMobility->GetPosition ();
+                  receiverMobilities.push_back (receiverMobility);
+                  x.push_back (position.x);
+                  y.push_back (position.y);
+                  z.push_back (position.z);
+                }
+            }
+          m_propagationLoss->CalcRxPower (0, txMobility, receiverMobilities, x, y, z, propagationGainsDb);
+        }
+      uint32_t next = 0;
+
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
            ++rxPhyIterator)
@@ -318,7 +341,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                     }
                   if (m_propagationLoss)
                     {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+                      double propagationGainDb = propagationGainsDb[next++];
                       NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                       pathLossDb -= propagationGainDb;
                     }                    
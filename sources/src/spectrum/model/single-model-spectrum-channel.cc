@@ -129,6 +129,29 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
 
+  // The propagation gain of all receivers is calculated at once
+  std::vector<Ptr<MobilityModel> > receiverMobilities;
+  std::vector<double> x, y, z, propagationGainsDb;
+  if (senderMobility && m_propagationLoss)
+    {
+      for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
+           rxPhyIterator != m_phyList.end ();
+           ++rxPhyIterator)
+        {
+          Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+          if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+            {
+              Vector position = receiverMobility->GetPosition ();
+              receiverMobilities.push_back (receiverMobility);
+              x.push_back (position.x);
+              y.push_back (position.y);
+              z.push_back (position.z);
+            }
+        }
+      m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobilities, x, y, z, propagationGainsDb);
+    }
+  uint32_t next = 0;
+
   for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
        rxPhyIterator != m_phyList.end ();
        ++rxPhyIterator)
@@ -161,7 +184,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                 }
               if (m_propagationLoss)
                 {
-                  double propagationGainDb = m_propagationLoss->CalcRxPower (0, senderMobility, receiverMobility);
+                  double propagationGainDb = propagationGainsDb[next++];
                   NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                   pathLossDb -= propagationGainDb;
                 }                    
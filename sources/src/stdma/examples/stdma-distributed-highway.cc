@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+/*
+ * A STDMA highway scenario on the slot-level abstract channel, partitioned into road segments that are simulated
+ * by the systems of the MPI based distributed simulator, e.g.
+ *
+ *   mpirun -np 4 ./waf --run "stdma-distributed-highway --nodes=2000 --length=20000"
+ *
+ * All systems create all nodes in the same order, each node with the system id of the segment of its position,
+ * and install the devices on all of them. Each system only runs the stations of its own nodes. Transmissions
+ * near the border of a segment are forwarded to the neighboring systems one lookahead after they started, which
+ * is why the lookahead has to cover the longest transmission (the slot duration without its guard interval).
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/stdma-module.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/on-off-helper.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+static uint32_t g_tx = 0;
+static uint32_t g_rx = 0;
+
+static void
+TxTrace (std::string context, Ptr<const Packet> p, uint32_t no, uint8_t timeout, uint32_t offset)
+{
+  g_tx++;
+}
+
+static void
+RxTrace (std::string context, Ptr<const Packet> p, uint8_t timeout, uint32_t offset)
+{
+  g_rx++;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 400;
+  double length = 5000;
+  double duration = 5.0;
+  double boundary = 1000;
+  Time lookahead = MicroSeconds (560);
+  bool distributed = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "number of vehicles", nodes);
+  cmd.AddValue ("length", "length of the highway in meters", length);
+  cmd.AddValue ("duration", "simulated time in seconds", duration);
+  cmd.AddValue ("boundary", "distance in meters to a neighboring segment within which transmissions are forwarded", boundary);
+  cmd.AddValue ("lookahead", "delay after which transmissions are delivered to other systems", lookahead);
+  cmd.AddValue ("distributed", "use the distributed simulator", distributed);
+  cmd.Parse (argc, argv);
+
+  if (distributed)
+    {
+      MpiInterface::Enable (&argc, &argv);
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+    }
+  uint32_t systems = distributed ? MpiInterface::GetSize () : 1;
+  uint32_t self = distributed ? MpiInterface::GetSystemId () : 0;
+  SeedManager::SetSeed (1);
+
+  stdma::StdmaHelper stdma;
+  stdma.SetStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  stdma::StdmaMacHelper stdmaMac = stdma::StdmaMacHelper::Default ();
+  Config::SetDefault ("stdma::StdmaMac::FrameDuration", TimeValue (Seconds (1.0)));
+  Config::SetDefault ("stdma::StdmaMac::MaximumPacketSize", UintegerValue (400));
+  Config::SetDefault ("stdma::StdmaMac::ReportRate", UintegerValue (10));
+
+  // One segment of equal length per system, the vehicles are placed uniformly at random on four lanes
+  std::vector<double> bounds;
+  for (uint32_t k = 0; k <= systems; k++)
+    {
+      bounds.push_back (length * k / systems);
+    }
+  NodeContainer c;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      Vector position (x->GetValue (0, length), 4.0 * (i % 4), 0.0);
+      positions->Add (position);
+      c.Add (CreateObject<Node> (stdma::StdmaSlotChannel::GetSegment (bounds, position.x)));
+    }
+
+  Ptr<stdma::StdmaSlotChannel> channel = CreateObject<stdma::StdmaSlotChannel> ();
+  Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+  loss->SetAttribute ("Exponent", DoubleValue (1.85));
+  loss->SetAttribute ("ReferenceLoss", DoubleValue (59.7));
+  channel->SetPropagationLossModel (loss);
+  channel->SetAttribute ("Lookahead", TimeValue (lookahead));
+  channel->SetAttribute ("BoundaryWidth", DoubleValue (boundary));
+  channel->SetPartition (bounds);
+  stdma::StdmaSlotPhyHelper slotPhy = stdma::StdmaSlotPhyHelper::Default ();
+  slotPhy.SetChannel (channel);
+  stdma.Install (slotPhy, stdmaMac, c);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (c);
+
+  // Applications are only installed on the nodes of this system
+  NodeContainer local;
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      if (c.Get (i)->GetSystemId () == self)
+        {
+          local.Add (c.Get (i));
+        }
+    }
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (local);
+  PacketSocketAddress socket;
+  socket.SetAllDevices ();
+  socket.SetPhysicalAddress (Mac48Address::GetBroadcast ());
+  socket.SetProtocol (1);
+  OnOffHelper onOff ("ns3::PacketSocketFactory", Address (socket));
+  onOff.SetAttribute ("PacketSize", UintegerValue (300));
+  onOff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+  onOff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+  onOff.SetAttribute ("DataRate", DataRateValue (DataRate ("24kb/s")));
+  ApplicationContainer apps = onOff.Install (local);
+  apps.Start (Seconds (0.0));
+  apps.Stop (Seconds (duration));
+
+  Config::Connect ("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Tx", MakeCallback (&TxTrace));
+  Config::Connect ("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Rx", MakeCallback (&RxTrace));
+
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << "system " << self << ": " << local.GetN () << " vehicles, " << g_tx << " transmissions, "
+            << g_rx << " receptions" << std::endl;
+  if (distributed)
+    {
+      MpiInterface::Disable ();
+    }
+  return 0;
+}
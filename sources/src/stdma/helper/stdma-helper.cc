@@ -33,11 +33,22 @@
 #include "ns3/config.h"
 #include "ns3/simulator.h"
 #include "ns3/names.h"
+#include "ns3/stdma-snapshot.h"
+#include "ns3/stdma-slot-phy.h"
+#include "ns3/stdma-slot-manager.h"
+#include "ns3/mpi-interface.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
 
 NS_LOG_COMPONENT_DEFINE ("StdmaHelper");
 
 namespace stdma {
 
+static const uint32_t SNAPSHOT_MAGIC = 0x414d4453;   // "SDMA" in little endian byte order
+static const uint8_t SNAPSHOT_VERSION = 2;
+
 StdmaHelper::StdmaHelper ()
   : m_standard (ns3::WIFI_PHY_STANDARD_80211p_CCH)
 {
@@ -61,6 +72,7 @@ StdmaHelper::Install (const ns3::WifiPhyHelper &phyHelper,
                       const StdmaMacHelper &macHelper, ns3::NodeContainer c, std::vector<ns3::Time> startups) const
 {
   NS_ASSERT(c.GetN() <= startups.size());
+  std::map<std::pair<uint32_t, uint32_t>, std::string> snapshot = LoadSnapshot ();
   ns3::NetDeviceContainer devices;
   uint32_t index = 0;
   for (ns3::NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
@@ -76,7 +88,7 @@ StdmaHelper::Install (const ns3::WifiPhyHelper &phyHelper,
       device->SetPhy (phy);
       node->AddDevice (device);
       devices.Add (device);
-      ns3::Simulator::ScheduleWithContext(node->GetId(), startups[index], &StdmaMac::StartInitializationPhase, mac);
+      Start (device, mac, startups[index], snapshot);
       index++;
     }
   return devices;
@@ -86,6 +98,7 @@ ns3::NetDeviceContainer
 StdmaHelper::Install (const ns3::WifiPhyHelper &phyHelper,
                       const StdmaMacHelper &macHelper, ns3::NodeContainer c) const
 {
+  std::map<std::pair<uint32_t, uint32_t>, std::string> snapshot = LoadSnapshot ();
   ns3::NetDeviceContainer devices;
   for (ns3::NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
@@ -100,11 +113,122 @@ StdmaHelper::Install (const ns3::WifiPhyHelper &phyHelper,
       device->SetPhy (phy);
       node->AddDevice (device);
       devices.Add (device);
-      ns3::Simulator::ScheduleWithContext(node->GetId(), ns3::Seconds(0), &StdmaMac::StartInitializationPhase, mac);
+      Start (device, mac, ns3::Seconds (0), snapshot);
     }
   return devices;
 }
 
+void
+StdmaHelper::Start (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<StdmaMac> mac, ns3::Time startup,
+                    const std::map<std::pair<uint32_t, uint32_t>, std::string> &snapshot) const
+{
+  // With the distributed simulator, each system only runs the stations of its own nodes
+  if (ns3::MpiInterface::IsEnabled () && device->GetNode ()->GetSystemId () != ns3::MpiInterface::GetSystemId ())
+    {
+      return;
+    }
+  uint32_t id = device->GetNode ()->GetId ();
+  std::map<std::pair<uint32_t, uint32_t>, std::string>::const_iterator it = snapshot.find (std::make_pair (id, device->GetIfIndex ()));
+  if (it != snapshot.end ())
+    {
+      ns3::Simulator::ScheduleWithContext(id, ns3::Seconds(0), &StdmaMac::RestoreState, mac, it->second);
+    }
+  else
+    {
+      ns3::Simulator::ScheduleWithContext(id, startup, &StdmaMac::StartInitializationPhase, mac);
+    }
+}
+
+void
+StdmaHelper::SetWarmStart (std::string filename)
+{
+  m_warmStart = filename;
+}
+
+std::map<std::pair<uint32_t, uint32_t>, std::string>
+StdmaHelper::LoadSnapshot (void) const
+{
+  std::map<std::pair<uint32_t, uint32_t>, std::string> snapshot;
+  if (m_warmStart.empty ())
+    {
+      return snapshot;
+    }
+  std::ifstream file (m_warmStart.c_str (), std::ios::in | std::ios::binary);
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("StdmaHelper:LoadSnapshot() cannot open the snapshot file " << m_warmStart);
+    }
+  std::ostringstream content;
+  content << file.rdbuf ();
+  std::string data = content.str ();
+
+  StdmaSnapshotReader reader (data, ns3::Seconds (0));
+  if (reader.ReadU32 () != SNAPSHOT_MAGIC || reader.ReadU8 () != SNAPSHOT_VERSION)
+    {
+      NS_FATAL_ERROR ("StdmaHelper:LoadSnapshot() " << m_warmStart << " is not a STDMA snapshot of a supported version");
+    }
+  uint32_t count = reader.ReadU32 ();
+  for (uint32_t i = 0; i < count; i++)
+    {
+      uint32_t node = reader.ReadU32 ();
+      uint32_t ifIndex = reader.ReadU32 ();
+      std::string &state = snapshot[std::make_pair (node, ifIndex)];
+      state.resize (reader.ReadU32 ());
+      for (uint32_t k = 0; k < state.size (); k++)
+        {
+          state[k] = reader.ReadU8 ();
+        }
+    }
+  NS_ASSERT_MSG (reader.IsAtEnd (), "StdmaHelper:LoadSnapshot() unexpected data at the end of " << m_warmStart);
+  return snapshot;
+}
+
+void
+StdmaHelper::SaveSnapshot (std::string filename, ns3::NetDeviceContainer devices)
+{
+  // All time stamps are written relative to the earliest frame start, which is a multiple of the slot duration
+  std::vector<ns3::Ptr<StdmaNetDevice> > stdmaDevices;
+  ns3::Time origin = ns3::Simulator::Now ();
+  for (ns3::NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      ns3::Ptr<StdmaNetDevice> device = (*i)->GetObject<StdmaNetDevice> ();
+      if (device == 0)
+        {
+          continue;
+        }
+      if (!device->GetMac ()->HasEnteredNetwork ())
+        {
+          NS_FATAL_ERROR ("StdmaHelper:SaveSnapshot() the device of node " << device->GetNode ()->GetId () << " has not entered the network yet");
+        }
+      origin = std::min (origin, device->GetMac ()->GetSlotManager ()->GetCurrentFrameStart ());
+      stdmaDevices.push_back (device);
+    }
+
+  StdmaSnapshotWriter writer (origin);
+  writer.WriteU32 (SNAPSHOT_MAGIC);
+  writer.WriteU8 (SNAPSHOT_VERSION);
+  writer.WriteU32 (stdmaDevices.size ());
+  for (uint32_t i = 0; i < stdmaDevices.size (); i++)
+    {
+      StdmaSnapshotWriter state (origin);
+      stdmaDevices[i]->GetMac ()->SaveState (state);
+      writer.WriteU32 (stdmaDevices[i]->GetNode ()->GetId ());
+      writer.WriteU32 (stdmaDevices[i]->GetIfIndex ());
+      writer.WriteU32 (state.GetData ().size ());
+      for (uint32_t k = 0; k < state.GetData ().size (); k++)
+        {
+          writer.WriteU8 (state.GetData ()[k]);
+        }
+    }
+
+  std::ofstream file (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.good ())
+    {
+      NS_FATAL_ERROR ("StdmaHelper:SaveSnapshot() cannot write the snapshot file " << filename);
+    }
+  file.write (writer.GetData ().data (), writer.GetData ().size ());
+}
+
 ns3::NetDeviceContainer
 StdmaHelper::Install (const ns3::WifiPhyHelper &phy,
                       const StdmaMacHelper &mac, ns3::Ptr<ns3::Node> node) const
@@ -120,4 +244,37 @@ StdmaHelper::Install (const ns3::WifiPhyHelper &phy,
   return Install (phy, mac, ns3::NodeContainer (node));
 }
 
+int64_t
+StdmaHelper::AssignStreams (ns3::NetDeviceContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  std::set<ns3::Ptr<StdmaSlotChannel> > channels;
+  for (ns3::NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      ns3::Ptr<StdmaNetDevice> device = ns3::DynamicCast<StdmaNetDevice> (*i);
+      if (device == 0)
+        {
+          continue;
+        }
+      // Handle any random numbers in the PHY objects
+      ns3::Ptr<ns3::WifiPhy> phy = device->GetPhy ();
+      currentStream += phy->AssignStreams (currentStream);
+
+      // Handle the random numbers of the slot manager
+      currentStream += device->GetMac ()->GetSlotManager ()->AssignStreams (currentStream);
+
+      // The slot channel is shared by all its phys, its random numbers are handled once
+      ns3::Ptr<StdmaSlotPhy> slotPhy = ns3::DynamicCast<StdmaSlotPhy> (phy);
+      if (slotPhy != 0)
+        {
+          ns3::Ptr<StdmaSlotChannel> channel = ns3::DynamicCast<StdmaSlotChannel> (slotPhy->GetChannel ());
+          if (channel != 0 && channels.insert (channel).second)
+            {
+              currentStream += channel->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
 } // namespace stdma
@@ -22,7 +22,9 @@
 #ifndef STDMA_HELPER_H
 #define STDMA_HELPER_H
 
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 #include "ns3/attribute.h"
 #include "ns3/object-factory.h"
@@ -36,6 +38,8 @@
 
 namespace stdma {
 
+class StdmaMac;
+
 
 /**
  * \brief helps to create StdmaNetDevice objects
@@ -103,10 +107,59 @@ public:
    */
   void SetStandard (enum ns3::WifiPhyStandard standard);
 
+  /**
+   * \param filename The snapshot file written by SaveSnapshot, or an empty string to disable the warm start
+   *
+   * If a warm start is configured, the devices created by Install do not go through the initialization phase
+   * and the network entry. Instead, every device for which the snapshot contains a state (identified by the
+   * node id and the interface index) restores it at time zero and continues as if the simulation had been
+   * running since the snapshot has been taken. Devices without a state in the snapshot start up as usual.
+   * The frame and slot durations must be the same as in the run the snapshot has been taken from.
+   */
+  void SetWarmStart (std::string filename);
+
+  /**
+   * Writes the state of all STDMA devices of the given container to a snapshot file. All devices must have
+   * entered the network already. The time stamps of the snapshot are relative to the earliest start of the
+   * current frame of all devices, hence a run that is warm started from the snapshot resumes with the
+   * transmissions that follow the snapshot time within its first frame.
+   *
+   * \param filename The name of the snapshot file
+   * \param devices The devices whose state shall be written
+   */
+  static void SaveSnapshot (std::string filename, ns3::NetDeviceContainer devices);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables used by the phy and the slot
+   * manager of each STDMA device in the given container, and by the slot channels the devices are attached
+   * to. The Install() method should have previously been called by the user.
+   *
+   * \param c The set of net devices whose random variables shall use fixed streams
+   * \param stream The first stream index to use
+   * \returns The number of stream indices assigned by this helper
+   */
+  static int64_t AssignStreams (ns3::NetDeviceContainer c, int64_t stream);
+
 
 private:
 
+  /**
+   * Reads the snapshot configured by SetWarmStart
+   *
+   * \returns The state of each device in the snapshot, by node id and interface index
+   */
+  std::map<std::pair<uint32_t, uint32_t>, std::string> LoadSnapshot (void) const;
+
+  /**
+   * Schedules the start of the given device, either the restoration of its state from the snapshot or the
+   * start of its initialization phase. With the distributed simulator, devices of nodes of other systems
+   * are not started.
+   */
+  void Start (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<StdmaMac> mac, ns3::Time startup,
+              const std::map<std::pair<uint32_t, uint32_t>, std::string> &snapshot) const;
+
   enum ns3::WifiPhyStandard m_standard;
+  std::string m_warmStart;
 
 };
 
@@ -0,0 +1,84 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-slot-phy-helper.h"
+#include "ns3/stdma-slot-phy.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/node.h"
+
+namespace stdma {
+
+StdmaSlotPhyHelper::StdmaSlotPhyHelper ()
+  : m_channel (0)
+{
+  m_phy.SetTypeId ("stdma::StdmaSlotPhy");
+}
+
+StdmaSlotPhyHelper
+StdmaSlotPhyHelper::Default (void)
+{
+  StdmaSlotPhyHelper helper;
+  helper.SetErrorRateModel ("ns3::NistErrorRateModel");
+  return helper;
+}
+
+void
+StdmaSlotPhyHelper::SetChannel (ns3::Ptr<StdmaSlotChannel> channel)
+{
+  m_channel = channel;
+}
+
+void
+StdmaSlotPhyHelper::Set (std::string name, const ns3::AttributeValue &v)
+{
+  m_phy.Set (name, v);
+}
+
+void
+StdmaSlotPhyHelper::SetErrorRateModel (std::string name,
+                                       std::string n0, const ns3::AttributeValue &v0,
+                                       std::string n1, const ns3::AttributeValue &v1,
+                                       std::string n2, const ns3::AttributeValue &v2,
+                                       std::string n3, const ns3::AttributeValue &v3)
+{
+  m_errorRateModel = ns3::ObjectFactory ();
+  m_errorRateModel.SetTypeId (name);
+  m_errorRateModel.Set (n0, v0);
+  m_errorRateModel.Set (n1, v1);
+  m_errorRateModel.Set (n2, v2);
+  m_errorRateModel.Set (n3, v3);
+}
+
+ns3::Ptr<ns3::WifiPhy>
+StdmaSlotPhyHelper::Create (ns3::Ptr<ns3::Node> node, ns3::Ptr<ns3::WifiNetDevice> device) const
+{
+  NS_ASSERT_MSG (m_channel != 0, "StdmaSlotPhyHelper:Create() requires a slot channel");
+  ns3::Ptr<StdmaSlotPhy> phy = m_phy.Create<StdmaSlotPhy> ();
+  ns3::Ptr<ns3::ErrorRateModel> error = m_errorRateModel.Create<ns3::ErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+  phy->SetSlotChannel (m_channel);
+  return phy;
+}
+
+} //namespace stdma
@@ -0,0 +1,99 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SLOT_PHY_HELPER_H
+#define STDMA_SLOT_PHY_HELPER_H
+
+#include "ns3/object-factory.h"
+#include "ns3/wifi-helper.h"
+#include "ns3/stdma-slot-channel.h"
+
+namespace stdma
+{
+
+/**
+ * \brief Create StdmaSlotPhy instances attached to a StdmaSlotChannel.
+ *
+ * The helper can be passed to StdmaHelper::Install instead of a YansWifiPhyHelper, in order to simulate
+ * the STDMA stations on the slot-level abstract channel.
+ */
+class StdmaSlotPhyHelper : public ns3::WifiPhyHelper
+{
+public:
+  /**
+   * Create a phy helper without any channel and error rate model
+   */
+  StdmaSlotPhyHelper ();
+
+  /**
+   * Create a phy helper in a default working state, i.e. using the ns3::NistErrorRateModel
+   */
+  static StdmaSlotPhyHelper Default (void);
+
+  /**
+   * \param channel the slot channel to which the created phys are attached
+   */
+  void SetChannel (ns3::Ptr<StdmaSlotChannel> channel);
+
+  /**
+   * \param name the name of the attribute to set
+   * \param v the value of the attribute
+   *
+   * Set an attribute of the underlying PHY object.
+   */
+  void Set (std::string name, const ns3::AttributeValue &v);
+
+  /**
+   * \param name the name of the error rate model to set.
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   * \param n2 the name of the attribute to set
+   * \param v2 the value of the attribute to set
+   * \param n3 the name of the attribute to set
+   * \param v3 the value of the attribute to set
+   *
+   * Set the error rate model and its attributes to use when Install is called.
+   */
+  void SetErrorRateModel (std::string name,
+                          std::string n0 = "", const ns3::AttributeValue &v0 = ns3::EmptyAttributeValue (),
+                          std::string n1 = "", const ns3::AttributeValue &v1 = ns3::EmptyAttributeValue (),
+                          std::string n2 = "", const ns3::AttributeValue &v2 = ns3::EmptyAttributeValue (),
+                          std::string n3 = "", const ns3::AttributeValue &v3 = ns3::EmptyAttributeValue ());
+
+  /**
+   * \internal
+   * \param node the node on which we wish to create a wifi PHY
+   * \param device the device within which this PHY will be created
+   * \returns a newly-created PHY object.
+   */
+  virtual ns3::Ptr<ns3::WifiPhy> Create (ns3::Ptr<ns3::Node> node, ns3::Ptr<ns3::WifiNetDevice> device) const;
+
+private:
+  ns3::ObjectFactory m_phy;
+  ns3::ObjectFactory m_errorRateModel;
+  ns3::Ptr<StdmaSlotChannel> m_channel;
+};
+
+} //namespace stdma
+
+#endif /* STDMA_SLOT_PHY_HELPER_H */
@@ -21,11 +21,22 @@
 
 #include "stdma-header.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/double.h"
+
+#include <cmath>
+#include <limits>
 
 NS_LOG_COMPONENT_DEFINE ("StdmaHeader");
 
 namespace stdma {
 
+  static ns3::GlobalValue g_positionResolution = ns3::GlobalValue ("StdmaPositionResolution",
+      "The resolution in meters of the fixed-point coordinates announced in the STDMA header. "
+      "The resolution is not transmitted, hence all stations of a simulation use the same.",
+      ns3::DoubleValue (0.1),
+      ns3::MakeDoubleChecker<double> (1e-6));
+
   ns3::TypeId
   StdmaHeader::GetTypeId (void)
   {
@@ -36,11 +47,17 @@ namespace stdma {
   }
 
   StdmaHeader::StdmaHeader ()
-    : m_latitude(0),
+    : m_resolution(GetPositionResolution()),
+      m_latitude(0),
       m_longitude(0),
+      m_keyLatitude(0),
+      m_keyLongitude(0),
+      m_coding(ABSOLUTE),
+      m_key(0),
       m_offset(0),
       m_timeout(0),
-      m_entry(0)
+      m_entry(0),
+      m_aggregated(0)
   {
   }
 
@@ -57,63 +74,189 @@ namespace stdma {
   uint32_t
   StdmaHeader::GetSerializedSize (void) const
   {
-    return sizeof(m_latitude) + sizeof(m_longitude) + sizeof(m_offset) + sizeof(m_timeout) + sizeof(m_entry);
+    switch (m_coding)
+      {
+      case KEY:
+        return 3 + 1 + 2 * sizeof(int32_t);
+      case DELTA:
+        return 3 + 1 + 2 * sizeof(int16_t);
+      default:
+        return 3 + 2 * sizeof(int32_t);
+      }
   }
 
   void
   StdmaHeader::Serialize (ns3::Buffer::Iterator start) const
   {
+    // Values out of range would overwrite the flags and the coding of the header
+    if (m_timeout > MAX_TIMEOUT)
+      {
+        NS_FATAL_ERROR("StdmaHeader:Serialize() the timeout " << (uint32_t) m_timeout << " does not fit into 4 bits");
+      }
+    if (m_offset > MAX_OFFSET)
+      {
+        NS_FATAL_ERROR("StdmaHeader:Serialize() the offset " << m_offset << " does not fit into 14 bits");
+      }
     ns3::Buffer::Iterator i = start;
-    i.WriteU32(m_latitude);
-    i.WriteU32(m_longitude);
-    i.WriteU16(m_offset);
-    i.WriteU8(m_timeout);
-    i.WriteU8(m_entry);
+    i.WriteU8((VERSION << 6) | (m_coding << 4) | m_timeout);
+    i.WriteHtonU16((m_entry > 0 ? 0x8000 : 0) | (m_aggregated > 0 ? 0x4000 : 0) | m_offset);
+    if (m_coding != ABSOLUTE)
+      {
+        i.WriteU8(m_key);
+      }
+    if (m_coding == DELTA)
+      {
+        i.WriteHtonU16((uint16_t) (int16_t) (m_latitude - m_keyLatitude));
+        i.WriteHtonU16((uint16_t) (int16_t) (m_longitude - m_keyLongitude));
+      }
+    else
+      {
+        i.WriteHtonU32((uint32_t) m_latitude);
+        i.WriteHtonU32((uint32_t) m_longitude);
+      }
   }
 
   uint32_t
   StdmaHeader::Deserialize (ns3::Buffer::Iterator start)
   {
-    m_latitude = start.ReadU32();
-    m_longitude = start.ReadU32();
-    m_offset = start.ReadU16();
-    m_timeout = start.ReadU8();
-    m_entry = start.ReadU8();
-    return sizeof(m_latitude) + sizeof(m_longitude) + sizeof(m_offset) + sizeof(m_timeout) + sizeof(m_entry);
+    ns3::Buffer::Iterator i = start;
+    uint8_t first = i.ReadU8();
+    if ((first >> 6) != VERSION)
+      {
+        NS_FATAL_ERROR("StdmaHeader:Deserialize() unsupported header version " << (uint32_t) (first >> 6));
+      }
+    m_coding = (first >> 4) & 0x03;
+    m_timeout = first & 0x0f;
+    uint16_t second = i.ReadNtohU16();
+    m_entry = (second & 0x8000) ? 1 : 0;
+    m_aggregated = (second & 0x4000) ? 1 : 0;
+    m_offset = second & 0x3fff;
+    m_key = (m_coding != ABSOLUTE) ? i.ReadU8() : 0;
+    m_keyLatitude = 0;
+    m_keyLongitude = 0;
+    if (m_coding == DELTA)
+      {
+        m_latitude = (int16_t) i.ReadNtohU16();
+        m_longitude = (int16_t) i.ReadNtohU16();
+      }
+    else
+      {
+        m_latitude = (int32_t) i.ReadNtohU32();
+        m_longitude = (int32_t) i.ReadNtohU32();
+      }
+    return i.GetDistanceFrom(start);
   }
 
   void
   StdmaHeader::Print (std::ostream &os) const
   {
-    std::string type;
-    os << "STDMA Header: (Lat: " << m_latitude
-       << ", Lon: " << m_longitude
+    os << "STDMA Header: (Lat: " << m_latitude * m_resolution
+       << ", Lon: " << m_longitude * m_resolution
+       << ", Coding: " << (uint32_t) m_coding
        << ", Offset: " << m_offset
-       << ", Timeout: " << m_timeout << ")";
+       << ", Timeout: " << (uint32_t) m_timeout << ")";
+  }
+
+  int32_t
+  StdmaHeader::ToFixedPoint(double value) const
+  {
+    double units = std::floor(value / m_resolution + 0.5);
+    NS_ASSERT_MSG(units >= std::numeric_limits<int32_t>::min() && units <= std::numeric_limits<int32_t>::max(), "StdmaHeader:ToFixedPoint() the coordinate " << value
+        << " can not be represented with a resolution of " << m_resolution << "m");
+    return (int32_t) units;
+  }
+
+  double
+  StdmaHeader::GetPositionResolution()
+  {
+    ns3::DoubleValue resolution;
+    g_positionResolution.GetValue(resolution);
+    return resolution.Get();
+  }
+
+  void
+  StdmaHeader::SetResolution(double resolution)
+  {
+    NS_ASSERT(resolution > 0);
+    m_resolution = resolution;
+  }
+
+  double
+  StdmaHeader::GetResolution() const
+  {
+    return m_resolution;
   }
 
   void
   StdmaHeader::SetLatitude(double lat)
   {
-    m_latitude = lat;
+    m_latitude = ToFixedPoint(lat);
   }
 
   double
   StdmaHeader::GetLatitude()
   {
-    return m_latitude;
+    return m_latitude * m_resolution;
   }
 
   void
   StdmaHeader::SetLongitude(double lon)
   {
-    m_longitude = lon;
+    m_longitude = ToFixedPoint(lon);
   }
 
   double
   StdmaHeader::GetLongitude()
   {
-    return m_longitude;
+    return m_longitude * m_resolution;
+  }
+
+  void
+  StdmaHeader::SetPositionKey(uint8_t key)
+  {
+    m_coding = KEY;
+    m_key = key;
+  }
+
+  bool
+  StdmaHeader::SetPositionDelta(uint8_t key, double lat, double lon)
+  {
+    int32_t keyLatitude = ToFixedPoint(lat);
+    int32_t keyLongitude = ToFixedPoint(lon);
+    int64_t dLat = (int64_t) m_latitude - keyLatitude;
+    int64_t dLon = (int64_t) m_longitude - keyLongitude;
+    if (dLat < std::numeric_limits<int16_t>::min() || dLat > std::numeric_limits<int16_t>::max()
+        || dLon < std::numeric_limits<int16_t>::min() || dLon > std::numeric_limits<int16_t>::max())
+      {
+        return false;
+      }
+    m_coding = DELTA;
+    m_key = key;
+    m_keyLatitude = keyLatitude;
+    m_keyLongitude = keyLongitude;
+    return true;
+  }
+
+  void
+  StdmaHeader::ResolvePositionDelta(double lat, double lon)
+  {
+    NS_ASSERT(m_coding == DELTA);
+    m_keyLatitude = ToFixedPoint(lat);
+    m_keyLongitude = ToFixedPoint(lon);
+    m_latitude += m_keyLatitude;
+    m_longitude += m_keyLongitude;
+  }
+
+  StdmaHeader::PositionCoding
+  StdmaHeader::GetPositionCoding() const
+  {
+    return (PositionCoding) m_coding;
+  }
+
+  uint8_t
+  StdmaHeader::GetPositionKey() const
+  {
+    return m_key;
   }
 
   void
@@ -152,4 +295,16 @@ namespace stdma {
     return (m_entry > 0);
   }
 
+  void
+  StdmaHeader::SetAggregated()
+  {
+    m_aggregated = 1;
+  }
+
+  bool
+  StdmaHeader::GetAggregated() const
+  {
+    return (m_aggregated > 0);
+  }
+
 } // namespace stdma
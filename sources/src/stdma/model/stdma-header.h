@@ -34,6 +34,23 @@ namespace stdma {
  * (latitude and longitude), offset information to the next transmission slot to be used, and
  * the timeout value of the reservation duration.
  *
+ * Similar to the AIS position report, the header is encoded compactly: the coordinates are
+ * transmitted as signed fixed-point numbers with a configurable resolution, while the version,
+ * position coding, timeout, network entry flag and offset share the first three bytes:
+ *
+ *   byte 0:    version (2 bits) | position coding (2 bits) | timeout (4 bits)
+ *   byte 1-2:  network entry flag (1 bit) | aggregation flag (1 bit) | offset (14 bits)
+ *   ABSOLUTE:  latitude (32 bits) | longitude (32 bits)                                    = 11 bytes
+ *   KEY:       key (8 bits) | latitude (32 bits) | longitude (32 bits)                      = 12 bytes
+ *   DELTA:     key (8 bits) | latitude delta (16 bits) | longitude delta (16 bits)         =  8 bytes
+ *
+ * A KEY report announces an absolute position under a key, to which subsequent DELTA reports of
+ * the same sender refer. Receivers that do not know the position of the referenced key can not
+ * resolve the position of a DELTA report.
+ *
+ * The resolution of the coordinates is not transmitted. It is taken from the global value
+ * StdmaPositionResolution, which thus applies to all stations of a simulation alike.
+ *
  * \ingroup stdma
  */
 class StdmaHeader : public ns3::Header
@@ -41,6 +58,16 @@ class StdmaHeader : public ns3::Header
 
 public:
 
+  /**
+   * The coding of the position that is carried in the header
+   */
+  enum PositionCoding
+  {
+    ABSOLUTE = 0,
+    KEY = 1,
+    DELTA = 2
+  };
+
   static ns3::TypeId GetTypeId (void);
   StdmaHeader ();
   virtual ~StdmaHeader ();
@@ -50,6 +77,20 @@ public:
   virtual uint32_t Deserialize (ns3::Buffer::Iterator start);
   virtual void Print (std::ostream &os) const;
 
+  /**
+   * \return The resolution of the coordinates in meters configured by the global value
+   * StdmaPositionResolution, with which all headers are created
+   */
+  static double GetPositionResolution();
+  /**
+   * Overrides the resolution of this header. Since the resolution is not transmitted, the
+   * receiver has to use the same resolution as the sender.
+   *
+   * \param resolution The resolution of the coordinates in meters. Has to be set before the coordinates
+   *                   are set, or before the header is deserialized.
+   */
+  void SetResolution(double resolution);
+  double GetResolution() const;
   /**
    * \param lat The latitude of the position from which the corresponding packet was sent
    */
@@ -60,6 +101,32 @@ public:
    */
   void SetLongitude(double lon);
   double GetLongitude();
+  /**
+   * Announces the position of this header as the reference of the given key, i.e. as KEY report.
+   *
+   * \param key The key under which receivers shall remember the position
+   */
+  void SetPositionKey(uint8_t key);
+  /**
+   * Encodes the position of this header relative to the position of a previous KEY report, i.e. as
+   * DELTA report. Has to be called after the coordinates have been set.
+   *
+   * \param key The key of the previous KEY report
+   * \param lat The latitude announced in the previous KEY report
+   * \param lon The longitude announced in the previous KEY report
+   * \return False (and the coding remains unchanged) if the difference can not be represented
+   */
+  bool SetPositionDelta(uint8_t key, double lat, double lon);
+  /**
+   * Turns the position of a deserialized DELTA report into an absolute position. Until then, the
+   * latitude and longitude of a DELTA report are relative to the position of its key.
+   *
+   * \param lat The latitude the receiver remembers for the key of this header
+   * \param lon The longitude the receiver remembers for the key of this header
+   */
+  void ResolvePositionDelta(double lat, double lon);
+  PositionCoding GetPositionCoding() const;
+  uint8_t GetPositionKey() const;
   /**
    * \param offset The number of slots to the next transmission slot which this node will use
    */
@@ -75,11 +142,31 @@ public:
    */
   void SetNetworkEntry();
   bool GetNetworkEntry();
+  /**
+   * Enable a flag that indicates that the payload consists of several packets, each one preceded by a
+   * StdmaSubframeHeader.
+   */
+  void SetAggregated();
+  bool GetAggregated() const;
+
+  static const uint8_t VERSION = 1;
+  static const uint16_t MAX_OFFSET = 0x3fff;  // The offset is transmitted with 14 bits
+  static const uint8_t MAX_TIMEOUT = 15;      // The timeout is transmitted with 4 bits
 
 private:
 
-  double m_latitude;
-  double m_longitude;
+  int32_t ToFixedPoint(double value) const;
+
+  double m_resolution;  // The resolution of the fixed-point coordinates in meters (not transmitted)
+
+  int32_t m_latitude;   // The fixed-point coordinates, relative to the key position in case of a
+  int32_t m_longitude;  // DELTA report that has not been resolved yet
+
+  int32_t m_keyLatitude;  // The position of the key a DELTA report refers to (not transmitted)
+  int32_t m_keyLongitude;
+
+  uint8_t m_coding;     // The PositionCoding of the header
+  uint8_t m_key;        // The key announced by a KEY report, or referenced by a DELTA report
 
   uint16_t m_offset;  // This represents the offset to the next scheduled transmission
                       // whenever the timeout is greater than zero. If the timeout is zero
@@ -90,6 +177,8 @@ private:
 
   uint8_t m_entry;    // Used as a flag to indicate that this is a network entry packet
 
+  uint8_t m_aggregated; // Used as a flag to indicate that the payload consists of several packets
+
 };
 
 } // namespace stdma
@@ -0,0 +1,308 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-mac-queue.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/llc-snap-header.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("StdmaMacQueue");
+
+namespace stdma {
+
+  NS_OBJECT_ENSURE_REGISTERED (StdmaFlowTag);
+  NS_OBJECT_ENSURE_REGISTERED (StdmaMacQueue);
+
+  ns3::TypeId
+  StdmaFlowTag::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaFlowTag")
+            .SetParent<ns3::Tag>().AddConstructor<StdmaFlowTag>();
+    return tid;
+  }
+
+  ns3::TypeId
+  StdmaFlowTag::GetInstanceTypeId (void) const
+  {
+    return GetTypeId();
+  }
+
+  StdmaFlowTag::StdmaFlowTag ()
+    : m_flow(0)
+  {
+  }
+
+  StdmaFlowTag::StdmaFlowTag (uint32_t flow)
+    : m_flow(flow)
+  {
+  }
+
+  void
+  StdmaFlowTag::SetFlow (uint32_t flow)
+  {
+    m_flow = flow;
+  }
+
+  uint32_t
+  StdmaFlowTag::GetFlow (void) const
+  {
+    return m_flow;
+  }
+
+  uint32_t
+  StdmaFlowTag::GetSerializedSize (void) const
+  {
+    return sizeof(m_flow);
+  }
+
+  void
+  StdmaFlowTag::Serialize (ns3::TagBuffer i) const
+  {
+    i.WriteU32(m_flow);
+  }
+
+  void
+  StdmaFlowTag::Deserialize (ns3::TagBuffer i)
+  {
+    m_flow = i.ReadU32();
+  }
+
+  void
+  StdmaFlowTag::Print (std::ostream &os) const
+  {
+    os << "Flow=" << m_flow;
+  }
+
+  ns3::TypeId
+  StdmaMacQueue::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaMacQueue")
+            .SetParent<Object>().AddConstructor<StdmaMacQueue>()
+            .AddAttribute("MaxSize",
+                          "The maximum number of packets in the queue",
+                          ns3::UintegerValue(400),
+                          ns3::MakeUintegerAccessor(&StdmaMacQueue::SetMaxSize,
+                                                    &StdmaMacQueue::GetMaxSize),
+                          ns3::MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxDelay",
+                          "If a packet stays longer than this delay in the queue, it is dropped",
+                          ns3::TimeValue(ns3::Seconds(10.0)),
+                          ns3::MakeTimeAccessor(&StdmaMacQueue::m_maxDelay),
+                          ns3::MakeTimeChecker())
+            .AddAttribute("LatestWins",
+                          "If enabled, a new packet replaces the queued packet of the same flow, such that only the "
+                          "latest packet per flow is kept",
+                          ns3::BooleanValue(false),
+                          ns3::MakeBooleanAccessor(&StdmaMacQueue::m_latestWins),
+                          ns3::MakeBooleanChecker())
+            .AddTraceSource("Drop",
+                            "A packet has been dropped, because it has been replaced, the queue was full, or it expired",
+                            ns3::MakeTraceSourceAccessor(&StdmaMacQueue::m_dropTrace));
+    return tid;
+  }
+
+  StdmaMacQueue::StdmaMacQueue ()
+    : m_head(0),
+      m_size(0),
+      m_maxSize(400),
+      m_maxDelay(ns3::Seconds(10.0)),
+      m_latestWins(false)
+  {
+  }
+
+  StdmaMacQueue::~StdmaMacQueue ()
+  {
+  }
+
+  void
+  StdmaMacQueue::DoDispose (void)
+  {
+    Flush();
+    m_items.clear();
+    ns3::Object::DoDispose();
+  }
+
+  void
+  StdmaMacQueue::SetMaxSize (uint32_t maxSize)
+  {
+    NS_ASSERT(maxSize > 0);
+    m_maxSize = maxSize;
+    while (m_size > m_maxSize)
+      {
+        ns3::WifiMacHeader hdr;
+        m_dropTrace(Dequeue(&hdr));
+      }
+    if (m_items.size() > m_maxSize)
+      {
+        Reallocate(m_maxSize);
+      }
+  }
+
+  uint32_t
+  StdmaMacQueue::GetMaxSize (void) const
+  {
+    return m_maxSize;
+  }
+
+  uint64_t
+  StdmaMacQueue::GetFlow (ns3::Ptr<const ns3::Packet> packet)
+  {
+    StdmaFlowTag tag;
+    if (packet->PeekPacketTag(tag))
+      {
+        return (((uint64_t) 1) << 32) | tag.GetFlow();
+      }
+    if (packet->GetSize() >= ns3::LLC_SNAP_HEADER_LENGTH)
+      {
+        ns3::LlcSnapHeader llc;
+        packet->PeekHeader(llc);
+        return llc.GetType();
+      }
+    return 0;
+  }
+
+  void
+  StdmaMacQueue::Enqueue (ns3::Ptr<const ns3::Packet> packet, const ns3::WifiMacHeader &hdr)
+  {
+    NS_LOG_FUNCTION(this << packet);
+    uint64_t flow = GetFlow(packet);
+    uint32_t capacity = m_items.size();
+    if (m_latestWins)
+      {
+        for (uint32_t i = 0; i < m_size; i++)
+          {
+            Item &item = m_items[(m_head + i) % capacity];
+            if (item.flow == flow)
+              {
+                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMacQueue:Enqueue() packet " << packet->GetUid()
+                    << " replaces packet " << item.packet->GetUid() << " of flow " << flow);
+                m_dropTrace(item.packet);
+                item.packet = packet;
+                item.hdr = hdr;
+                item.tstamp = ns3::Simulator::Now();
+                return;
+              }
+          }
+      }
+    if (m_size == m_maxSize)
+      {
+        ns3::WifiMacHeader dropped;
+        m_dropTrace(Dequeue(&dropped));
+      }
+    else if (m_size == capacity)
+      {
+        Reallocate(std::min(m_maxSize, std::max(capacity * 2, (uint32_t) 4)));
+      }
+    Item &item = m_items[(m_head + m_size) % m_items.size()];
+    item.packet = packet;
+    item.hdr = hdr;
+    item.flow = flow;
+    item.tstamp = ns3::Simulator::Now();
+    m_size++;
+  }
+
+  ns3::Ptr<const ns3::Packet>
+  StdmaMacQueue::Dequeue (ns3::WifiMacHeader *hdr)
+  {
+    Cleanup();
+    if (m_size == 0)
+      {
+        return 0;
+      }
+    Item &item = m_items[m_head];
+    ns3::Ptr<const ns3::Packet> packet = item.packet;
+    *hdr = item.hdr;
+    item.packet = 0;
+    m_head = (m_head + 1) % m_items.size();
+    m_size--;
+    return packet;
+  }
+
+  ns3::Ptr<const ns3::Packet>
+  StdmaMacQueue::Peek (ns3::WifiMacHeader *hdr)
+  {
+    Cleanup();
+    if (m_size == 0)
+      {
+        return 0;
+      }
+    *hdr = m_items[m_head].hdr;
+    return m_items[m_head].packet;
+  }
+
+  bool
+  StdmaMacQueue::IsEmpty (void)
+  {
+    Cleanup();
+    return m_size == 0;
+  }
+
+  uint32_t
+  StdmaMacQueue::GetSize (void)
+  {
+    Cleanup();
+    return m_size;
+  }
+
+  void
+  StdmaMacQueue::Flush (void)
+  {
+    for (uint32_t i = 0; i < m_size; i++)
+      {
+        m_items[(m_head + i) % m_items.size()].packet = 0;
+      }
+    m_head = 0;
+    m_size = 0;
+  }
+
+  void
+  StdmaMacQueue::Cleanup (void)
+  {
+    ns3::Time now = ns3::Simulator::Now();
+    while (m_size > 0 && m_items[m_head].tstamp + m_maxDelay < now)
+      {
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMacQueue:Cleanup() packet " << m_items[m_head].packet->GetUid() << " expired");
+        m_dropTrace(m_items[m_head].packet);
+        m_items[m_head].packet = 0;
+        m_head = (m_head + 1) % m_items.size();
+        m_size--;
+      }
+  }
+
+  void
+  StdmaMacQueue::Reallocate (uint32_t capacity)
+  {
+    NS_ASSERT(capacity >= m_size);
+    std::vector<Item> items(capacity);
+    for (uint32_t i = 0; i < m_size; i++)
+      {
+        items[i] = m_items[(m_head + i) % m_items.size()];
+      }
+    m_items.swap(items);
+    m_head = 0;
+  }
+
+} // namespace stdma
@@ -0,0 +1,156 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_MAC_QUEUE_H_
+#define STDMA_MAC_QUEUE_H_
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+#include "ns3/traced-callback.h"
+#include "ns3/wifi-mac-header.h"
+
+#include <vector>
+
+namespace stdma {
+
+  /**
+   * \brief Packet tag that assigns a packet to a flow of the StdmaMacQueue
+   *
+   * Packets without this tag are assigned to a flow by the protocol number of their LLC/SNAP header.
+   */
+  class StdmaFlowTag : public ns3::Tag
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+    virtual ns3::TypeId GetInstanceTypeId (void) const;
+
+    StdmaFlowTag ();
+    StdmaFlowTag (uint32_t flow);
+
+    void SetFlow (uint32_t flow);
+    uint32_t GetFlow (void) const;
+
+    virtual uint32_t GetSerializedSize (void) const;
+    virtual void Serialize (ns3::TagBuffer i) const;
+    virtual void Deserialize (ns3::TagBuffer i);
+    virtual void Print (std::ostream &os) const;
+
+  private:
+    uint32_t m_flow;
+  };
+
+  /**
+   * \brief Bounded transmission queue of the StdmaMac
+   *
+   * The queue keeps its packets in a ring buffer that grows on demand up to the maximum size, such that no
+   * allocations take place once the queue has reached its working size. Periodic broadcasts such as position
+   * reports are only of interest until the next one has been generated, hence the queue can optionally keep only
+   * the latest packet per flow: a new packet replaces the queued packet of the same flow in place, which
+   * preserves the position of the flow in the queue while transmitting the freshest information. If the queue is
+   * full, the oldest packet is dropped in favor of the new one. Packets that have been queued for longer than the
+   * maximum delay are dropped when they reach the head of the queue.
+   */
+  class StdmaMacQueue : public ns3::Object
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaMacQueue ();
+    virtual ~StdmaMacQueue ();
+
+    /**
+     * @param maxSize The maximum number of packets in the queue
+     */
+    void SetMaxSize (uint32_t maxSize);
+    uint32_t GetMaxSize (void) const;
+
+    /**
+     * Adds a packet to the tail of the queue, or replaces the queued packet of the same flow if LatestWins is
+     * enabled. Packets that are replaced, or dropped because the queue is full, are reported by the Drop trace.
+     *
+     * @param packet The packet
+     * @param hdr The MAC header of the packet
+     */
+    void Enqueue (ns3::Ptr<const ns3::Packet> packet, const ns3::WifiMacHeader &hdr);
+
+    /**
+     * Removes the packet at the head of the queue
+     *
+     * @param hdr Receives the MAC header of the packet
+     * @return The packet, or zero if the queue is empty
+     */
+    ns3::Ptr<const ns3::Packet> Dequeue (ns3::WifiMacHeader *hdr);
+
+    /**
+     * @param hdr Receives the MAC header of the packet at the head of the queue
+     * @return The packet at the head of the queue, or zero if the queue is empty
+     */
+    ns3::Ptr<const ns3::Packet> Peek (ns3::WifiMacHeader *hdr);
+
+    bool IsEmpty (void);
+    uint32_t GetSize (void);
+
+    /**
+     * Drops all packets in the queue
+     */
+    void Flush (void);
+
+    /**
+     * @param packet The packet
+     * @return The flow of the packet, i.e. the StdmaFlowTag if present, the LLC/SNAP protocol number otherwise
+     */
+    static uint64_t GetFlow (ns3::Ptr<const ns3::Packet> packet);
+
+  private:
+    virtual void DoDispose (void);
+
+    struct Item
+    {
+      ns3::Ptr<const ns3::Packet> packet;
+      ns3::WifiMacHeader hdr;
+      uint64_t flow;
+      ns3::Time tstamp;
+    };
+
+    /**
+     * Drops the packets at the head of the queue that have been queued for longer than the maximum delay
+     */
+    void Cleanup (void);
+
+    /**
+     * Re-arranges the ring buffer into a buffer of the given capacity, starting at index zero
+     */
+    void Reallocate (uint32_t capacity);
+
+    std::vector<Item> m_items;  // Ring buffer, its size is the current capacity
+    uint32_t m_head;            // Index of the packet at the head of the queue
+    uint32_t m_size;            // Number of packets in the queue
+    uint32_t m_maxSize;
+    ns3::Time m_maxDelay;
+    bool m_latestWins;
+    ns3::TracedCallback<ns3::Ptr<const ns3::Packet> > m_dropTrace;
+  };
+
+} // namespace stdma
+
+#endif /* STDMA_MAC_QUEUE_H_ */
@@ -36,12 +36,16 @@
 #include "ns3/node-list.h"
 #include "ns3/wifi-mac-trailer.h"
 #include "ns3/wifi-tx-vector.h"
+#include "ns3/make-event.h"
+#include "ns3/wifi-channel.h"
 
 #include "stdma-mac.h"
 #include "stdma-net-device.h"
 #include "stdma-header.h"
+#include "stdma-subframe-header.h"
 #include <sstream>
 #include <iostream>
+#include <limits>
 
 namespace stdma
 {
@@ -106,34 +110,40 @@ namespace stdma
                       "The maximum number of bytes per slot (excludes MAC STDMA and lower layer wrapping)."
                       "If packet is greater than this, it will be dropped ",
                       ns3::UintegerValue(500),
-                      ns3::MakeUintegerAccessor(&StdmaMac::m_maxPacketSize),
+                      ns3::MakeUintegerAccessor(&StdmaMac::SetMaximumPacketSize,
+                                                &StdmaMac::GetMaximumPacketSize),
                       ns3::MakeUintegerChecker<uint32_t>())
         .AddAttribute("Timeout",
                       "A RandomVariable used to determine the timeout of a reservation."
-                      "According to the standard, one should use a UniformVariable(3,7) as a configuration here.",
+                      "According to the standard, one should use a UniformVariable(3,7) as a configuration here. "
+                      "The rounded values have to be within 0 and 15, the range of the timeout field of the header.",
                       ns3::RandomVariableValue (ns3::UniformVariable(3, 7)),
                       ns3::MakeRandomVariableAccessor (&StdmaMac::m_timeoutRng),
                       ns3::MakeRandomVariableChecker ())
         .AddAttribute("ReportRate",
                       "The desired number of transmissions per frame",
                       ns3::UintegerValue(2),
-                      ns3::MakeUintegerAccessor(&StdmaMac::m_reportRate),
-                      ns3::MakeUintegerChecker<uint8_t>())
+                      ns3::MakeUintegerAccessor(&StdmaMac::SetReportRate,
+                                                &StdmaMac::GetReportRate),
+                      ns3::MakeUintegerChecker<uint8_t>(1))
         .AddAttribute("WifiMode",
                       "The WiFi mode to use for transmission",
                       ns3::WifiModeValue(ns3::WifiMode("OfdmRate6Mbps")),
-                      ns3::MakeWifiModeAccessor(&StdmaMac::m_wifiMode),
+                      ns3::MakeWifiModeAccessor(&StdmaMac::SetWifiMode,
+                                                &StdmaMac::GetWifiMode),
                       ns3::MakeWifiModeChecker())
         .AddAttribute("WifiPreamble",
                       "The WiFi preamble mode",
                       ns3::EnumValue(ns3::WIFI_PREAMBLE_LONG),
-                      ns3::MakeEnumAccessor(&StdmaMac::m_wifiPreamble),
+                      ns3::MakeEnumAccessor(&StdmaMac::SetWifiPreamble,
+                                            &StdmaMac::GetWifiPreamble),
                       ns3::MakeEnumChecker(ns3::WIFI_PREAMBLE_LONG, "Long WiFi preamble",
                                            ns3::WIFI_PREAMBLE_SHORT, "Short WiFi preamble"))
         .AddAttribute("GuardInterval",
                       "The guard interval added at the end of the slot in us (no transmission time)",
                       ns3::TimeValue(ns3::MicroSeconds(6)),
-                      ns3::MakeTimeAccessor(&StdmaMac::m_guardInterval),
+                      ns3::MakeTimeAccessor(&StdmaMac::SetGuardInterval,
+                                            &StdmaMac::GetGuardInterval),
                       ns3::MakeTimeChecker())
         .AddAttribute("NumberOfRandomAccessSlots",
                       "The number of slots that shall be considered for random access in the network entry phase",
@@ -151,6 +161,30 @@ namespace stdma
                       ns3::UintegerValue(4),
                       ns3::MakeUintegerAccessor(&StdmaMac::SetMinimumCandidateSetSize),
                       ns3::MakeUintegerChecker<uint32_t>())
+        .AddAttribute("PositionKeyInterval",
+                      "If greater than zero, the absolute position is announced under a new key every this many reports, "
+                      "and the reports in between carry the position relative to the key position only (delta coding). "
+                      "Zero disables the delta coding.",
+                      ns3::UintegerValue(0),
+                      ns3::MakeUintegerAccessor(&StdmaMac::m_positionKeyInterval),
+                      ns3::MakeUintegerChecker<uint32_t>())
+        .AddAttribute("Aggregation",
+                      "If enabled, as many queued packets as fit into the maximum packet size are transmitted together "
+                      "in a single slot, each one preceded by a small sub-header.",
+                      ns3::BooleanValue(false),
+                      ns3::MakeBooleanAccessor(&StdmaMac::m_aggregation),
+                      ns3::MakeBooleanChecker())
+        .AddAttribute("SlotClock",
+                      "If enabled, all transmissions (including the network entry) are driven by a single reusable event "
+                      "per station that walks through the transmission schedule of the frame.",
+                      ns3::BooleanValue(false),
+                      ns3::MakeBooleanAccessor(&StdmaMac::m_slotClock),
+                      ns3::MakeBooleanChecker())
+        .AddAttribute ("Queue",
+                      "A reference to the transmission queue",
+                      ns3::PointerValue (),
+                      ns3::MakePointerAccessor (&StdmaMac::m_queue),
+                      ns3::MakePointerChecker<StdmaMacQueue> ())
         .AddAttribute ("SlotManager",
                       "A reference to the slot manager object",
                       ns3::PointerValue (),
@@ -173,19 +207,37 @@ namespace stdma
                       ns3::MakeTraceSourceAccessor (&StdmaMac::m_enqueueTrace))
         .AddTraceSource("EnqueueFail",
                       "This event is triggered whenever a packet attempts to be queued but fails",
-                      ns3::MakeTraceSourceAccessor (&StdmaMac::m_enqueueFailTrace));
+                      ns3::MakeTraceSourceAccessor (&StdmaMac::m_enqueueFailTrace))
+        .AddTraceSource("ReportRateChange",
+                      "This event is triggered whenever the station changes its report rate after its first frame",
+                      ns3::MakeTraceSourceAccessor (&StdmaMac::m_reportRateChangeTrace));
     return tid;
   }
 
   StdmaMac::StdmaMac ()
-   : m_phyListener(0),
+   : m_reportRate(2),
+     m_pendingReportRate(0),
+     m_reportsSinceRateCheck(0),
+     m_positionKeyInterval(0),
+     m_aggregation(false),
+     m_reportsSinceKey(0),
+     m_phyListener(0),
+     m_manager(0),
+     m_slotDuration(ns3::Seconds(0)),
+     m_timingValid(false),
+     m_slotClock(false),
+     m_clockAction(CLOCK_TRANSMIT),
+     m_clockFirstFrame(false),
+     m_clockRemainingSlots(0),
+     m_clockProbability(0),
+     m_rxPowerDbm(std::numeric_limits<double>::quiet_NaN()),
      m_rxOngoing(false),
-     m_rxStart(ns3::Seconds(0)),
-     m_startedUp(false),
-     m_manager(0)
+     m_rxStartSlot(0),
+     m_startedUp(false)
   {
+    m_ownKey.key = 0;
     // Queue to hold packets in
-    m_queue = ns3::CreateObject<ns3::WifiMacQueue>();
+    m_queue = ns3::CreateObject<StdmaMacQueue>();
     m_manager = ns3::CreateObject<StdmaSlotManager>();
   }
 
@@ -211,6 +263,12 @@ namespace stdma
     SetBssid(address);
   }
 
+  void
+  StdmaMac::SetMobility(ns3::Ptr<ns3::MobilityModel> mobility)
+  {
+    m_mobility = mobility;
+  }
+
   bool
   StdmaMac::SupportsSendFrom(void) const
   {
@@ -224,6 +282,7 @@ namespace stdma
     m_phy = phy;
     // Stuff to do when events occur
     m_phy->SetReceiveOkCallback(ns3::MakeCallback(&StdmaMac::Receive, this));
+    m_phy->TraceConnectWithoutContext("MonitorSnifferRx", ns3::MakeCallback(&StdmaMac::SniffRx, this));
     if (m_phyListener != 0)
       {
         delete (m_phyListener);
@@ -249,7 +308,12 @@ namespace stdma
     hdr.SetAddr3(GetBssid());
     hdr.SetDsNotFrom();
     hdr.SetDsNotTo();
+    // The header size depends on the coding of the position, a KEY report is the largest one
     StdmaHeader stdmaHdr;
+    if (m_positionKeyInterval > 0)
+      {
+        stdmaHdr.SetPositionKey(0);
+      }
     ns3::WifiMacTrailer fcs;
     uint32_t numBytes = packet->GetSize() + stdmaHdr.GetSerializedSize() + hdr.GetSize() + fcs.GetSerializedSize();
     if (numBytes <= m_maxPacketSize)
@@ -271,24 +335,132 @@ namespace stdma
   StdmaMac::StartInitializationPhase ()
   {
     NS_LOG_FUNCTION_NOARGS();
-
-    // Create a STDMA slot manager that keeps track of what is going on on the wireless channel
-    m_manager->Setup(ns3::Simulator::Now(), m_frameDuration, GetSlotDuration(), m_minimumCandidateSetSize);
-    m_manager->SetReportRate(m_reportRate);
-    m_manager->SetSelectionIntervalRatio(m_selectionIntervalRatio);
+    StartUp();
 
     // Get starting time of the first super frame
     ns3::Time start = m_manager->GetStart();
     uint64_t Ni = floor(1.0 * m_manager->GetSlotsPerFrame() / m_reportRate);
-    uint64_t slotDuration = m_manager->GetFrameDuration().GetNanoSeconds() / m_manager->GetSlotsPerFrame();
-    ns3::Time end = start + m_manager->GetFrameDuration() + ns3::NanoSeconds(Ni * slotDuration);
+    ns3::Time end = start + m_manager->GetFrameDuration() + ns3::NanoSeconds(Ni * m_slotDuration.GetNanoSeconds());
 
     // Schedule an event for the end of the initialization phase
     m_endInitializationPhaseEvent = ns3::Simulator::Schedule(end - ns3::Simulator::Now(), &StdmaMac::EndOfInitializationPhase, this);
+    m_startupTrace(start, m_manager->GetFrameDuration(), m_slotDuration);
+  }
+
+  void
+  StdmaMac::StartUp ()
+  {
+    // Resolve our own mobility model once, unless it has been provided explicitly. This method is scheduled
+    // within the context of the node by StdmaHelper::Install.
+    if (m_mobility == 0)
+      {
+        m_mobility = ns3::NodeList::GetNode(ns3::Simulator::GetContext())->GetObject<ns3::MobilityModel>();
+      }
+    NS_ASSERT_MSG(m_mobility != 0, "StdmaMac:StartUp() requires a mobility model aggregated to the node");
+
+    // Precompute the slot duration, the transmission parameters and the durations of the packets
+    UpdateSlotTiming();
+
+    // Create a STDMA slot manager that keeps track of what is going on on the wireless channel
+    m_manager->Setup(ns3::Simulator::Now(), m_frameDuration, m_slotDuration, m_minimumCandidateSetSize);
+    // A re-reservation announces an offset of up to two frames, which has to fit into the header
+    if (2 * m_manager->GetSlotsPerFrame() > StdmaHeader::MAX_OFFSET)
+      {
+        NS_FATAL_ERROR("StdmaMac:StartUp() a frame of " << m_manager->GetSlotsPerFrame() << " slots is too long, the header supports at most "
+            << StdmaHeader::MAX_OFFSET / 2 << " slots per frame");
+      }
+
+    // All stations on the same channel share one slot clock, which is aggregated to the channel by the first
+    // station that starts up
+    if (m_channelClock == 0)
+      {
+        ns3::Ptr<ns3::WifiChannel> channel = m_phy->GetChannel();
+        m_channelClock = channel->GetObject<StdmaSlotClock>();
+        if (m_channelClock == 0)
+          {
+            m_channelClock = ns3::CreateObject<StdmaSlotClock>();
+            channel->AggregateObject(m_channelClock);
+          }
+      }
+    m_channelClock->SetSlotDuration(m_slotDuration);
+    m_manager->SetSlotClock(m_channelClock);
+    m_manager->SetReportRate(m_reportRate);
+    m_manager->SetSelectionIntervalRatio(m_selectionIntervalRatio);
 
     // Mark the MAC layer as started up (i.e. powered on)
     m_startedUp = true;
-    m_startupTrace(start, m_manager->GetFrameDuration(), GetSlotDuration());
+  }
+
+  bool
+  StdmaMac::HasEnteredNetwork (void) const
+  {
+    return !m_schedule.empty();
+  }
+
+  void
+  StdmaMac::SaveState (StdmaSnapshotWriter &writer)
+  {
+    NS_LOG_FUNCTION(this);
+    if (!HasEnteredNetwork() || !m_nextTransmissionEvent.IsRunning() || (m_slotClock && m_clockAction != CLOCK_TRANSMIT))
+      {
+        NS_FATAL_ERROR("StdmaMac:SaveState() the station " << m_self << " has not entered the network yet");
+      }
+    writer.WriteU8(m_reportRate);
+    writer.WriteU8(m_pendingReportRate);
+    writer.WriteU32(m_reportsSinceRateCheck);
+    for (uint32_t n = 0; n < m_reportRate; n++)
+      {
+        writer.WriteU32(m_schedule[n]);
+      }
+    writer.WriteTime(ns3::Simulator::Now() + ns3::Simulator::GetDelayLeft(m_nextTransmissionEvent));
+    writer.WriteU8(m_clockFirstFrame);
+    writer.WriteU32(m_reportsSinceKey);
+    writer.WriteU8(m_ownKey.key);
+    writer.WriteVector(m_ownKey.position);
+    writer.WriteU32(m_keys.size());
+    for (std::map<ns3::Mac48Address, PositionKey>::iterator it = m_keys.begin(); it != m_keys.end(); ++it)
+      {
+        writer.WriteAddress(it->first);
+        writer.WriteU8(it->second.key);
+        writer.WriteVector(it->second.position);
+      }
+    m_manager->SaveState(writer);
+  }
+
+  void
+  StdmaMac::RestoreState (std::string state)
+  {
+    NS_LOG_FUNCTION(this);
+    StartUp();
+    NS_ASSERT_MSG(ns3::Simulator::Now().GetNanoSeconds() % m_slotDuration.GetNanoSeconds() == 0, "StdmaMac:RestoreState() has to be called at a slot boundary");
+
+    StdmaSnapshotReader reader(state, ns3::Simulator::Now());
+    m_reportRate = reader.ReadU8();
+    m_pendingReportRate = reader.ReadU8();
+    m_reportsSinceRateCheck = reader.ReadU32();
+    m_schedule.resize(m_reportRate);
+    for (uint32_t n = 0; n < m_reportRate; n++)
+      {
+        m_schedule[n] = reader.ReadU32();
+      }
+    ns3::Time next = reader.ReadTime();
+    bool firstFrame = reader.ReadU8();
+    m_reportsSinceKey = reader.ReadU32();
+    m_ownKey.key = reader.ReadU8();
+    m_ownKey.position = reader.ReadVector();
+    m_keys.clear();
+    uint32_t keys = reader.ReadU32();
+    for (uint32_t k = 0; k < keys; k++)
+      {
+        ns3::Mac48Address neighbor = reader.ReadAddress();
+        PositionKey &key = m_keys[neighbor];
+        key.key = reader.ReadU8();
+        key.position = reader.ReadVector();
+      }
+    m_manager->RestoreState(reader);
+    NS_ASSERT_MSG(reader.IsAtEnd(), "StdmaMac:RestoreState() the snapshot has not been read completely");
+
+    ScheduleTransmission(next - ns3::Simulator::Now(), firstFrame);
   }
 
   void
@@ -297,14 +469,14 @@ namespace stdma
     NS_LOG_FUNCTION(ns3::Simulator::GetContext());
 
     // Determine random access details of the network entry transmission
-    ns3::Ptr<RandomAccessDetails> details = m_manager->GetNetworkEntryTimestamp(m_slotsForRtdma, 0.0);
+    m_manager->SetPosition(m_mobility->GetPosition());
+    RandomAccessDetails details = m_manager->GetNetworkEntryTimestamp(m_slotsForRtdma, 0.0);
 
     // Schedule an event for this transmission
-    ns3::Time delay = details->GetWhen() - ns3::Simulator::Now();
-    m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, &StdmaMac::PerformNetworkEntry, this,
-        details->GetRemainingSlots(), details->GetProbability());
+    ns3::Time delay = details.GetWhen() - ns3::Simulator::Now();
+    ScheduleNetworkEntry(delay, details.GetRemainingSlots(), details.GetProbability());
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:EndOfInitializationPhase() scheduled network entry " << delay.GetSeconds() << " in the future");
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:EndOfInitializationPhase() refers to global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(details->GetWhen()));
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:EndOfInitializationPhase() refers to global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(details.GetWhen()));
   }
 
   void
@@ -316,9 +488,11 @@ namespace stdma
 
     // Sanity check: do we have properly assigned slot start times?
     ns3::Time baseTime = ns3::Simulator::Now() - m_manager->GetStart();
-    uint64_t slotTime = m_manager->GetFrameDuration().GetNanoSeconds() / m_manager->GetSlotsPerFrame();
+    uint64_t slotTime = m_slotDuration.GetNanoSeconds();
     NS_ASSERT (baseTime.GetNanoSeconds() % slotTime == 0);
     bool isTaken = false;
+    ns3::Vector position = m_mobility->GetPosition();
+    m_manager->SetPosition(position);
 
     // 0) Check if the current slot is still marked as free, if not: schedule a new
     //    event for PerformNetworkEntry following the RA-TDMA access rules
@@ -329,12 +503,12 @@ namespace stdma
 
         if (remainingSlots > 0 && m_manager->HasFreeSlotsLeft(remainingSlots))
           {
-            ns3::Ptr<RandomAccessDetails> details = m_manager->GetNetworkEntryTimestamp(remainingSlots, p);
-            ns3::Time delay = details->GetWhen() - ns3::Simulator::Now();
-            m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, &StdmaMac::PerformNetworkEntry, this, details->GetRemainingSlots(), details->GetProbability());
+            RandomAccessDetails details = m_manager->GetNetworkEntryTimestamp(remainingSlots, p);
+            ns3::Time delay = details.GetWhen() - ns3::Simulator::Now();
+            ScheduleNetworkEntry(delay, details.GetRemainingSlots(), details.GetProbability());
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:PerformNetworkEntry() there were still free slots afterward, scheduling a new network entry "
                 << delay.GetSeconds() << " in the future");
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:PerformNetworkEntry() refers to global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(details->GetWhen()));
+            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:PerformNetworkEntry() refers to global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(details.GetWhen()));
             return;
           }
       }
@@ -346,33 +520,40 @@ namespace stdma
     m_manager->SelectNominalSlots();
 
     // 3a) Select the first nominal transmission slot
-    uint8_t timeout = floor(m_timeoutRng.GetValue() + 0.5);
+    uint8_t timeout = DrawTimeout();
     m_manager->SelectTransmissionSlotForReservationWithNo(0, timeout);
-    ns3::Time delay = m_manager->GetTimeUntilTransmissionOfReservationWithNo(0);
+    m_schedule.assign(m_reportRate, 0);
+    m_schedule[0] = m_manager->GetSlotIndexOfReservationWithNo(0);
+    ns3::Time delay;
+    if (m_slotClock)
+      {
+        // The frame has been re-based to start with the next slot, hence we are in its very last slot
+        delay = ns3::NanoSeconds((m_schedule[0] + 1) * slotTime);
+      }
+    else
+      {
+        delay = m_manager->GetTimeUntilTransmissionOfReservationWithNo(0);
+      }
     NS_ASSERT(delay.GetNanoSeconds() % slotTime == 0);
     uint32_t offset = (delay.GetNanoSeconds() / slotTime);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:PerformNetworkEntry() offset refers to global slot with id "
     		<< m_manager->GetGlobalSlotIndexForTimestamp(ns3::Simulator::Now() + ns3::NanoSeconds(offset * slotTime)));
 
-    // 3b) Transmit the network entry packet
-    ns3::WifiMacHeader wifiMacHdr;
-    ns3::Ptr<ns3::Packet> packet = m_queue->Dequeue(&wifiMacHdr)->Copy();
-
-    //     Create a STDMA header object and fill it properly...
+    // 3b) Transmit the network entry packet, create a STDMA header object and fill it properly...
     StdmaHeader stdmaHdr;
     stdmaHdr.SetOffset(offset);
     stdmaHdr.SetTimeout(0);
-    ns3::Ptr<ns3::Node> myself = ns3::NodeList::GetNode(ns3::Simulator::GetContext());
-    ns3::Ptr<ns3::MobilityModel> mobility = myself->GetObject<ns3::MobilityModel>();
-    stdmaHdr.SetLatitude(mobility->GetPosition().x);
-    stdmaHdr.SetLongitude(mobility->GetPosition().y);
+    EncodePosition(stdmaHdr, position);
     stdmaHdr.SetNetworkEntry();
 
+    //     ... and take the payload from the queue
+    ns3::WifiMacHeader wifiMacHdr;
+    ns3::Ptr<ns3::Packet> packet = DequeueSlotPayload(stdmaHdr, wifiMacHdr);
+
     //     Create a frame check sequence trailer
     ns3::WifiMacTrailer fcs;
     const uint32_t slotBytes = packet->GetSize() + stdmaHdr.GetSerializedSize() + wifiMacHdr.GetSize() + fcs.GetSerializedSize();
-    ns3::WifiTxVector txVector(m_wifiMode, 1, 0, false, 1, 1, false);
-    ns3::Time txDuration = m_phy->CalculateTxDuration(slotBytes, txVector, m_wifiPreamble);
+    ns3::Time txDuration = GetTxDuration(slotBytes);
     wifiMacHdr.SetDuration(txDuration);
 
     //     Add everything to the packet
@@ -388,12 +569,12 @@ namespace stdma
 
     //     Send packet through physical layer
     NS_ASSERT_MSG (!m_phy->IsStateTx(), "StdmaMac:PerformNetworkEntry() physical layer should not be transmitting already.");
-    m_phy->SendPacket(packet, m_wifiMode, m_wifiPreamble, txVector);
+    m_phy->SendPacket(packet, m_wifiMode, m_wifiPreamble, m_txVector);
     NS_ASSERT (m_phy->IsStateTx ());
     m_networkEntryTrace(packet, delay, isTaken);
 
     // 4) Schedule an event for the next transmission
-    m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, &StdmaMac::DoTransmit, this, true);
+    ScheduleTransmission(delay, true);
   }
 
   void
@@ -404,12 +585,41 @@ namespace stdma
 
     // Sanity check: do we have properly assigned slot start times?
     ns3::Time baseTime = ns3::Simulator::Now() - m_manager->GetStart();
-    uint64_t slotTime = m_manager->GetFrameDuration().GetNanoSeconds() / m_manager->GetSlotsPerFrame();
+    uint64_t slotTime = m_slotDuration.GetNanoSeconds();
     NS_ASSERT (baseTime.GetNanoSeconds() % slotTime == 0);
 
-    if (m_queue->IsEmpty())
+    // 0) Take a snapshot of our position, which is used for the slot selection and announced in the header
+    ns3::Vector position = m_mobility->GetPosition();
+    m_manager->SetPosition(position);
+
+    // 0b) Once all reservations have been made, the report rate may be adapted to the channel load (once per
+    //     frame) and a pending change of the report rate is applied before the current transmission
+    if (!firstFrame)
       {
-        NS_FATAL_ERROR("StdmaMac:DoTransmit() is called but no packets in queue which could be transmitted.");
+        if (!m_reportRateCallback.IsNull() && ++m_reportsSinceRateCheck >= m_reportRate)
+          {
+            m_reportsSinceRateCheck = 0;
+            uint8_t rate = m_reportRateCallback(m_manager->GetChannelLoad());
+            if (rate > 0)
+              {
+                SetReportRate(rate);
+              }
+          }
+        if (m_pendingReportRate > 0)
+          {
+            uint8_t previous = m_reportRate;
+            uint8_t timeout = DrawTimeout();
+            m_reportRate = m_pendingReportRate;
+            m_pendingReportRate = 0;
+            m_manager->ChangeReportRate(m_reportRate, timeout);
+            m_schedule.resize(m_reportRate);
+            for (uint32_t n = 0; n < m_reportRate; n++)
+              {
+                m_schedule[n] = m_manager->GetSlotIndexOfReservationWithNo(n);
+              }
+            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DoTransmit() changed report rate from " << (uint32_t) previous << " to " << (uint32_t) m_reportRate);
+            m_reportRateChangeTrace(previous, m_reportRate);
+          }
       }
 
     // 1) Define the packet numbers (note: these are not the slot identifiers) of the current and the next transmission
@@ -423,16 +633,28 @@ namespace stdma
     //    transmitted.
     if (firstFrame && (next > current))
       {
-        uint8_t timeout = floor(m_timeoutRng.GetValue() + 0.5);
+        uint8_t timeout = DrawTimeout();
         m_manager->SelectTransmissionSlotForReservationWithNo(next, timeout);
+        m_schedule[next] = m_manager->GetSlotIndexOfReservationWithNo(next);
       }
 
     // 2b) Schedule an event for the next packet transmission
-    ns3::Time delay = m_manager->GetTimeUntilTransmissionOfReservationWithNo(next);
+    ns3::Time delay;
+    if (m_slotClock)
+      {
+        // We are at the beginning of the slot of the current reservation, so the delay follows from the schedule
+        uint32_t numSlots = m_manager->GetSlotsPerFrame();
+        uint32_t slots = (m_schedule[next] + numSlots - m_schedule[current]) % numSlots;
+        delay = ns3::NanoSeconds((slots == 0 ? numSlots : slots) * slotTime);
+      }
+    else
+      {
+        delay = m_manager->GetTimeUntilTransmissionOfReservationWithNo(next);
+      }
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DoTransmit() delay until next transmission event = " << delay.GetSeconds());
     bool stillFirstFrame = firstFrame && (current < next);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DoTransmit() stillFirstFrame = " << stillFirstFrame);
-    m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, &StdmaMac::DoTransmit, this, stillFirstFrame);
+    ScheduleTransmission(delay, stillFirstFrame);
 
     // 2c) Check whether the current packet number needs re-reservation. If yes, perform the re-reservation
     //     and calculate the offset for the next frame (which is the difference between the current slot index
@@ -441,8 +663,9 @@ namespace stdma
     uint8_t timeout = m_manager->DecreaseTimeOutOfReservationWithNumber(current);
     if (m_manager->NeedsReReservation(current))
       {
-        uint8_t timeout = floor(m_timeoutRng.GetValue() + 0.5);
+        uint8_t timeout = DrawTimeout();
         offset = m_manager->ReSelectTransmissionSlotForReservationWithNo(current, timeout);
+        m_schedule[current] = m_manager->GetSlotIndexOfReservationWithNo(current);
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DoTransmit() offset for same reservation in next frame = " << offset);
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DoTransmit() offset refers to global slot with id " << m_manager->GetGlobalSlotIndexForTimestamp(ns3::Simulator::Now()) + offset);
       }
@@ -454,25 +677,20 @@ namespace stdma
       }
 
 
-    // 3) Perform transmission, which means we need to get a packet from the transmission queue,
-    //    add a STDMA header, and then forward it to the physical layer
-    ns3::WifiMacHeader wifiMacHdr;
-    ns3::Ptr<ns3::Packet> packet = m_queue->Dequeue(&wifiMacHdr)->Copy();
-
+    // 3) Perform transmission, which means we need to create a STDMA header, get the payload from the
+    //    transmission queue, and then forward it to the physical layer
     // 3a) Create a STDMA header object and fill it properly...
     StdmaHeader stdmaHdr;
     stdmaHdr.SetOffset(offset);
     stdmaHdr.SetTimeout(timeout);
-    ns3::Ptr<ns3::Node> myself = ns3::NodeList::GetNode(ns3::Simulator::GetContext());
-    ns3::Ptr<ns3::MobilityModel> mobility = myself->GetObject<ns3::MobilityModel>();
-    stdmaHdr.SetLatitude(mobility->GetPosition().x);
-    stdmaHdr.SetLongitude(mobility->GetPosition().y);
+    EncodePosition(stdmaHdr, position);
+    ns3::WifiMacHeader wifiMacHdr;
+    ns3::Ptr<ns3::Packet> packet = DequeueSlotPayload(stdmaHdr, wifiMacHdr);
 
     // 3b) Create a frame check sequence trailer
     ns3::WifiMacTrailer fcs;
     const uint32_t slotBytes = packet->GetSize() + stdmaHdr.GetSerializedSize() + wifiMacHdr.GetSize() + fcs.GetSerializedSize();
-    ns3::WifiTxVector txVector(m_wifiMode, 1, 0, false, 1, 1, false);
-    ns3::Time txDuration = m_phy->CalculateTxDuration(slotBytes, txVector, m_wifiPreamble);
+    ns3::Time txDuration = GetTxDuration(slotBytes);
     wifiMacHdr.SetDuration(txDuration);
 
     // 3c) Add everything to the packet
@@ -489,11 +707,71 @@ namespace stdma
 
     // 3d) Send packet through physical layer
     NS_ASSERT_MSG (!m_phy->IsStateTx(), "StdmaMac:DoTransmit() physical layer should not be transmitting already.");
-    m_phy->SendPacket(packet, m_wifiMode, m_wifiPreamble, txVector);
+    m_phy->SendPacket(packet, m_wifiMode, m_wifiPreamble, m_txVector);
     NS_ASSERT (m_phy->IsStateTx ());
     m_txTrace(packet, current, timeout, offset);
   }
 
+  void
+  StdmaMac::ScheduleNetworkEntry(ns3::Time delay, uint32_t remainingSlots, double p)
+  {
+    if (m_slotClock)
+      {
+        m_clockAction = CLOCK_NETWORK_ENTRY;
+        m_clockRemainingSlots = remainingSlots;
+        m_clockProbability = p;
+        ScheduleSlotClock(delay);
+      }
+    else
+      {
+        m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, &StdmaMac::PerformNetworkEntry, this, remainingSlots, p);
+      }
+  }
+
+  void
+  StdmaMac::ScheduleTransmission(ns3::Time delay, bool firstFrame)
+  {
+    m_clockFirstFrame = firstFrame;
+    if (m_slotClock)
+      {
+        m_clockAction = CLOCK_TRANSMIT;
+        ScheduleSlotClock(delay);
+      }
+    else
+      {
+        m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, &StdmaMac::DoTransmit, this, firstFrame);
+      }
+  }
+
+  void
+  StdmaMac::ScheduleSlotClock(ns3::Time delay)
+  {
+    // The event implementation is created once and handed to the simulator again for every tick
+    if (m_slotClockEvent == 0)
+      {
+        m_slotClockEvent = ns3::Ptr<ns3::EventImpl>(ns3::MakeEvent(&StdmaMac::SlotClockTick, this), false);
+      }
+    NS_ASSERT_MSG(!m_nextTransmissionEvent.IsRunning(), "StdmaMac:ScheduleSlotClock() the slot clock is already pending.");
+    m_nextTransmissionEvent = ns3::Simulator::Schedule(delay, m_slotClockEvent);
+  }
+
+  void
+  StdmaMac::SlotClockTick()
+  {
+    switch (m_clockAction)
+      {
+    case CLOCK_NETWORK_ENTRY:
+      PerformNetworkEntry(m_clockRemainingSlots, m_clockProbability);
+      break;
+    case CLOCK_TRANSMIT:
+      DoTransmit(m_clockFirstFrame);
+      break;
+    default:
+      NS_ASSERT(false);
+      break;
+      }
+  }
+
   ns3::Mac48Address
   StdmaMac::GetBssid(void) const
   {
@@ -534,6 +812,46 @@ namespace stdma
   StdmaMac::SetGuardInterval(const ns3::Time gi)
   {
     m_guardInterval = gi;
+    m_timingValid = false;
+  }
+
+  ns3::WifiMode
+  StdmaMac::GetWifiMode (void) const
+  {
+    return m_wifiMode;
+  }
+
+  void
+  StdmaMac::SetWifiMode (ns3::WifiMode mode)
+  {
+    m_wifiMode = mode;
+    m_timingValid = false;
+  }
+
+  ns3::WifiPreamble
+  StdmaMac::GetWifiPreamble (void) const
+  {
+    return m_wifiPreamble;
+  }
+
+  void
+  StdmaMac::SetWifiPreamble (ns3::WifiPreamble preamble)
+  {
+    m_wifiPreamble = preamble;
+    m_timingValid = false;
+  }
+
+  uint32_t
+  StdmaMac::GetMaximumPacketSize (void) const
+  {
+    return m_maxPacketSize;
+  }
+
+  void
+  StdmaMac::SetMaximumPacketSize (uint32_t size)
+  {
+    m_maxPacketSize = size;
+    m_timingValid = false;
   }
 
   void
@@ -548,6 +866,44 @@ namespace stdma
     return m_selectionIntervalRatio;
   }
 
+  void
+  StdmaMac::SetReportRate (uint8_t rate)
+  {
+    NS_ASSERT(rate > 0);
+    if (m_schedule.empty())
+      {
+        // We did not enter the network yet, hence there are no reservations to adapt
+        m_reportRate = rate;
+        m_pendingReportRate = 0;
+        if (m_startedUp)
+          {
+            m_manager->SetReportRate(m_reportRate);
+          }
+      }
+    else
+      {
+        m_pendingReportRate = (rate != m_reportRate) ? rate : 0;
+      }
+  }
+
+  uint8_t
+  StdmaMac::GetReportRate (void) const
+  {
+    return (m_pendingReportRate > 0) ? m_pendingReportRate : m_reportRate;
+  }
+
+  void
+  StdmaMac::SetReportRateCallback (ns3::Callback<uint8_t, double> callback)
+  {
+    m_reportRateCallback = callback;
+  }
+
+  ns3::Ptr<StdmaSlotManager>
+  StdmaMac::GetSlotManager (void) const
+  {
+    return m_manager;
+  }
+
   void
   StdmaMac::SetMinimumCandidateSetSize (uint32_t size)
   {
@@ -605,10 +961,169 @@ namespace stdma
 
   ns3::Time
   StdmaMac::GetSlotDuration()
+  {
+    if (!m_timingValid)
+      {
+        UpdateSlotTiming();
+      }
+    return m_slotDuration;
+  }
+
+  uint8_t
+  StdmaMac::DrawTimeout()
+  {
+    double timeout = floor(m_timeoutRng.GetValue() + 0.5);
+    if (timeout < 0 || timeout > StdmaHeader::MAX_TIMEOUT)
+      {
+        NS_FATAL_ERROR("StdmaMac:DrawTimeout() the timeout " << timeout << " is out of the range from 0 to "
+            << (uint32_t) StdmaHeader::MAX_TIMEOUT << " supported by the header");
+      }
+    return (uint8_t) timeout;
+  }
+
+  void
+  StdmaMac::UpdateSlotTiming()
   {
     NS_LOG_FUNCTION_NOARGS();
-    ns3::WifiTxVector txVector(m_wifiMode, 1, 0, false, 1, 1, false);
-    return m_phy->CalculateTxDuration(m_maxPacketSize, txVector, m_wifiPreamble) + m_guardInterval;
+    m_txVector = ns3::WifiTxVector(m_wifiMode, 1, 0, false, 1, 1, false);
+    // Once the frame structure has been set up, the slot duration must not change anymore
+    if (!m_startedUp)
+      {
+        m_slotDuration = m_phy->CalculateTxDuration(m_maxPacketSize, m_txVector, m_wifiPreamble) + m_guardInterval;
+      }
+    // The transmission durations are filled in on demand, a zero duration marks an entry not computed yet
+    m_txDurations.assign(m_maxPacketSize + 1, ns3::Seconds(0));
+    m_timingValid = true;
+  }
+
+  ns3::Time
+  StdmaMac::GetTxDuration(uint32_t bytes)
+  {
+    if (!m_timingValid)
+      {
+        UpdateSlotTiming();
+      }
+    NS_ASSERT(bytes < m_txDurations.size());
+    ns3::Time &duration = m_txDurations[bytes];
+    if (duration.IsZero())
+      {
+        duration = m_phy->CalculateTxDuration(bytes, m_txVector, m_wifiPreamble);
+      }
+    return duration;
+  }
+
+  void
+  StdmaMac::EncodePosition(StdmaHeader &hdr, ns3::Vector position)
+  {
+    hdr.SetLatitude(position.x);
+    hdr.SetLongitude(position.y);
+    if (m_positionKeyInterval == 0)
+      {
+        return;
+      }
+    if (m_reportsSinceKey == 0 || m_reportsSinceKey >= m_positionKeyInterval
+        || !hdr.SetPositionDelta(m_ownKey.key, m_ownKey.position.x, m_ownKey.position.y))
+      {
+        m_ownKey.key++;
+        m_ownKey.position = ns3::Vector(hdr.GetLatitude(), hdr.GetLongitude(), 0);
+        hdr.SetPositionKey(m_ownKey.key);
+        m_reportsSinceKey = 0;
+      }
+    m_reportsSinceKey++;
+  }
+
+  ns3::Vector
+  StdmaMac::DecodePosition(StdmaHeader &hdr, ns3::Mac48Address from)
+  {
+    if (hdr.GetPositionCoding() == StdmaHeader::ABSOLUTE)
+      {
+        return ns3::Vector(hdr.GetLatitude(), hdr.GetLongitude(), 0);
+      }
+    if (hdr.GetPositionCoding() == StdmaHeader::KEY)
+      {
+        PositionKey &key = m_keys[from];
+        key.key = hdr.GetPositionKey();
+        key.position = ns3::Vector(hdr.GetLatitude(), hdr.GetLongitude(), 0);
+        return key.position;
+      }
+    std::map<ns3::Mac48Address, PositionKey>::iterator it = m_keys.find(from);
+    if (it == m_keys.end())
+      {
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DecodePosition() no key position known for " << from);
+        return m_mobility->GetPosition();
+      }
+    if (it->second.key != hdr.GetPositionKey())
+      {
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DecodePosition() key " << (uint32_t) hdr.GetPositionKey()
+            << " of " << from << " is unknown, using key " << (uint32_t) it->second.key << " instead");
+        return it->second.position;
+      }
+    hdr.ResolvePositionDelta(it->second.position.x, it->second.position.y);
+    return ns3::Vector(hdr.GetLatitude(), hdr.GetLongitude(), 0);
+  }
+
+  ns3::Ptr<ns3::Packet>
+  StdmaMac::DequeueSlotPayload(StdmaHeader &stdmaHdr, ns3::WifiMacHeader &wifiMacHdr)
+  {
+    if (m_queue->IsEmpty())
+      {
+        // Nothing to transmit, but the reservation is kept alive by transmitting the headers only
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DequeueSlotPayload() queue is empty, transmitting a keep-alive");
+        wifiMacHdr.SetTypeData();
+        wifiMacHdr.SetAddr1(ns3::Mac48Address::GetBroadcast());
+        wifiMacHdr.SetAddr2(GetAddress());
+        wifiMacHdr.SetAddr3(GetBssid());
+        wifiMacHdr.SetDsNotFrom();
+        wifiMacHdr.SetDsNotTo();
+        return ns3::Create<ns3::Packet>();
+      }
+    ns3::Ptr<ns3::Packet> packet = m_queue->Dequeue(&wifiMacHdr)->Copy();
+    if (!m_aggregation)
+      {
+        return packet;
+      }
+
+    // Append further packets as long as they fit into the slot, together with their sub-headers
+    StdmaSubframeHeader subHdr;
+    ns3::WifiMacTrailer fcs;
+    uint32_t bytes = wifiMacHdr.GetSize() + stdmaHdr.GetSerializedSize() + fcs.GetSerializedSize()
+        + subHdr.GetSerializedSize() + packet->GetSize();
+    ns3::Ptr<ns3::Packet> aggregate = 0;
+    ns3::WifiMacHeader nextHdr;
+    while (!m_queue->IsEmpty())
+      {
+        ns3::Ptr<const ns3::Packet> next = m_queue->Peek(&nextHdr);
+        if (bytes + subHdr.GetSerializedSize() + next->GetSize() > m_maxPacketSize)
+          {
+            break;
+          }
+        // All subframes are delivered with the MAC header of the frame, hence only packets with the same
+        // addresses are aggregated
+        if (nextHdr.GetAddr1() != wifiMacHdr.GetAddr1() || nextHdr.GetAddr2() != wifiMacHdr.GetAddr2()
+            || nextHdr.GetAddr3() != wifiMacHdr.GetAddr3())
+          {
+            break;
+          }
+        m_queue->Dequeue(&nextHdr);
+        if (aggregate == 0)
+          {
+            aggregate = packet;
+            subHdr.SetLength(aggregate->GetSize());
+            aggregate->AddHeader(subHdr);
+          }
+        ns3::Ptr<ns3::Packet> part = next->Copy();
+        subHdr.SetLength(part->GetSize());
+        part->AddHeader(subHdr);
+        aggregate->AddAtEnd(part);
+        bytes += part->GetSize();
+      }
+    if (aggregate == 0)
+      {
+        return packet;
+      }
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:DequeueSlotPayload() aggregated " << bytes << " bytes");
+    stdmaHdr.SetAggregated();
+    return aggregate;
   }
 
   void
@@ -632,10 +1147,21 @@ namespace stdma
     m_linkDown = linkDown;
   }
 
+  void
+  StdmaMac::SniffRx (ns3::Ptr<const ns3::Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber, uint32_t rate,
+                     bool isShortPreamble, double signalDbm, double noiseDbm)
+  {
+    NS_LOG_FUNCTION(this << packet << signalDbm << noiseDbm);
+    m_rxPowerDbm = signalDbm;
+  }
+
   void
   StdmaMac::Receive (ns3::Ptr<ns3::Packet> packet, double rxSnr, ns3::WifiMode txMode, ns3::WifiPreamble preamble)
   {
     NS_LOG_FUNCTION(this << packet << rxSnr << txMode << preamble);
+    // The power is only valid for this reception, the next one reports its own (if the phy supports it)
+    double rxPowerDbm = m_rxPowerDbm;
+    m_rxPowerDbm = std::numeric_limits<double>::quiet_NaN();
 
     if (!m_startedUp )
       {
@@ -684,8 +1210,8 @@ namespace stdma
         const ns3::Mac48Address to = wifiMacHdr.GetAddr1();
         const ns3::Mac48Address from = wifiMacHdr.GetAddr2();
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() received a broadcast packet from " << from);
-        uint32_t current = m_manager->GetSlotIndexForTimestamp(ns3::Simulator::Now());
-        ns3::Vector position(stdmaHdr.GetLatitude(), stdmaHdr.GetLongitude(), 0);
+        uint32_t current = m_manager->GetCurrentSlotIndex();
+        ns3::Vector position = DecodePosition(stdmaHdr, from);
         uint8_t timeout = stdmaHdr.GetTimeout();
         uint16_t offset = stdmaHdr.GetOffset();
         bool networkEntry = stdmaHdr.GetNetworkEntry();
@@ -701,9 +1227,9 @@ namespace stdma
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() --> timeout is greater than zero");
             uint32_t next = (current + offset < m_manager->GetSlotsPerFrame()) ? current + offset : current + offset - m_manager->GetSlotsPerFrame();
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() next = " << next);
-            m_manager->MarkSlotAsAllocated(current, stdmaHdr.GetTimeout(), from, position);
+            m_manager->MarkSlotAsAllocated(current, stdmaHdr.GetTimeout(), from, position, ns3::Seconds(0), rxPowerDbm);
             // in this case, the offset further identifies the next expected transmission slot
-            m_manager->MarkSlotAsAllocated(next, 1, from, position);
+            m_manager->MarkSlotAsAllocated(next, 1, from, position, ns3::Seconds(0), rxPowerDbm);
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() next refers to the global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(ns3::Simulator::Now()) + offset);
           }
         else  // if the timeout is equal to zero we might be in one of the two following cases:
@@ -723,7 +1249,7 @@ namespace stdma
                   NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() offset = " << offset);
                   NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() next = " << next);
                   NS_ASSERT(next < m_manager->GetSlotsPerFrame());
-                  m_manager->MarkSlotAsAllocated(next, 1, from, position);
+                  m_manager->MarkSlotAsAllocated(next, 1, from, position, ns3::Seconds(0), rxPowerDbm);
                   NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() --> this was a network entry packet, next = " << next);
                   NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() next refers to the global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(ns3::Simulator::Now()) + offset);
                 }
@@ -747,23 +1273,38 @@ namespace stdma
                     }
                   NS_ASSERT(newSlot >= 0);
                   NS_ASSERT(newSlot < m_manager->GetSlotsPerFrame());
-                  if (!m_manager->GetSlot(current)->IsInternallyAllocated())
+                  if (!m_manager->GetSlot(current).IsInternallyAllocated())
                     {
                       NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() marking slot " << current << " as free in the next frame");
                       m_manager->MarkSlotAsFreeAgain(current);
                     }
                   NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() marking slot " << newSlot << " as allocated in the next frame");
-                  double slotDuration = m_frameDuration.GetSeconds() / m_manager->GetSlotsPerFrame();
-                  ns3::Time when = ns3::Simulator::Now() + ns3::Seconds(slotDuration * (offset-1));
-                  m_manager->MarkSlotAsAllocated(newSlot, 2, from, position, when);
+                  ns3::Time when = ns3::Simulator::Now() + ns3::NanoSeconds(m_slotDuration.GetNanoSeconds() * (offset-1));
+                  m_manager->MarkSlotAsAllocated(newSlot, 2, from, position, when, rxPowerDbm);
                   NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:Receive() newSlot refers to the global slot id " << m_manager->GetGlobalSlotIndexForTimestamp(ns3::Simulator::Now()) + offset);
                 }
           }
 
         m_rxTrace(packet, timeout, offset);
 
-        // ... and finally pass it up the protocol stack
-        ForwardUp(packet, from, to);
+        // ... and finally pass it up the protocol stack, packet by packet if the frame is an aggregate, and not at
+        // all if it is a keep-alive
+        if (stdmaHdr.GetAggregated())
+          {
+            StdmaSubframeHeader subHdr;
+            while (packet->GetSize() > 0)
+              {
+                packet->RemoveHeader(subHdr);
+                NS_ASSERT_MSG(subHdr.GetLength() <= packet->GetSize(), "StdmaMac:Receive() " << m_self << " received a truncated aggregate");
+                ns3::Ptr<ns3::Packet> part = packet->CreateFragment(0, subHdr.GetLength());
+                packet->RemoveAtStart(subHdr.GetLength());
+                ForwardUp(part, from, to);
+              }
+          }
+        else if (packet->GetSize() > 0)
+          {
+            ForwardUp(packet, from, to);
+          }
       }
   }
 
@@ -773,7 +1314,7 @@ namespace stdma
     if (m_startedUp && m_manager->GetStart() <= ns3::Simulator::Now())
       {
         m_rxOngoing = true;
-        m_rxStart = ns3::Simulator::Now();
+        m_rxStartSlot = m_channelClock->GetCurrentSlot();
       }
   }
 
@@ -794,12 +1335,9 @@ namespace stdma
       {
         NS_ASSERT(m_rxOngoing);
         m_rxOngoing = false;
-        uint32_t slotAtStart = m_manager->GetSlotIndexForTimestamp(m_rxStart);
-        uint32_t slotAtEnd = m_manager->GetSlotIndexForTimestamp(ns3::Simulator::Now());
-        for (uint32_t i = slotAtStart; i <= slotAtEnd; i++)
-          {
-            m_manager->MarkSlotAsBusy(i);
-          }
+        uint64_t end = m_channelClock->GetCurrentSlot();
+        NS_ASSERT(end >= m_rxStartSlot);
+        m_manager->MarkSlotRangeAsBusy(m_manager->GetSlotIndexForGlobalSlot(m_rxStartSlot), end - m_rxStartSlot + 1);
       }
   }
 
@@ -809,18 +1347,17 @@ namespace stdma
     NS_LOG_FUNCTION_NOARGS();
     if (m_startedUp && m_manager->GetStart() <= ns3::Simulator::Now())
       {
-        uint32_t slotAtStart = m_manager->GetSlotIndexForTimestamp(ns3::Simulator::Now());
+        uint64_t start = m_channelClock->GetCurrentSlot();
         // note: we subtract one microseconds in the following line to make sure that we do not hit the border
         // between two slots
-        uint32_t slotAtEnd = m_manager->GetSlotIndexForTimestamp(ns3::Simulator::Now() + duration - ns3::MicroSeconds(1));
-        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:HandleMaybeCcaBusyStartNow() CCA busy period lasts from slot " << slotAtStart << " to slot " << slotAtEnd);
+        uint64_t end = m_channelClock->GetSlotForTimestamp(ns3::Simulator::Now() + duration - ns3::MicroSeconds(1));
+        uint32_t slotAtStart = m_manager->GetSlotIndexForGlobalSlot(start);
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaMac:HandleMaybeCcaBusyStartNow() CCA busy period lasts from slot " << slotAtStart << " for " << (end - start + 1) << " slots");
 
         // We can safely mark all these slots as busy, because in case the transmissions can be decoded successfully,
-        // they corresponding reception event will override the status of this/these slots
-        for (uint32_t i = slotAtStart; i <= slotAtEnd; i++)
-          {
-            m_manager->MarkSlotAsBusy(i);
-          }
+        // they corresponding reception event will override the status of this/these slots. The range may wrap
+        // around at the end of the frame.
+        m_manager->MarkSlotRangeAsBusy(slotAtStart, end - start + 1);
       }
   }
 
@@ -26,14 +26,20 @@
 #include "ns3/mac48-address.h"
 #include "ns3/wifi-mac-header.h"
 #include "ns3/event-id.h"
+#include "ns3/event-impl.h"
 #include "ns3/random-variable.h"
 #include "ns3/vector.h"
-#include "ns3/wifi-mac-queue.h"
+#include "ns3/mobility-model.h"
+#include "stdma-mac-queue.h"
 #include "stdma-slot-manager.h"
 
 #include "ns3/wifi-phy.h"
+#include "ns3/wifi-tx-vector.h"
 #include "ns3/ssid.h"
 #include "ns3/qos-utils.h"
+#include "stdma-header.h"
+
+#include <map>
 
 namespace stdma {
 
@@ -109,6 +115,24 @@ namespace stdma {
     void
     SetGuardInterval (const ns3::Time gi);
 
+    ns3::WifiMode
+    GetWifiMode (void) const;
+
+    void
+    SetWifiMode (ns3::WifiMode mode);
+
+    ns3::WifiPreamble
+    GetWifiPreamble (void) const;
+
+    void
+    SetWifiPreamble (ns3::WifiPreamble preamble);
+
+    uint32_t
+    GetMaximumPacketSize (void) const;
+
+    void
+    SetMaximumPacketSize (uint32_t size);
+
     void
     SetSelectionIntervalRatio (double ratio);
 
@@ -118,6 +142,38 @@ namespace stdma {
     void
     SetMinimumCandidateSetSize (uint32_t size);
 
+    /**
+     * Sets the number of transmissions per frame. Before the station has entered the network the rate is applied
+     * right away, afterwards the change is deferred to the next transmission after the first frame, at which the
+     * slot manager adds or releases reservations incrementally (see StdmaSlotManager::ChangeReportRate).
+     *
+     * \param rate The desired number of transmissions per frame
+     */
+    void
+    SetReportRate (uint8_t rate);
+
+    /**
+     * \return The number of transmissions per frame, including a change that has not been applied yet
+     */
+    uint8_t
+    GetReportRate (void) const;
+
+    /**
+     * Sets a callback that adapts the report rate to the channel load, e.g. for congestion control. Once per frame
+     * the callback is invoked with the fraction of slots that are currently not free, and the rate it returns is
+     * applied as if passed to SetReportRate. A return value of zero keeps the current rate.
+     *
+     * \param callback The callback that maps the channel load onto the desired report rate
+     */
+    void
+    SetReportRateCallback (ns3::Callback<uint8_t, double> callback);
+
+    /**
+     * \return The slot manager of this station, e.g. to pull its frame statistics
+     */
+    ns3::Ptr<StdmaSlotManager>
+    GetSlotManager (void) const;
+
     void
     SetAddress (ns3::Mac48Address address);
 
@@ -165,6 +221,41 @@ namespace stdma {
     void
     StartInitializationPhase ();
 
+    /**
+     * \return Whether the station has performed its network entry, i.e. whether it has a transmission schedule
+     */
+    bool
+    HasEnteredNetwork (void) const;
+
+    /**
+     * Writes the phase of the station (report rate, transmission schedule, time of the next transmission, position
+     * keys) and the state of its slot manager to a snapshot. The station must have entered the network already.
+     *
+     * \param writer The snapshot writer
+     */
+    void
+    SaveState (StdmaSnapshotWriter &writer);
+
+    /**
+     * Starts up the STDMA logic like StartInitializationPhase, but instead of listening for a frame and entering the
+     * network the station continues from the state written by SaveState, with the time stamps of the snapshot
+     * re-based to the current simulation time. It is scheduled by StdmaHelper::Install if a warm start has been
+     * configured.
+     *
+     * \param state The snapshot of this station
+     */
+    void
+    RestoreState (std::string state);
+
+    /**
+     * Sets the mobility model from which the position of this station is taken. If no mobility model is set,
+     * the one aggregated to the node is looked up once when the initialization phase starts.
+     *
+     * \param mobility The mobility model of the node this MAC layer belongs to
+     */
+    void
+    SetMobility (ns3::Ptr<ns3::MobilityModel> mobility);
+
     /**
      * Will always return false in the current implementation as the feature is not supported.
      */
@@ -213,6 +304,22 @@ namespace stdma {
     void
     Receive (ns3::Ptr<ns3::Packet> packet, double rxSnr, ns3::WifiMode txMode, ns3::WifiPreamble preamble);
 
+    /**
+     * This method is called by the physical layer right before it passes a successfully received packet to
+     * StdmaMac::Receive, and records the power at which the packet has been received.
+     *
+     * \param packet	The packet which was successfully received by the physical layer
+     * \param channelFreqMhz	The frequency of the channel in MHz
+     * \param channelNumber	The number of the channel
+     * \param rate	The data rate of the packet in units of 500 kbps
+     * \param isShortPreamble	Whether the packet has been sent with a short preamble
+     * \param signalDbm	The received signal power in dBm
+     * \param noiseDbm	The noise power in dBm
+     */
+    void
+    SniffRx (ns3::Ptr<const ns3::Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber, uint32_t rate,
+             bool isShortPreamble, double signalDbm, double noiseDbm);
+
     /**
      * This method is called whenever the reception process at physical layer is started. It does not pass the packet
      * yet, but informs the medium access control layer about the current state of the physical layer and the
@@ -266,7 +373,7 @@ namespace stdma {
     ForwardUp (ns3::Ptr<ns3::Packet> packet, ns3::Mac48Address from, ns3::Mac48Address to);
 
     ns3::Ptr<ns3::WifiPhy> m_phy;
-    ns3::Ptr<ns3::WifiMacQueue> m_queue;
+    ns3::Ptr<StdmaMacQueue> m_queue;
 
     ns3::Callback<void, ns3::Ptr<ns3::Packet>, ns3::Mac48Address, ns3::Mac48Address> m_forwardUp;
     ns3::Callback<void> m_linkUp;
@@ -285,6 +392,74 @@ namespace stdma {
     ns3::Time
     GetSlotDuration();
 
+    /**
+     * Computes the slot duration (unless the frame structure is already set up), the transmission vector, and
+     * resets the table of transmission durations per packet size. Called when the initialization phase starts,
+     * and again whenever one of the attributes these values depend on has changed.
+     */
+    void
+    UpdateSlotTiming();
+
+    /**
+     * @return A timeout for a new reservation drawn from the Timeout attribute, which has to be within the
+     * range the header can transmit
+     */
+    uint8_t
+    DrawTimeout();
+
+    /**
+     * Returns the transmission duration of a packet with the given size, computed only once per size.
+     *
+     * \param bytes The size of the packet including all headers and trailers, at most the maximum packet size
+     * \return The transmission duration of the packet
+     */
+    ns3::Time
+    GetTxDuration(uint32_t bytes);
+
+    /**
+     * Fills the position of a STDMA header that is about to be transmitted. If PositionKeyInterval is enabled,
+     * the position is announced under a new key every PositionKeyInterval reports (or whenever the distance
+     * to the key position becomes too large), and DELTA coded relative to the key position otherwise.
+     *
+     * \param hdr The header to fill
+     * \param position The current position of this station
+     */
+    void
+    EncodePosition(StdmaHeader &hdr, ns3::Vector position);
+
+    /**
+     * Dequeues the payload of the frame that is transmitted in the current slot. Unless aggregation is enabled,
+     * this is the packet at the head of the queue. Otherwise, as many queued packets as fit into the slot are
+     * dequeued and concatenated, each one preceded by a StdmaSubframeHeader, and the STDMA header is flagged
+     * accordingly. If the queue is empty, the payload is empty as well, i.e. the frame is a keep-alive that only
+     * announces the reservation.
+     *
+     * \param stdmaHdr The STDMA header of the frame, with its position already encoded
+     * \param wifiMacHdr Receives the MAC header of the (first) packet, or a broadcast data header for a keep-alive
+     * \return The payload of the frame
+     */
+    ns3::Ptr<ns3::Packet>
+    DequeueSlotPayload(StdmaHeader &stdmaHdr, ns3::WifiMacHeader &wifiMacHdr);
+
+    /**
+     * Returns the position announced in a received STDMA header. DELTA coded positions are resolved by means of
+     * the key position last announced by the sender. If the key position is unknown, the last key position of the
+     * sender is used instead, or if no key position is known at all, our own position.
+     *
+     * \param hdr The received header
+     * \param from The sender of the header
+     * \return The position of the sender
+     */
+    ns3::Vector
+    DecodePosition(StdmaHeader &hdr, ns3::Mac48Address from);
+
+    /**
+     * Sets up the slot manager and the slot timing when the station is powered on, before it either starts the
+     * initialization phase or restores a snapshot.
+     */
+    void
+    StartUp ();
+
     /**
      * This method is scheduled exactly one super frame after the initialization phase has been started.
      * The medium access control layer then has listened to the channel for a one frame and has a full
@@ -311,24 +486,86 @@ namespace stdma {
     void
     DoTransmit(bool firstFrame);
 
+    /**
+     * Schedules the next call of StdmaMac::PerformNetworkEntry, either as a simulator event of its own or through
+     * the slot clock, depending on the SlotClock attribute.
+     */
+    void
+    ScheduleNetworkEntry(ns3::Time delay, uint32_t remainingSlots, double p);
+
+    /**
+     * Schedules the next call of StdmaMac::DoTransmit, either as a simulator event of its own or through the
+     * slot clock, depending on the SlotClock attribute.
+     */
+    void
+    ScheduleTransmission(ns3::Time delay, bool firstFrame);
+
+    /**
+     * Hands the single event of the slot clock to the simulator again. At most one tick is pending at any time,
+     * and the action to perform on the tick is kept in the m_clock* members.
+     */
+    void
+    ScheduleSlotClock(ns3::Time delay);
+
+    /**
+     * Performs the action the slot clock has been scheduled for.
+     */
+    void
+    SlotClockTick();
+
     double m_selectionIntervalRatio;
     uint32_t m_minimumCandidateSetSize;
     ns3::Time m_guardInterval;
     ns3::WifiPreamble m_wifiPreamble;
     ns3::WifiMode m_wifiMode;
     uint8_t m_reportRate;
+    uint8_t m_pendingReportRate;                // Report rate to apply at the next transmission, zero if none
+    uint32_t m_reportsSinceRateCheck;           // Number of transmissions since the rate callback was invoked
+    ns3::Callback<uint8_t, double> m_reportRateCallback;
     ns3::Time m_frameDuration;
     uint32_t m_maxPacketSize;
     ns3::RandomVariable m_timeoutRng;
     uint16_t m_slotsForRtdma;
+    uint32_t m_positionKeyInterval;
+    bool m_aggregation;
+
+    struct PositionKey
+    {
+      uint8_t key;
+      ns3::Vector position;
+    };
+    uint32_t m_reportsSinceKey;                 // Number of reports since the own position has been announced as key
+    PositionKey m_ownKey;
+    std::map<ns3::Mac48Address, PositionKey> m_keys;  // Key position last announced by each neighbor
 
     StdmaMacPhyListener *m_phyListener;
     ns3::Ptr<StdmaSlotManager> m_manager;
+    ns3::Ptr<ns3::MobilityModel> m_mobility;
+    ns3::Ptr<StdmaSlotClock> m_channelClock;    // Slot clock shared by all stations on the channel
+
+    ns3::Time m_slotDuration;                   // Duration of a slot, integral number of nanoseconds
+    ns3::WifiTxVector m_txVector;
+    std::vector<ns3::Time> m_txDurations;       // Transmission duration per packet size, zero if not computed yet
+    bool m_timingValid;
+
+    enum SlotClockAction
+    {
+      CLOCK_NETWORK_ENTRY,
+      CLOCK_TRANSMIT
+    };
+    bool m_slotClock;
+    ns3::Ptr<ns3::EventImpl> m_slotClockEvent;
+    SlotClockAction m_clockAction;
+    bool m_clockFirstFrame;                     // Argument of the pending DoTransmit, also kept without slot clock
+    uint32_t m_clockRemainingSlots;
+    double m_clockProbability;
+    double m_rxPowerDbm;                        // Power of the packet currently being received, NaN if unknown
+    std::vector<uint32_t> m_schedule;           // Slot index of each reservation within the frame
     ns3::EventId m_endInitializationPhaseEvent;
     ns3::EventId m_nextTransmissionEvent;
 
     bool m_rxOngoing;
-    ns3::Time m_rxStart;
+    uint64_t m_rxStartSlot;                     // Global slot index at the start of the ongoing reception
     bool m_startedUp;
 
     ns3::TracedCallback<ns3::Time, ns3::Time, ns3::Time> m_startupTrace;
@@ -337,6 +574,7 @@ namespace stdma {
     ns3::TracedCallback<ns3::Ptr<const ns3::Packet>, uint8_t, uint32_t> m_rxTrace;
     ns3::TracedCallback<ns3::Ptr<const ns3::Packet>> m_enqueueTrace;
     ns3::TracedCallback<ns3::Ptr<const ns3::Packet>> m_enqueueFailTrace;
+    ns3::TracedCallback<uint8_t, uint8_t> m_reportRateChangeTrace;
 
   };
 
@@ -0,0 +1,552 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-slot-channel.h"
+#include "stdma-slot-phy.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/integer.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/nstime.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("StdmaSlotChannel");
+
+namespace stdma {
+
+  NS_OBJECT_ENSURE_REGISTERED (StdmaSlotChannel);
+
+  // Leaves room for the metadata that MpiInterface::SendPacket adds to each message
+  static const uint32_t MAX_MESSAGE_SIZE = ns3::MAX_MPI_MSG_SIZE - 128;
+
+  static inline double
+  DbmToW (double dbm)
+  {
+    return std::pow(10.0, dbm / 10.0) / 1000.0;
+  }
+
+  ns3::TypeId
+  StdmaSlotChannel::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaSlotChannel")
+            .SetParent<ns3::WifiChannel>()
+            .AddConstructor<StdmaSlotChannel>()
+            .AddAttribute ("PropagationLossModel",
+                           "A pointer to the propagation loss model used for all transmissions.",
+                           ns3::PointerValue (),
+                           ns3::MakePointerAccessor (&StdmaSlotChannel::m_loss),
+                           ns3::MakePointerChecker<ns3::PropagationLossModel> ())
+            .AddAttribute ("MinimumSnr",
+                           "The lowest SNR (in dB) of the packet error rate lookup tables, lower SNRs use this value.",
+                           ns3::DoubleValue (-5.0),
+                           ns3::MakeDoubleAccessor (&StdmaSlotChannel::SetMinimumSnr, &StdmaSlotChannel::GetMinimumSnr),
+                           ns3::MakeDoubleChecker<double> ())
+            .AddAttribute ("SnrStep",
+                           "The SNR distance (in dB) between two entries of the packet error rate lookup tables.",
+                           ns3::DoubleValue (0.25),
+                           ns3::MakeDoubleAccessor (&StdmaSlotChannel::SetSnrStep, &StdmaSlotChannel::GetSnrStep),
+                           ns3::MakeDoubleChecker<double> (0.001))
+            .AddAttribute ("SnrEntries",
+                           "The number of entries of the packet error rate lookup tables, higher SNRs use the last entry.",
+                           ns3::UintegerValue (201),
+                           ns3::MakeUintegerAccessor (&StdmaSlotChannel::SetSnrEntries, &StdmaSlotChannel::GetSnrEntries),
+                           ns3::MakeUintegerChecker<uint32_t> (2))
+            .AddAttribute ("Lookahead",
+                           "The delay after the start of a transmission at which it is delivered to the other systems of the "
+                           "distributed simulator, the slot is resolved just after it. Zero resolves a slot when its last "
+                           "transmission ends, which is only possible within a single system.",
+                           ns3::TimeValue (ns3::Seconds (0)),
+                           ns3::MakeTimeAccessor (&StdmaSlotChannel::m_lookahead),
+                           ns3::MakeTimeChecker ())
+            .AddAttribute ("BoundaryWidth",
+                           "The distance (in meters) to the segment of another system within which transmissions are forwarded to it.",
+                           ns3::DoubleValue (1000.0),
+                           ns3::MakeDoubleAccessor (&StdmaSlotChannel::m_boundaryWidth),
+                           ns3::MakeDoubleChecker<double> (0));
+    return tid;
+  }
+
+  StdmaSlotChannel::StdmaSlotChannel ()
+    : m_resolveAt(ns3::Seconds(0)),
+      m_lookahead(ns3::Seconds(0)),
+      m_boundaryWidth(1000.0),
+      m_tableMinDb(-5.0),
+      m_tableStepDb(0.25),
+      m_tableSize(201)
+  {
+    // The random variable is created by AssignStreams or on first use, such that creating the channel does
+    // not shift the automatically assigned streams of the random variables of the stations
+  }
+
+  StdmaSlotChannel::~StdmaSlotChannel ()
+  {
+  }
+
+  void
+  StdmaSlotChannel::DoDispose (void)
+  {
+    m_resolveEvent.Cancel();
+    m_sendEvent.Cancel();
+    m_transmissions.clear();
+    m_outgoing.clear();
+    m_phys.clear();
+    m_mobility.clear();
+    m_perTables.clear();
+    m_loss = 0;
+    ns3::WifiChannel::DoDispose();
+  }
+
+  uint32_t
+  StdmaSlotChannel::GetNDevices (void) const
+  {
+    return m_phys.size();
+  }
+
+  ns3::Ptr<ns3::NetDevice>
+  StdmaSlotChannel::GetDevice (uint32_t i) const
+  {
+    return m_phys[i]->GetDevice()->GetObject<ns3::NetDevice>();
+  }
+
+  uint32_t
+  StdmaSlotChannel::Add (ns3::Ptr<StdmaSlotPhy> phy)
+  {
+    m_phys.push_back(phy);
+    m_mobility.push_back(0);
+    m_nodes.push_back(0);
+    m_local.push_back(true);
+    if (ns3::MpiInterface::IsEnabled())
+      {
+        // Messages from other systems are received through any device attached to this channel
+        ns3::Ptr<ns3::Node> node = phy->GetMobility()->GetObject<ns3::Node>();
+        NS_ASSERT_MSG(node != 0, "StdmaSlotChannel:Add() requires the phy to be installed on a node");
+        m_local.back() = node->GetSystemId() == ns3::MpiInterface::GetSystemId();
+        ns3::Ptr<ns3::MpiReceiver> receiver = ns3::CreateObject<ns3::MpiReceiver>();
+        receiver->SetReceiveCallback(ns3::MakeCallback(&StdmaSlotChannel::ReceiveRemote, this));
+        phy->GetDevice()->AggregateObject(receiver);
+      }
+    return m_phys.size() - 1;
+  }
+
+  void
+  StdmaSlotChannel::SetPropagationLossModel (ns3::Ptr<ns3::PropagationLossModel> loss)
+  {
+    m_loss = loss;
+  }
+
+  void
+  StdmaSlotChannel::SetPartition (std::vector<double> bounds)
+  {
+    NS_ASSERT_MSG(bounds.size() >= 2 && std::is_sorted(bounds.begin(), bounds.end()), "StdmaSlotChannel:SetPartition() requires at least two borders in increasing order");
+    m_bounds = bounds;
+  }
+
+  uint32_t
+  StdmaSlotChannel::GetSegment (const std::vector<double> &bounds, double x)
+  {
+    NS_ASSERT(bounds.size() >= 2);
+    uint32_t segment = std::upper_bound(bounds.begin(), bounds.end(), x) - bounds.begin();
+    return std::min(std::max(segment, 1u), (uint32_t) bounds.size() - 1) - 1;
+  }
+
+  int64_t
+  StdmaSlotChannel::AssignStreams (int64_t stream)
+  {
+    if (m_random == 0)
+      {
+        m_random = ns3::CreateObjectWithAttributes<ns3::UniformRandomVariable>("Stream", ns3::IntegerValue(stream));
+      }
+    else
+      {
+        m_random->SetStream(stream);
+      }
+    return 1;
+  }
+
+  ns3::Ptr<ns3::MobilityModel>
+  StdmaSlotChannel::GetMobility (uint32_t index)
+  {
+    if (m_mobility[index] == 0)
+      {
+        // The mobility model is usually aggregated to the node after the devices have been installed
+        m_mobility[index] = m_phys[index]->GetMobility()->GetObject<ns3::MobilityModel>();
+        m_nodes[index] = m_phys[index]->GetDevice()->GetObject<ns3::NetDevice>()->GetNode()->GetId();
+        NS_ASSERT_MSG(m_mobility[index] != 0, "StdmaSlotChannel:GetMobility() requires a mobility model aggregated to the node");
+      }
+    return m_mobility[index];
+  }
+
+  void
+  StdmaSlotChannel::Send (ns3::Ptr<StdmaSlotPhy> sender, ns3::Ptr<const ns3::Packet> packet, double txPowerDbm,
+                          ns3::WifiMode mode, ns3::WifiPreamble preamble, ns3::Time duration)
+  {
+    NS_LOG_FUNCTION(this << sender << packet << txPowerDbm << mode << duration);
+    uint32_t index = sender->GetSlotChannelIndex();
+    NS_ASSERT_MSG(index < m_phys.size() && m_phys[index] == sender, "StdmaSlotChannel:Send() the sender is not attached to this channel");
+
+    Transmission tx;
+    tx.sender = index;
+    tx.mobility = GetMobility(index);
+    tx.packet = packet;
+    tx.txPowerDbm = txPowerDbm;
+    tx.mode = mode;
+    tx.preamble = preamble;
+    tx.duration = duration;
+    m_transmissions.push_back(tx);
+
+    // All transmissions that overlap in time belong to the same slot, which is resolved once the last one
+    // of them has ended. With a lookahead, it is resolved just after the transmissions of the other systems
+    // have arrived.
+    if (m_lookahead.IsZero())
+      {
+        ScheduleResolve(duration);
+        return;
+      }
+    NS_ASSERT_MSG(duration <= m_lookahead, "StdmaSlotChannel:Send() the lookahead must not be shorter than a transmission");
+    ScheduleResolve(m_lookahead + ns3::NanoSeconds(1));
+    if (ns3::MpiInterface::IsEnabled() && ns3::MpiInterface::GetSize() > 1)
+      {
+        Forward(tx);
+      }
+  }
+
+  void
+  StdmaSlotChannel::ScheduleResolve (ns3::Time delay)
+  {
+    ns3::Time end = ns3::Simulator::Now() + delay;
+    if (!m_resolveEvent.IsRunning() || end > m_resolveAt)
+      {
+        m_resolveEvent.Cancel();
+        m_resolveAt = end;
+        m_resolveEvent = ns3::Simulator::Schedule(delay, &StdmaSlotChannel::ResolveSlot, this);
+      }
+  }
+
+  void
+  StdmaSlotChannel::Forward (const Transmission &tx)
+  {
+    uint32_t systems = ns3::MpiInterface::GetSize();
+    uint32_t self = ns3::MpiInterface::GetSystemId();
+    if (m_bounds.size() != systems + 1)
+      {
+        NS_FATAL_ERROR("StdmaSlotChannel:Forward() requires a partition with one segment per system");
+      }
+    if (m_gateways.empty())
+      {
+        // Messages for a system are addressed to the device of its first node on this channel
+        m_gateways.assign(systems, std::make_pair(0xffffffff, 0));
+        for (uint32_t i = 0; i < m_phys.size(); i++)
+          {
+            ns3::Ptr<ns3::NetDevice> device = m_phys[i]->GetDevice()->GetObject<ns3::NetDevice>();
+            uint32_t system = device->GetNode()->GetSystemId();
+            if (system < systems && m_gateways[system].first == 0xffffffff)
+              {
+                m_gateways[system] = std::make_pair(device->GetNode()->GetId(), device->GetIfIndex());
+              }
+          }
+        m_outgoing.assign(systems, StdmaSnapshotWriter(ns3::Seconds(0)));
+      }
+
+    // The record is built once and appended to the messages of all systems that need it
+    ns3::Vector position = tx.mobility->GetPosition();
+    std::string data = EncodeTransmission(tx);
+    NS_ASSERT_MSG(data.size() <= MAX_MESSAGE_SIZE, "StdmaSlotChannel:Forward() the transmission is too large for a MPI message");
+
+    for (uint32_t system = 0; system < systems; system++)
+      {
+        if (system == self || m_gateways[system].first == 0xffffffff
+            || position.x < m_bounds[system] - m_boundaryWidth || position.x > m_bounds[system + 1] + m_boundaryWidth)
+          {
+            continue;
+          }
+        if (m_outgoing[system].GetData().size() + data.size() > MAX_MESSAGE_SIZE)
+          {
+            SendRemote();
+          }
+        for (uint32_t k = 0; k < data.size(); k++)
+          {
+            m_outgoing[system].WriteU8(data[k]);
+          }
+      }
+    // All transmissions that start at the same time are sent in one message per system, after the last of them
+    if (!m_sendEvent.IsRunning())
+      {
+        m_sendEvent = ns3::Simulator::Schedule(ns3::Seconds(0), &StdmaSlotChannel::SendRemote, this);
+      }
+  }
+
+  void
+  StdmaSlotChannel::SendRemote (void)
+  {
+    NS_LOG_FUNCTION(this);
+    for (uint32_t system = 0; system < m_outgoing.size(); system++)
+      {
+        const std::string &data = m_outgoing[system].GetData();
+        if (data.empty())
+          {
+            continue;
+          }
+        ns3::Ptr<ns3::Packet> message = ns3::Create<ns3::Packet>(reinterpret_cast<const uint8_t *> (data.data()), data.size());
+        ns3::MpiInterface::SendPacket(message, ns3::Simulator::Now() + m_lookahead, m_gateways[system].first, m_gateways[system].second);
+        m_outgoing[system] = StdmaSnapshotWriter(ns3::Seconds(0));
+      }
+  }
+
+  void
+  StdmaSlotChannel::ReceiveRemote (ns3::Ptr<ns3::Packet> message)
+  {
+    NS_LOG_FUNCTION(this << message);
+    std::string data(message->GetSize(), 0);
+    message->CopyData(reinterpret_cast<uint8_t *> (&data[0]), data.size());
+    DecodeTransmissions(data);
+    ScheduleResolve(ns3::NanoSeconds(1));
+  }
+
+  std::string
+  StdmaSlotChannel::EncodeTransmission (const Transmission &tx)
+  {
+    StdmaSnapshotWriter record(ns3::Seconds(0));
+    record.WriteU32(tx.sender);
+    record.WriteVector(tx.mobility->GetPosition());
+    record.WriteDouble(tx.txPowerDbm);
+    std::string mode = tx.mode.GetUniqueName();
+    record.WriteU8(mode.size());
+    for (uint32_t k = 0; k < mode.size(); k++)
+      {
+        record.WriteU8(mode[k]);
+      }
+    record.WriteU8(tx.preamble);
+    record.WriteTime(tx.duration);
+    record.WriteU32(tx.packet->GetSize());
+    uint32_t header = record.GetData().size();
+    std::string data = record.GetData();
+    data.resize(header + tx.packet->GetSize());
+    tx.packet->CopyData(reinterpret_cast<uint8_t *> (&data[header]), tx.packet->GetSize());
+    return data;
+  }
+
+  void
+  StdmaSlotChannel::DecodeTransmissions (const std::string &data)
+  {
+    StdmaSnapshotReader reader(data, ns3::Seconds(0));
+    while (!reader.IsAtEnd())
+      {
+        Transmission tx;
+        tx.sender = reader.ReadU32();
+        NS_ASSERT_MSG(tx.sender < m_phys.size(), "StdmaSlotChannel:DecodeTransmissions() the devices have to be installed on all systems in the same order");
+        ns3::Ptr<ns3::ConstantPositionMobilityModel> mobility = ns3::CreateObject<ns3::ConstantPositionMobilityModel>();
+        mobility->SetPosition(reader.ReadVector());
+        tx.mobility = mobility;
+        tx.txPowerDbm = reader.ReadDouble();
+        std::string mode(reader.ReadU8(), 0);
+        for (uint32_t k = 0; k < mode.size(); k++)
+          {
+            mode[k] = reader.ReadU8();
+          }
+        tx.mode = ns3::WifiMode(mode);
+        tx.preamble = (ns3::WifiPreamble) reader.ReadU8();
+        tx.duration = reader.ReadTime();
+        std::vector<uint8_t> buffer(reader.ReadU32());
+        for (uint32_t k = 0; k < buffer.size(); k++)
+          {
+            buffer[k] = reader.ReadU8();
+          }
+        tx.packet = ns3::Create<ns3::Packet>(buffer.empty() ? 0 : &buffer[0], buffer.size());
+        m_transmissions.push_back(tx);
+      }
+  }
+
+  void
+  StdmaSlotChannel::ResolveSlot (void)
+  {
+    static const double BOLTZMANN = 1.3803e-23;
+    NS_LOG_FUNCTION(this << m_transmissions.size());
+    NS_ASSERT_MSG(m_loss != 0, "StdmaSlotChannel:ResolveSlot() requires a propagation loss model");
+
+    uint32_t numTx = m_transmissions.size();
+    uint32_t numPhys = m_phys.size();
+    m_transmitting.assign(numPhys, false);
+    for (uint32_t t = 0; t < numTx; t++)
+      {
+        m_transmitting[m_transmissions[t].sender] = true;
+      }
+
+    // Compute the received power of every transmission at every receiver exactly once
+    m_rxPowerW.assign(numTx * numPhys, 0.0);
+    for (uint32_t t = 0; t < numTx; t++)
+      {
+        ns3::Ptr<ns3::MobilityModel> senderMobility = m_transmissions[t].mobility;
+        for (uint32_t r = 0; r < numPhys; r++)
+          {
+            if (m_transmitting[r] || !m_local[r])
+              {
+                continue;
+              }
+            double rxPowerDbm = m_loss->CalcRxPower(m_transmissions[t].txPowerDbm, senderMobility, GetMobility(r))
+                + m_phys[r]->GetRxGain();
+            m_rxPowerW[t * numPhys + r] = DbmToW(rxPowerDbm);
+          }
+      }
+
+    for (uint32_t r = 0; r < numPhys; r++)
+      {
+        // A station cannot receive while it is transmitting itself, the stations of other systems are
+        // resolved there
+        if (m_transmitting[r] || !m_local[r])
+          {
+            continue;
+          }
+        double total = 0;
+        double strongest = 0;
+        uint32_t best = 0;
+        for (uint32_t t = 0; t < numTx; t++)
+          {
+            double power = m_rxPowerW[t * numPhys + r];
+            total += power;
+            if (power > strongest)
+              {
+                strongest = power;
+                best = t;
+              }
+          }
+        ns3::Ptr<StdmaSlotPhy> receiver = m_phys[r];
+        bool detected = strongest > DbmToW(receiver->GetEdThreshold());
+        if (!detected && total < DbmToW(receiver->GetCcaMode1Threshold()))
+          {
+            continue;
+          }
+
+        // The receiver synchronizes to the strongest transmission, all others are interference. If the strongest
+        // transmission is below the energy detection threshold, the slot is only sensed as busy.
+        const Transmission &tx = m_transmissions[best];
+        double noise = BOLTZMANN * 290.0 * tx.mode.GetBandwidth() * std::pow(10.0, receiver->GetRxNoiseFigure() / 10.0);
+        double snr = strongest / (noise + total - strongest);
+        bool success = false;
+        if (detected)
+          {
+            double per = GetPacketErrorRate(receiver, tx.mode, tx.packet->GetSize() * 8, snr);
+            if (m_random == 0)
+              {
+                m_random = ns3::CreateObject<ns3::UniformRandomVariable>();
+              }
+            success = m_random->GetValue() >= per;
+          }
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotChannel:ResolveSlot() receiver " << r << " sender " << tx.sender
+            << " snr = " << snr << " success = " << success);
+        // The node expects its receptions to be processed within its own context
+        if (success)
+          {
+            ns3::Simulator::ScheduleWithContext(m_nodes[r], ns3::Seconds(0), &StdmaSlotPhy::ReceiveOk, receiver,
+                                                tx.packet->Copy(), snr, 10.0 * std::log10(strongest) + 30.0, tx.mode, tx.preamble);
+          }
+        else
+          {
+            ns3::Simulator::ScheduleWithContext(m_nodes[r], ns3::Seconds(0), &StdmaSlotPhy::ReceiveError, receiver,
+                                                tx.packet->Copy(), snr, tx.duration);
+          }
+      }
+    m_transmissions.clear();
+  }
+
+  void
+  StdmaSlotChannel::SetMinimumSnr (double snr)
+  {
+    m_tableMinDb = snr;
+    m_perTables.clear();
+  }
+
+  double
+  StdmaSlotChannel::GetMinimumSnr (void) const
+  {
+    return m_tableMinDb;
+  }
+
+  void
+  StdmaSlotChannel::SetSnrStep (double step)
+  {
+    m_tableStepDb = step;
+    m_perTables.clear();
+  }
+
+  double
+  StdmaSlotChannel::GetSnrStep (void) const
+  {
+    return m_tableStepDb;
+  }
+
+  void
+  StdmaSlotChannel::SetSnrEntries (uint32_t entries)
+  {
+    m_tableSize = entries;
+    m_perTables.clear();
+  }
+
+  uint32_t
+  StdmaSlotChannel::GetSnrEntries (void) const
+  {
+    return m_tableSize;
+  }
+
+  double
+  StdmaSlotChannel::GetPacketErrorRate (ns3::Ptr<StdmaSlotPhy> receiver, ns3::WifiMode mode, uint32_t bits, double snr)
+  {
+    // The key holds a reference to the model, such that its address cannot be reused by another model
+    ns3::Ptr<ns3::ErrorRateModel> model = receiver->GetErrorRateModel();
+    PerTableKey key = std::make_pair(model, std::make_pair(mode.GetUid(), bits));
+    std::map<PerTableKey, std::vector<double> >::iterator it = m_perTables.find(key);
+    if (it == m_perTables.end())
+      {
+        std::vector<double> table(m_tableSize);
+        for (uint32_t i = 0; i < m_tableSize; i++)
+          {
+            double snrDb = m_tableMinDb + i * m_tableStepDb;
+            table[i] = 1.0 - model->GetChunkSuccessRate(mode, std::pow(10.0, snrDb / 10.0), bits);
+          }
+        it = m_perTables.insert(std::make_pair(key, table)).first;
+      }
+    const std::vector<double> &table = it->second;
+
+    // Linear interpolation between the two neighboring entries of the table
+    double position = (10.0 * std::log10(snr) - m_tableMinDb) / m_tableStepDb;
+    if (position <= 0)
+      {
+        return table.front();
+      }
+    if (position >= m_tableSize - 1)
+      {
+        return table.back();
+      }
+    uint32_t lower = (uint32_t) position;
+    double fraction = position - lower;
+    return table[lower] + fraction * (table[lower + 1] - table[lower]);
+  }
+
+} // namespace stdma
@@ -0,0 +1,256 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SLOT_CHANNEL_H_
+#define STDMA_SLOT_CHANNEL_H_
+
+#include "ns3/wifi-channel.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/error-rate-model.h"
+#include "stdma-snapshot.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stdma {
+
+  class StdmaSlotPhy;
+
+  /**
+   * \brief Abstract slot-level channel for STDMA stations
+   *
+   * Since STDMA transmissions are aligned to slots, the outcome of all transmissions within a slot can be
+   * resolved at once. The channel collects the transmissions that overlap in time (i.e. that share a slot)
+   * and resolves them in a single event once the last of them has ended: for every receiver the received power
+   * of every transmitter is computed once with the configured propagation loss model, the receiver synchronizes
+   * to the strongest transmission above its energy detection threshold, and the packet is delivered or dropped
+   * according to the packet error rate of its SINR. The packet error rates are taken from lookup tables that
+   * are built from the error rate model of the receiving phy, per error rate model, mode and packet size. The outcome is handed
+   * to each receiver in an event within the context of its node.
+   *
+   * In contrast to the YansWifiChannel, neither two events per receiver and packet nor the chunk-wise
+   * interference integration of the InterferenceHelper is needed, at the price of ignoring propagation delays
+   * and partial overlaps of transmissions. Only StdmaSlotPhy instances can be attached to this channel.
+   *
+   * The channel can span several systems of the MPI based distributed simulator. The road is then partitioned
+   * into segments along the x axis, one per system (see SetPartition), and the nodes of a segment are created
+   * with the system id of that segment. The devices are installed on all nodes of all systems in the same
+   * order, but each system only runs the stations of its own nodes and only resolves receptions for them.
+   * Transmissions of senders that are within the boundary width of another segment are forwarded to the system
+   * of that segment, batched into one message per system and point in time. Since they arrive a lookahead after
+   * the start of the transmission, all slots are resolved just after the lookahead in this case, even within a
+   * single system. The lookahead has to be at least the longest transmission duration and should be shorter
+   * than the slot duration, such that the outcome of a slot is known before the next slot starts.
+   */
+  class StdmaSlotChannel : public ns3::WifiChannel
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaSlotChannel ();
+    virtual ~StdmaSlotChannel ();
+
+    virtual uint32_t GetNDevices (void) const;
+    virtual ns3::Ptr<ns3::NetDevice> GetDevice (uint32_t i) const;
+
+    /**
+     * Attaches a phy to the channel
+     *
+     * @param phy The phy
+     * @return The index of the phy on this channel
+     */
+    uint32_t Add (ns3::Ptr<StdmaSlotPhy> phy);
+
+    /**
+     * @param loss The propagation loss model used to compute the received power of all transmissions
+     */
+    void SetPropagationLossModel (ns3::Ptr<ns3::PropagationLossModel> loss);
+
+    /**
+     * Partitions the road into one segment per system of the distributed simulator
+     *
+     * @param bounds The x coordinates of the segment borders in increasing order, the segment of system k
+     * extends from bounds[k] to bounds[k + 1]
+     */
+    void SetPartition (std::vector<double> bounds);
+
+    /**
+     * The setters of the packet error rate lookup tables discard all tables built so far
+     *
+     * @param snr The lowest SNR (in dB) of the tables
+     */
+    void SetMinimumSnr (double snr);
+    double GetMinimumSnr (void) const;
+    /**
+     * @param step The SNR distance (in dB) between two entries of the tables
+     */
+    void SetSnrStep (double step);
+    double GetSnrStep (void) const;
+    /**
+     * @param entries The number of entries of the tables
+     */
+    void SetSnrEntries (uint32_t entries);
+    uint32_t GetSnrEntries (void) const;
+
+    /**
+     * @param bounds The x coordinates of the segment borders, as passed to SetPartition
+     * @param x The x coordinate of a position
+     * @return The segment, i.e. the system id, to which the position belongs. Positions before the first
+     * or after the last border belong to the first or last segment.
+     */
+    static uint32_t GetSegment (const std::vector<double> &bounds, double x);
+
+    /**
+     * Adds a transmission to the slot that is currently collected. Called by StdmaSlotPhy::SendPacket.
+     *
+     * @param sender The transmitting phy
+     * @param packet The packet
+     * @param txPowerDbm The transmission power including the antenna gain of the sender
+     * @param mode The transmission mode
+     * @param preamble The preamble
+     * @param duration The duration of the transmission
+     */
+    void Send (ns3::Ptr<StdmaSlotPhy> sender, ns3::Ptr<const ns3::Packet> packet, double txPowerDbm,
+               ns3::WifiMode mode, ns3::WifiPreamble preamble, ns3::Time duration);
+
+    /**
+     * Assigns a fixed random variable stream number to the random variables used by this channel
+     *
+     * @param stream The first stream index to use
+     * @return The number of stream indices assigned
+     */
+    int64_t AssignStreams (int64_t stream);
+
+  private:
+    virtual void DoDispose (void);
+
+    struct Transmission
+    {
+      uint32_t sender;
+      ns3::Ptr<ns3::MobilityModel> mobility;
+      ns3::Ptr<const ns3::Packet> packet;
+      double txPowerDbm;
+      ns3::WifiMode mode;
+      ns3::WifiPreamble preamble;
+      ns3::Time duration;
+    };
+
+    /**
+     * Resolves all transmissions of the slot that has been collected and delivers the outcome to the receivers
+     */
+    void ResolveSlot (void);
+
+    /**
+     * Returns the packet error rate of a packet by means of the lookup table for its mode and size
+     *
+     * @param receiver The phy whose error rate model is used
+     * @param mode The transmission mode
+     * @param bits The size of the packet in bits
+     * @param snr The signal to interference plus noise ratio (not in dB)
+     */
+    double GetPacketErrorRate (ns3::Ptr<StdmaSlotPhy> receiver, ns3::WifiMode mode, uint32_t bits, double snr);
+
+    /**
+     * @return The mobility model of the phy with the given index, resolved on first use
+     */
+    ns3::Ptr<ns3::MobilityModel> GetMobility (uint32_t index);
+
+    /**
+     * Schedules the resolution of the slot that is currently collected, unless it is resolved later anyway
+     *
+     * @param delay The delay after which the slot is resolved
+     */
+    void ScheduleResolve (ns3::Time delay);
+
+    /**
+     * Appends a transmission to the messages for all systems whose segment is within the boundary width of
+     * the sender
+     */
+    void Forward (const Transmission &tx);
+
+    /**
+     * Sends the messages that have been collected for the other systems
+     */
+    void SendRemote (void);
+
+    /**
+     * Adds the transmissions of a message from another system to the slot that is currently collected
+     *
+     * @param message The message
+     */
+    void ReceiveRemote (ns3::Ptr<ns3::Packet> message);
+
+    /**
+     * @param tx The transmission
+     * @return The record of the transmission within a message to another system
+     */
+    static std::string EncodeTransmission (const Transmission &tx);
+
+    /**
+     * Adds the transmissions of the given records to the slot that is currently collected
+     *
+     * @param data The records, as concatenated by Forward
+     */
+    void DecodeTransmissions (const std::string &data);
+
+    std::vector<ns3::Ptr<StdmaSlotPhy> > m_phys;
+    std::vector<ns3::Ptr<ns3::MobilityModel> > m_mobility;
+    std::vector<uint32_t> m_nodes;                      // Node ids of the phys, i.e. the contexts of their receptions
+    std::vector<bool> m_local;                          // Whether the node of a phy is run by this system
+    ns3::Ptr<ns3::PropagationLossModel> m_loss;
+
+    std::vector<Transmission> m_transmissions;          // Transmissions of the slot currently collected
+    ns3::EventId m_resolveEvent;
+    ns3::Time m_resolveAt;
+    std::vector<double> m_rxPowerW;                     // Scratch: received power per transmission and receiver
+    std::vector<bool> m_transmitting;                   // Scratch: whether a phy transmits in the slot
+
+    ns3::Time m_lookahead;
+    double m_boundaryWidth;
+    std::vector<double> m_bounds;                       // Segment borders, one segment per system
+    std::vector<std::pair<uint32_t, uint32_t> > m_gateways;  // Receiving node and device per system
+    std::vector<StdmaSnapshotWriter> m_outgoing;        // Messages collected per system
+    ns3::EventId m_sendEvent;
+
+    double m_tableMinDb;
+    double m_tableStepDb;
+    uint32_t m_tableSize;
+    // Key of a packet error rate lookup table: the error rate model, the mode and the packet size in bits
+    typedef std::pair<ns3::Ptr<ns3::ErrorRateModel>, std::pair<uint32_t, uint32_t> > PerTableKey;
+    std::map<PerTableKey, std::vector<double> > m_perTables;  // PER per SNR
+    ns3::Ptr<ns3::UniformRandomVariable> m_random;
+
+    friend class StdmaSlotChannelEncodingTest;
+    friend class StdmaSlotChannelErrorRateTest;
+  };
+
+} // namespace stdma
+
+#endif /* STDMA_SLOT_CHANNEL_H_ */
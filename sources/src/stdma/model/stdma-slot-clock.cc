@@ -0,0 +1,111 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-slot-clock.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+NS_LOG_COMPONENT_DEFINE ("StdmaSlotClock");
+
+namespace stdma {
+
+  NS_OBJECT_ENSURE_REGISTERED (StdmaSlotClock);
+
+  ns3::TypeId
+  StdmaSlotClock::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaSlotClock")
+            .SetParent<Object>().AddConstructor<StdmaSlotClock>();
+    return tid;
+  }
+
+  StdmaSlotClock::StdmaSlotClock()
+    : m_slotDuration(ns3::Seconds(0)),
+      m_slotNs(0),
+      m_current(0),
+      m_currentStart(0)
+  {
+  }
+
+  StdmaSlotClock::~StdmaSlotClock()
+  {
+  }
+
+  void
+  StdmaSlotClock::SetSlotDuration(ns3::Time duration)
+  {
+    NS_LOG_FUNCTION(this << duration);
+    NS_ASSERT(duration.IsStrictlyPositive());
+    if (m_slotNs != 0 && m_slotNs != duration.GetNanoSeconds())
+      {
+        NS_FATAL_ERROR("StdmaSlotClock:SetSlotDuration() all stations on a channel have to use the same slot duration ("
+            << duration << " != " << m_slotDuration << ")");
+      }
+    m_slotDuration = duration;
+    m_slotNs = duration.GetNanoSeconds();
+    m_current = 0;
+    m_currentStart = 0;
+  }
+
+  ns3::Time
+  StdmaSlotClock::GetSlotDuration() const
+  {
+    return m_slotDuration;
+  }
+
+  uint64_t
+  StdmaSlotClock::GetCurrentSlot()
+  {
+    NS_ASSERT(m_slotNs > 0);
+    int64_t now = ns3::Simulator::Now().GetNanoSeconds();
+    int64_t offset = now - m_currentStart;
+    if (offset >= 0 && offset < m_slotNs)
+      {
+        return m_current;
+      }
+    // Most of the time the simulation has just moved on to the following slot
+    if (offset >= m_slotNs && offset < 2 * m_slotNs)
+      {
+        m_current++;
+        m_currentStart += m_slotNs;
+      }
+    else
+      {
+        m_current = now / m_slotNs;
+        m_currentStart = m_current * m_slotNs;
+      }
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " StdmaSlotClock:GetCurrentSlot() now in global slot " << m_current);
+    return m_current;
+  }
+
+  uint64_t
+  StdmaSlotClock::GetSlotForTimestamp(ns3::Time t)
+  {
+    NS_ASSERT(m_slotNs > 0);
+    int64_t offset = t.GetNanoSeconds() - m_currentStart;
+    if (offset >= 0 && offset < m_slotNs)
+      {
+        return m_current;
+      }
+    return t.GetNanoSeconds() / m_slotNs;
+  }
+
+} // namespace stdma
@@ -0,0 +1,80 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SLOT_CLOCK_H_
+#define STDMA_SLOT_CLOCK_H_
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+
+namespace stdma {
+
+  /**
+   * \brief Slot grid shared by all STDMA stations attached to the same channel
+   *
+   * All stations align their frames to multiples of the slot duration, hence they share one global slot grid,
+   * where the global slot index of a time stamp t is t / slotDuration. The slot clock is aggregated to the
+   * channel and keeps the index and the boundaries of the current slot, such that the index is derived only
+   * once per slot boundary instead of once per query by every station.
+   */
+  class StdmaSlotClock : public ns3::Object
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaSlotClock();
+    virtual ~StdmaSlotClock();
+
+    /**
+     * Sets the duration of a slot. All stations sharing the clock have to use the same slot duration.
+     *
+     * @param duration The duration of a slot, an integral number of nanoseconds
+     */
+    void SetSlotDuration(ns3::Time duration);
+
+    /**
+     * @return The duration of a slot
+     */
+    ns3::Time GetSlotDuration() const;
+
+    /**
+     * @return The global index of the slot that contains the current simulation time
+     */
+    uint64_t GetCurrentSlot();
+
+    /**
+     * Returns the global index of the slot that contains the given time stamp
+     *
+     * @param t The time stamp
+     * @return The global slot index
+     */
+    uint64_t GetSlotForTimestamp(ns3::Time t);
+
+  private:
+    ns3::Time m_slotDuration;
+    int64_t m_slotNs;
+    uint64_t m_current;                 // Global index of the slot last published
+    int64_t m_currentStart;             // Start of that slot in nanoseconds
+  };
+
+} // namespace stdma
+
+#endif /* STDMA_SLOT_CLOCK_H_ */
@@ -23,51 +23,72 @@
 #include "ns3/random-variable.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
-#include "ns3/mobility-model.h"
-#include "ns3/node.h"
-#include "ns3/node-list.h"
+#include "ns3/pointer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 NS_LOG_COMPONENT_DEFINE ("StdmaSlotManager");
 
 namespace stdma {
 
-  StdmaSlot::StdmaSlot (uint32_t index)
-    : m_internal(false),
-      m_state(StdmaSlot::FREE),
-      m_previousState(StdmaSlot::FREE),
-      m_index(index),
-      m_timeout(0),
-      m_internalTimeout(0),
-      m_notBefore(ns3::Seconds(0))
+  /**
+   * Returns a word in which the bits from to to (both inclusive, 0 <= from <= to < 64) are set
+   */
+  static inline uint64_t
+  GetBitRange (uint32_t from, uint32_t to)
+  {
+    uint64_t upper = (to == 63) ? ~((uint64_t) 0) : ((((uint64_t) 1) << (to + 1)) - 1);
+    return upper & ~((((uint64_t) 1) << from) - 1);
+  }
+
+  static inline void
+  AssignBit (std::vector<uint64_t> &bits, uint32_t index, bool value)
   {
+    uint64_t mask = ((uint64_t) 1) << (index % 64);
+    if (value)
+      {
+        bits[index / 64] |= mask;
+      }
+    else
+      {
+        bits[index / 64] &= ~mask;
+      }
   }
 
-  StdmaSlot::~StdmaSlot()
+  StdmaSlot::StdmaSlot (StdmaSlotManager *manager, uint32_t index)
+    : m_manager(manager),
+      m_index(index)
   {
+    NS_ASSERT(m_manager != 0);
+    NS_ASSERT(m_index < m_manager->m_numSlots);
   }
 
   StdmaSlot::State
   StdmaSlot::GetState()
   {
-    return m_state;
+    m_manager->RefreshSlot(m_index);
+    return (StdmaSlot::State) m_manager->m_slotState[m_index];
   }
 
   bool
   StdmaSlot::IsInternallyAllocated()
   {
-    return m_internal;
+    return m_manager->m_slotInternal[m_index];
   }
 
   void
   StdmaSlot::MarkAsFree()
   {
-    m_previousState = m_state;
-    m_state = StdmaSlot::FREE;
-    m_internal = false;
-    m_timeout = 0;
-    m_internalTimeout = 0;
-    m_notBefore = ns3::Seconds(0);
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsFree() marked slot " << m_index << " as free (timeout = " << (uint32_t) m_timeout << ")");
+    m_manager->m_slotPreviousState[m_index] = m_manager->m_slotState[m_index];
+    m_manager->m_slotState[m_index] = StdmaSlot::FREE;
+    m_manager->m_slotInternal[m_index] = false;
+    m_manager->m_slotExpiry[m_index] = 0;
+    m_manager->m_slotInternalTimeout[m_index] = 0;
+    m_manager->m_slotNotBefore[m_index] = ns3::Seconds(0);
+    m_manager->UpdateSlotIndex(m_index);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsFree() marked slot " << m_index << " as free");
   }
 
   bool
@@ -81,77 +102,93 @@ namespace stdma {
   {
     // The slot is considered to be free if it is marked as FREE or if the previous state was FREE
     // and the until parameter refers to a time before the notBefore attribute
-    return (m_state == StdmaSlot::FREE || (m_previousState == StdmaSlot::FREE && until < m_notBefore));
+    m_manager->RefreshSlot(m_index);
+    return (m_manager->m_slotState[m_index] == StdmaSlot::FREE
+        || (m_manager->m_slotPreviousState[m_index] == StdmaSlot::FREE && until < m_manager->m_slotNotBefore[m_index]));
   }
 
   void
   StdmaSlot::MarkAsAllocated(uint8_t timeout, ns3::Mac48Address owner, ns3::Vector position, ns3::Time notBefore)
+  {
+    MarkAsAllocated(timeout, owner, position, notBefore, std::numeric_limits<double>::quiet_NaN());
+  }
+
+  void
+  StdmaSlot::MarkAsAllocated(uint8_t timeout, ns3::Mac48Address owner, ns3::Vector position, ns3::Time notBefore, double rxPowerDbm)
   {
     NS_LOG_FUNCTION_NOARGS();
+    uint32_t &currentExpiry = m_manager->m_slotExpiry[m_index];
+    ns3::Time &currentNotBefore = m_manager->m_slotNotBefore[m_index];
+    // The timeout only counts down at frame boundaries from notBefore on
+    uint32_t expiry = m_manager->GetFrameNumberBefore(notBefore) + timeout + 1;
     if (IsAllocated())
       {
-        if (timeout > m_timeout)
+        if (expiry > currentExpiry)
           {
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsAllocated() updating slot " << m_index << " to new timeout = " << (uint32_t) timeout);
-            m_timeout = timeout;
+            currentExpiry = expiry;
           }
         else
           {
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsAllocated() not updating slot " << m_index
-                << " to new timeout since already known timeout value is larger (" << (uint32_t) timeout << "<=" << (uint32_t) m_timeout << ")");
+                << " to new timeout since already known timeout value is larger (" << (uint32_t) timeout << "<=" << (uint32_t) GetTimeout() << ")");
           }
-        if (notBefore < m_notBefore)
+        if (notBefore < currentNotBefore)
           {
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsAllocated() updated notBefore to " << notBefore.GetSeconds());
-            m_notBefore = notBefore;
+            currentNotBefore = notBefore;
           }
       }
     else
       {
-        m_previousState = m_state;
-        m_timeout = timeout;
-        m_state = StdmaSlot::ALLOCATED;
-        m_notBefore = notBefore;
-        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsAllocated() marking slot " << m_index << " as allocated with timeout = " << (uint32_t) m_timeout << " and notBefore = " << notBefore.GetSeconds());
+        m_manager->m_slotPreviousState[m_index] = m_manager->m_slotState[m_index];
+        currentExpiry = expiry;
+        m_manager->m_slotState[m_index] = StdmaSlot::ALLOCATED;
+        currentNotBefore = notBefore;
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsAllocated() marking slot " << m_index << " as allocated with timeout = " << (uint32_t) timeout << " and notBefore = " << notBefore.GetSeconds());
       }
-    m_position = position;
-    m_owner = owner;
+    m_manager->m_slotPosition[m_index] = position;
+    m_manager->m_slotRxPower[m_index] = rxPowerDbm;
+    m_manager->m_slotOwner[m_index] = owner;
+    m_manager->UpdateSlotIndex(m_index);
   }
 
   bool
   StdmaSlot::IsAllocated()
   {
-    return (m_state == StdmaSlot::ALLOCATED && ns3::Simulator::Now() >= m_notBefore);
+    m_manager->RefreshSlot(m_index);
+    return (m_manager->m_slotState[m_index] == StdmaSlot::ALLOCATED && ns3::Simulator::Now() >= m_manager->m_slotNotBefore[m_index]);
   }
 
   void
   StdmaSlot::MarkAsInternallyAllocated(uint8_t timeout)
   {
     NS_LOG_FUNCTION((uint32_t) timeout);
-    m_internal = true;
-    m_internalTimeout = timeout;
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsInternallyAllocated() marked slot " << m_index << " as internally allocated (timeout = " << (uint32_t) m_internalTimeout << ")");
+    // Bring the external state up to date first, it is frozen for as long as we use this slot ourselves
+    m_manager->RefreshSlot(m_index);
+    m_manager->m_slotInternal[m_index] = true;
+    m_manager->m_slotInternalTimeout[m_index] = timeout;
+    m_manager->UpdateSlotIndex(m_index);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlot:MarkAsInternallyAllocated() marked slot " << m_index << " as internally allocated (timeout = " << (uint32_t) timeout << ")");
   }
 
   void
   StdmaSlot::MarkAsBusy()
   {
-    m_previousState = m_state;
-    m_state = StdmaSlot::BUSY;
-    m_notBefore = ns3::Seconds(0);
-    m_timeout = 1;
+    m_manager->RefreshSlot(m_index);
+    m_manager->m_slotPreviousState[m_index] = m_manager->m_slotState[m_index];
+    m_manager->m_slotState[m_index] = StdmaSlot::BUSY;
+    m_manager->m_slotNotBefore[m_index] = ns3::Seconds(0);
+    // A busy marking corresponds to a timeout of one frame
+    m_manager->m_slotExpiry[m_index] = m_manager->m_frame + 2;
+    m_manager->UpdateSlotIndex(m_index);
   }
 
   bool
   StdmaSlot::IsBusy()
   {
-    return (m_state == StdmaSlot::BUSY && ns3::Simulator::Now() >= m_notBefore);
-  }
-
-  void
-  StdmaSlot::RebaseIndex(uint32_t index)
-  {
-    m_index = index;
+    m_manager->RefreshSlot(m_index);
+    return (m_manager->m_slotState[m_index] == StdmaSlot::BUSY && ns3::Simulator::Now() >= m_manager->m_slotNotBefore[m_index]);
   }
 
   uint32_t
@@ -163,37 +200,57 @@ namespace stdma {
   void
   StdmaSlot::SetTimeout(uint8_t t)
   {
-    m_timeout = t;
+    m_manager->m_slotExpiry[m_index] = m_manager->m_frame + t + 1;
+    m_manager->UpdateSlotIndex(m_index);
   }
 
   void
   StdmaSlot::SetInternalTimeout(uint8_t t)
   {
-    m_internalTimeout = t;
+    m_manager->m_slotInternalTimeout[m_index] = t;
   }
 
   uint8_t
   StdmaSlot::GetTimeout()
   {
-    return m_timeout;
+    // The remaining number of frame boundaries to be crossed before the slot expires
+    m_manager->RefreshSlot(m_index);
+    uint32_t expiry = m_manager->m_slotExpiry[m_index];
+    if (m_manager->m_slotState[m_index] == StdmaSlot::FREE || expiry <= m_manager->m_frame)
+      {
+        return 0;
+      }
+    return std::min<uint32_t>(expiry - m_manager->m_frame - 1, 255);
   }
 
   uint8_t
   StdmaSlot::GetInternalTimeout()
   {
-    return m_internalTimeout;
+    return m_manager->m_slotInternalTimeout[m_index];
   }
 
   ns3::Vector
   StdmaSlot::GetPosition()
   {
-    return m_position;
+    return m_manager->m_slotPosition[m_index];
   }
 
   ns3::Mac48Address 
   StdmaSlot::GetOwner()
   {
-    return m_owner;
+    return m_manager->m_slotOwner[m_index];
+  }
+
+  bool
+  StdmaSlot::HasRxPower()
+  {
+    return !std::isnan(m_manager->m_slotRxPower[m_index]);
+  }
+
+  double
+  StdmaSlot::GetRxPower()
+  {
+    return m_manager->m_slotRxPower[m_index];
   }
 
   RandomAccessDetails::RandomAccessDetails ()
@@ -203,10 +260,6 @@ namespace stdma {
   {
   }
 
-  RandomAccessDetails::~RandomAccessDetails()
-  {
-  }
-
   void
   RandomAccessDetails::SetWhen (ns3::Time when)
   {
@@ -226,28 +279,60 @@ namespace stdma {
   }
 
   ns3::Time
-  RandomAccessDetails::GetWhen()
+  RandomAccessDetails::GetWhen() const
   {
     return m_when;
   }
 
   double
-  RandomAccessDetails::GetProbability()
+  RandomAccessDetails::GetProbability() const
   {
     return m_p;
   }
 
   uint16_t
-  RandomAccessDetails::GetRemainingSlots()
+  RandomAccessDetails::GetRemainingSlots() const
   {
     return m_slotsLeft;
   }
 
+  StdmaFrameStatistics::StdmaFrameStatistics ()
+    : frame(0),
+      freeSlots(0),
+      busySlots(0),
+      allocatedSlots(0),
+      internalSlots(0),
+      collisions(0),
+      reservations(0),
+      reReservations(0)
+  {
+    for (uint32_t i = 0; i < HISTOGRAM_BINS; i++)
+      {
+        candidateSetSizes[i] = 0;
+      }
+  }
+
+  uint32_t
+  StdmaFrameStatistics::GetCandidateSetSizeBin (uint32_t size)
+  {
+    if (size <= 1)
+      {
+        return 0;
+      }
+    uint32_t bin = 31 - __builtin_clz(size);
+    return std::min(bin, HISTOGRAM_BINS - 1);
+  }
+
   ns3::TypeId
   StdmaSlotManager::GetTypeId (void)
   {
     static ns3::TypeId tid = ns3::TypeId("stdma::StdmaSlotManager")
             .SetParent<Object>().AddConstructor<StdmaSlotManager>()
+            .AddAttribute("SelectionPolicy",
+                          "The policy used to select a transmission slot among the candidates of the selection interval",
+                          ns3::PointerValue (),
+                          ns3::MakePointerAccessor (&StdmaSlotManager::m_policy),
+                          ns3::MakePointerChecker<StdmaSlotSelectionPolicy> ())
             .AddTraceSource("NominalSlotSelection",
                             "This event is triggered when the station selects its nominal slot set",
                             ns3::MakeTraceSourceAccessor (&StdmaSlotManager::m_nominalSlotTrace))
@@ -256,7 +341,10 @@ namespace stdma {
                             ns3::MakeTraceSourceAccessor (&StdmaSlotManager::m_reservationTrace))
             .AddTraceSource("SlotReReservation",
                             "This event is triggered when the station performs a re-reservation of a slot",
-                            ns3::MakeTraceSourceAccessor (&StdmaSlotManager::m_reReservationTrace));
+                            ns3::MakeTraceSourceAccessor (&StdmaSlotManager::m_reReservationTrace))
+            .AddTraceSource("FrameStatistics",
+                            "This event is triggered once per frame with the slot counts and reservation counters of the frame",
+                            ns3::MakeTraceSourceAccessor (&StdmaSlotManager::m_frameStatisticsTrace));
     return tid;
   }
 
@@ -265,10 +353,23 @@ namespace stdma {
       m_rate(0),
       m_ni(0),
       m_siHalf(0),
+      m_selectionRatio(0),
+      m_lastFrameStartSlot(0),
+      m_frame(0),
       m_current(0),
       m_mininumCandidates(0),
       m_numSlots(0)
   {
+    m_policy = ns3::CreateObject<StdmaRxPowerSlotSelectionPolicy>();
+    m_networkEntryRng = ns3::CreateObject<ns3::UniformRandomVariable>();
+  }
+
+  int64_t
+  StdmaSlotManager::AssignStreams (int64_t stream)
+  {
+    NS_LOG_FUNCTION(this << stream);
+    m_networkEntryRng->SetStream(stream);
+    return 1;
   }
 
   StdmaSlotManager::~StdmaSlotManager()
@@ -298,15 +399,31 @@ namespace stdma {
         m_start = ns3::NanoSeconds(m_slotDuration.GetNanoSeconds() * ceil(slotsUntilStart));
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:StdmaSlotManager() setting m_start to " << m_start << " (start was " << start << ")");
       }
-    // Afterwards initialize the vector of slot objects
+    // Afterwards initialize the reservation table, all slots are free in the beginning
+    m_slotState.assign(m_numSlots, StdmaSlot::FREE);
+    m_slotPreviousState.assign(m_numSlots, StdmaSlot::FREE);
+    m_slotInternal.assign(m_numSlots, false);
+    m_slotExpiry.assign(m_numSlots, 0);
+    m_slotInternalTimeout.assign(m_numSlots, 0);
+    m_slotNotBefore.assign(m_numSlots, ns3::Seconds(0));
+    m_slotOwner.assign(m_numSlots, ns3::Mac48Address());
+    m_slotPosition.assign(m_numSlots, ns3::Vector());
+    m_slotRxPower.assign(m_numSlots, std::numeric_limits<double>::quiet_NaN());
+    uint32_t numWords = (m_numSlots + 63) / 64;
+    m_freeSlots.assign(numWords, 0);
+    m_allocatedSlots.assign(numWords, 0);
+    m_internalSlots.assign(numWords, 0);
+    m_deferredSlots.assign(numWords, 0);
+    m_wordExpiry.assign(numWords, std::numeric_limits<uint32_t>::max());
     for (uint32_t i = 0; i < m_numSlots; i++)
       {
-        ns3::Ptr<StdmaSlot> slot = ns3::Create<StdmaSlot>(i);
-        m_slots[i] = slot;
+        UpdateSlotIndex(i);
       }
 
     // Remember the start of the last/current frame
     m_lastFrameStart = m_start;
+    m_lastFrameStartSlot = m_start.GetNanoSeconds() / m_slotDuration.GetNanoSeconds();
+    m_frame = 0;
   }
 
   ns3::Time
@@ -330,8 +447,10 @@ namespace stdma {
   void
   StdmaSlotManager::SetReportRate(uint32_t rate)
   {
+    NS_ASSERT(rate > 0 && rate <= m_numSlots);
     m_rate = rate;
     m_ni = floor(1.0 * m_numSlots / m_rate);
+    m_siHalf = floor(0.5 * (m_ni-1) * m_selectionRatio);
   }
 
   void
@@ -340,9 +459,22 @@ namespace stdma {
     m_mininumCandidates = size;
   }
 
+  void
+  StdmaSlotManager::SetPosition (ns3::Vector position)
+  {
+    m_position = position;
+  }
+
+  uint32_t
+  StdmaSlotManager::GetMinimumCandidateSlotSetSize ()
+  {
+    return m_mininumCandidates;
+  }
+
   void
   StdmaSlotManager::SetSelectionIntervalRatio(double ratio)
   {
+    m_selectionRatio = ratio;
     m_siHalf = floor(0.5 * (m_ni-1) * ratio);
   }
 
@@ -379,6 +511,344 @@ namespace stdma {
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectNominalSlots() " << i << ". NS = " << NSS + (i * m_ni));
       }
 
+    TraceNominalSlots();
+  }
+
+  void
+  StdmaSlotManager::ChangeReportRate(uint32_t rate, uint8_t timeout)
+  {
+    NS_LOG_FUNCTION(this << rate << (uint32_t) timeout);
+    NS_ASSERT(m_selections.size() == m_rate);
+
+    // Update the slot reservation / observation / allocation status at the beginning
+    // of each new frame
+    if (ns3::Simulator::Now() >= m_lastFrameStart + m_frameDuration)
+      {
+        UpdateSlotObservations();
+      }
+
+    // The reservation that is about to be transmitted becomes the anchor of the new nominal slots
+    uint32_t anchor = m_selections[m_current];
+    std::vector<uint32_t> previous;
+    for (uint32_t i = 0; i < m_rate; i++)
+      {
+        if (i != m_current)
+          {
+            previous.push_back(m_selections[i]);
+          }
+      }
+    SetReportRate(rate);
+    m_nss.clear();
+    m_selections.clear();
+    m_current = 0;
+    for (uint32_t i = 0; i < m_rate; i++)
+      {
+        m_nss.push_back((anchor + i * m_ni) % m_numSlots);
+      }
+    m_selections[0] = anchor;
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ChangeReportRate() new rate = " << m_rate << ", NI = " << m_ni << ", anchor = " << anchor);
+
+    // 1) keep the closest previous reservation within the selection interval of each nominal slot
+    std::vector<uint32_t> missing;
+    for (uint32_t i = 1; i < m_rate; i++)
+      {
+        uint32_t best = previous.size();
+        uint32_t bestDistance = m_siHalf + 1;
+        for (uint32_t j = 0; j < previous.size(); j++)
+          {
+            uint32_t distance = (previous[j] + m_numSlots - m_nss[i]) % m_numSlots;
+            distance = std::min(distance, m_numSlots - distance);
+            if (distance < bestDistance)
+              {
+                best = j;
+                bestDistance = distance;
+              }
+          }
+        if (best < previous.size())
+          {
+            m_selections[i] = previous[best];
+            previous.erase(previous.begin() + best);
+            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ChangeReportRate() keeping slot " << m_selections[i] << " for reservation " << i);
+          }
+        else
+          {
+            missing.push_back(i);
+          }
+      }
+
+    // 2) release the previous reservations that are not needed anymore, and forget about the collisions
+    //    we introduced on them
+    for (uint32_t j = 0; j < previous.size(); j++)
+      {
+        uint32_t index = previous[j];
+        if (GetSlot(index).IsAllocated())
+          {
+            m_collisions.erase(m_slotOwner[index]);
+          }
+        GetSlot(index).MarkAsFree();
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ChangeReportRate() releasing slot " << index);
+      }
+
+    // 3) select slots for the nominal slots that are not covered yet
+    for (uint32_t k = 0; k < missing.size(); k++)
+      {
+        uint32_t numFree = 0;
+        uint32_t index = SelectCandidateSlot(missing[k], timeout, true, numFree);
+        bool wasFree = ReserveSlot(missing[k], index, timeout);
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ChangeReportRate() reserved slot " << index << " for reservation " << missing[k]);
+        m_statistics.reservations++;
+        m_reservationTrace(m_candidates.size(), numFree, wasFree);
+      }
+    TraceNominalSlots();
+  }
+
+  double
+  StdmaSlotManager::GetChannelLoad()
+  {
+    uint32_t numFree = ScanSlots(0, m_numSlots, ns3::Simulator::Now(), ns3::Seconds(0), 0, 0);
+    // Our own reservations keep the external state of their slots, so they have to be counted separately
+    std::map<uint32_t, uint32_t>::iterator it;
+    for (it = m_selections.begin(); it != m_selections.end(); ++it)
+      {
+        if (GetSlot(it->second).IsFree())
+          {
+            numFree--;
+          }
+      }
+    return 1.0 - (1.0 * numFree / m_numSlots);
+  }
+
+  StdmaFrameStatistics
+  StdmaSlotManager::GetFrameStatistics()
+  {
+    // Update the slot reservation / observation / allocation status at the beginning
+    // of each new frame
+    if (ns3::Simulator::Now() >= m_lastFrameStart + m_frameDuration)
+      {
+        UpdateSlotObservations();
+      }
+    StdmaFrameStatistics statistics = m_statistics;
+    CountSlots(statistics);
+    return statistics;
+  }
+
+  const StdmaFrameStatistics &
+  StdmaSlotManager::GetLastFrameStatistics() const
+  {
+    return m_lastStatistics;
+  }
+
+  ns3::Time
+  StdmaSlotManager::GetCurrentFrameStart()
+  {
+    // Update the slot reservation / observation / allocation status at the beginning
+    // of each new frame
+    if (ns3::Simulator::Now() >= m_lastFrameStart + m_frameDuration)
+      {
+        UpdateSlotObservations();
+      }
+    return m_lastFrameStart;
+  }
+
+  void
+  StdmaSlotManager::SaveState(StdmaSnapshotWriter &writer)
+  {
+    NS_LOG_FUNCTION(this);
+    // Let slots expire first, such that they do not have to be written
+    ns3::Time now = ns3::Simulator::Now();
+    GetCurrentFrameStart();
+    for (uint32_t word = 0; word < m_freeSlots.size(); word++)
+      {
+        RefreshSlotWord(word);
+      }
+
+    writer.WriteU32(m_numSlots);
+    writer.WriteU64(m_slotDuration.GetNanoSeconds());
+    writer.WriteTime(m_lastFrameStart);
+    writer.WriteU32(m_frame);
+    writer.WriteU32(m_current);
+    writer.WriteU32(m_rate);
+    writer.WriteDouble(m_selectionRatio);
+    writer.WriteVector(m_position);
+    writer.WriteU32(m_nss.size());
+    for (uint32_t i = 0; i < m_nss.size(); i++)
+      {
+        writer.WriteU32(m_nss[i]);
+      }
+
+    // Reservation table: the states are packed into one byte, followed by the values that are relevant
+    // for the states. A time stamp from which on a state is valid is only kept if it is still in the future.
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < m_numSlots; i++)
+      {
+        used += (m_slotState[i] != StdmaSlot::FREE || m_slotInternal[i]) ? 1 : 0;
+      }
+    writer.WriteU32(used);
+    for (uint32_t i = 0; i < m_numSlots; i++)
+      {
+        if (m_slotState[i] == StdmaSlot::FREE && !m_slotInternal[i])
+          {
+            continue;
+          }
+        bool future = m_slotNotBefore[i] > now;
+        writer.WriteU32(i);
+        writer.WriteU8(m_slotState[i] | (m_slotPreviousState[i] << 2) | (m_slotInternal[i] << 4) | (future << 5));
+        if (m_slotState[i] != StdmaSlot::FREE)
+          {
+            writer.WriteU32(m_slotExpiry[i]);
+          }
+        if (m_slotState[i] == StdmaSlot::ALLOCATED)
+          {
+            writer.WriteAddress(m_slotOwner[i]);
+            writer.WriteVector(m_slotPosition[i]);
+            writer.WriteDouble(m_slotRxPower[i]);
+          }
+        if (m_slotInternal[i])
+          {
+            writer.WriteU8(m_slotInternalTimeout[i]);
+          }
+        if (future)
+          {
+            writer.WriteTime(m_slotNotBefore[i]);
+          }
+      }
+
+    writer.WriteU32(m_selections.size());
+    for (std::map<uint32_t, uint32_t>::iterator it = m_selections.begin(); it != m_selections.end(); ++it)
+      {
+        writer.WriteU32(it->first);
+        writer.WriteU32(it->second);
+      }
+    writer.WriteU32(m_collisions.size());
+    for (std::map<ns3::Mac48Address, uint32_t>::iterator it = m_collisions.begin(); it != m_collisions.end(); ++it)
+      {
+        writer.WriteAddress(it->first);
+        writer.WriteU32(it->second);
+      }
+  }
+
+  void
+  StdmaSlotManager::RestoreState(StdmaSnapshotReader &reader)
+  {
+    NS_LOG_FUNCTION(this);
+    uint32_t numSlots = reader.ReadU32();
+    uint64_t slotDuration = reader.ReadU64();
+    if (numSlots != m_numSlots || slotDuration != (uint64_t) m_slotDuration.GetNanoSeconds())
+      {
+        NS_FATAL_ERROR("StdmaSlotManager:RestoreState() the snapshot has been taken with a different frame or slot duration");
+      }
+
+    // Only the phase of the frames matters, slots before the current frame are counted from the last frame boundary
+    // at or after time zero
+    m_lastFrameStart = reader.ReadTime();
+    NS_ASSERT(!m_lastFrameStart.IsStrictlyNegative());
+    m_lastFrameStartSlot = m_lastFrameStart.GetNanoSeconds() / m_slotDuration.GetNanoSeconds();
+    m_start = ns3::NanoSeconds(m_lastFrameStart.GetNanoSeconds() % m_frameDuration.GetNanoSeconds());
+    m_frame = reader.ReadU32();
+    m_current = reader.ReadU32();
+    uint32_t rate = reader.ReadU32();
+    m_selectionRatio = reader.ReadDouble();
+    SetReportRate(rate);
+    m_position = reader.ReadVector();
+    m_nss.resize(reader.ReadU32());
+    for (uint32_t i = 0; i < m_nss.size(); i++)
+      {
+        m_nss[i] = reader.ReadU32();
+      }
+
+    m_slotState.assign(m_numSlots, StdmaSlot::FREE);
+    m_slotPreviousState.assign(m_numSlots, StdmaSlot::FREE);
+    m_slotInternal.assign(m_numSlots, false);
+    m_slotExpiry.assign(m_numSlots, 0);
+    m_slotInternalTimeout.assign(m_numSlots, 0);
+    m_slotNotBefore.assign(m_numSlots, ns3::Seconds(0));
+    m_slotOwner.assign(m_numSlots, ns3::Mac48Address());
+    m_slotPosition.assign(m_numSlots, ns3::Vector());
+    m_slotRxPower.assign(m_numSlots, std::numeric_limits<double>::quiet_NaN());
+    uint32_t used = reader.ReadU32();
+    for (uint32_t k = 0; k < used; k++)
+      {
+        uint32_t i = reader.ReadU32();
+        NS_ASSERT(i < m_numSlots);
+        uint8_t states = reader.ReadU8();
+        m_slotState[i] = states & 0x3;
+        m_slotPreviousState[i] = (states >> 2) & 0x3;
+        m_slotInternal[i] = (states >> 4) & 0x1;
+        if (m_slotState[i] != StdmaSlot::FREE)
+          {
+            m_slotExpiry[i] = reader.ReadU32();
+          }
+        if (m_slotState[i] == StdmaSlot::ALLOCATED)
+          {
+            m_slotOwner[i] = reader.ReadAddress();
+            m_slotPosition[i] = reader.ReadVector();
+            m_slotRxPower[i] = reader.ReadDouble();
+          }
+        if (m_slotInternal[i])
+          {
+            m_slotInternalTimeout[i] = reader.ReadU8();
+          }
+        if ((states >> 5) & 0x1)
+          {
+            m_slotNotBefore[i] = reader.ReadTime();
+          }
+      }
+    RebuildSlotIndices();
+
+    m_selections.clear();
+    uint32_t selections = reader.ReadU32();
+    for (uint32_t k = 0; k < selections; k++)
+      {
+        uint32_t n = reader.ReadU32();
+        m_selections[n] = reader.ReadU32();
+      }
+    m_collisions.clear();
+    uint32_t collisions = reader.ReadU32();
+    for (uint32_t k = 0; k < collisions; k++)
+      {
+        ns3::Mac48Address owner = reader.ReadAddress();
+        m_collisions[owner] = reader.ReadU32();
+      }
+    m_statistics = StdmaFrameStatistics();
+    m_lastStatistics = StdmaFrameStatistics();
+  }
+
+  void
+  StdmaSlotManager::RebuildSlotIndices()
+  {
+    std::fill(m_freeSlots.begin(), m_freeSlots.end(), 0);
+    std::fill(m_allocatedSlots.begin(), m_allocatedSlots.end(), 0);
+    std::fill(m_internalSlots.begin(), m_internalSlots.end(), 0);
+    std::fill(m_deferredSlots.begin(), m_deferredSlots.end(), 0);
+    std::fill(m_wordExpiry.begin(), m_wordExpiry.end(), std::numeric_limits<uint32_t>::max());
+    for (uint32_t i = 0; i < m_numSlots; i++)
+      {
+        UpdateSlotIndex(i);
+      }
+  }
+
+  void
+  StdmaSlotManager::CountSlots(StdmaFrameStatistics &statistics)
+  {
+    statistics.frame = m_frame;
+    statistics.freeSlots = 0;
+    statistics.allocatedSlots = 0;
+    statistics.internalSlots = 0;
+    for (uint32_t word = 0; word < m_freeSlots.size(); word++)
+      {
+        RefreshSlotWord(word);
+        uint64_t internal = m_internalSlots[word];
+        statistics.freeSlots += __builtin_popcountll(m_freeSlots[word] & ~internal);
+        statistics.allocatedSlots += __builtin_popcountll(m_allocatedSlots[word] & ~internal);
+        statistics.internalSlots += __builtin_popcountll(internal);
+      }
+    statistics.busySlots = m_numSlots - statistics.freeSlots - statistics.allocatedSlots - statistics.internalSlots;
+    statistics.collisions = m_collisions.size();
+  }
+
+  void
+  StdmaSlotManager::TraceNominalSlots()
+  {
     // Trace the nominal slots, but re-base them to an imaginary frame start at 0 seconds
     std::vector<uint32_t> tracedNss;
     for (uint32_t i = 0; i < m_nss.size(); i++)
@@ -431,7 +901,6 @@ namespace stdma {
   {
     NS_LOG_FUNCTION(this << n << (uint32_t) timeout);
     NS_ASSERT(n < m_nss.size());
-    ns3::Time until = ns3::Simulator::Now() + ns3::Seconds(timeout * m_frameDuration.GetSeconds());
 
     // Update the slot reservation / observation / allocation status at the beginning
     // of each new frame
@@ -440,127 +909,17 @@ namespace stdma {
         UpdateSlotObservations();
       }
 
-    // 1) get the nominal slot for this packet
-    uint32_t NS = m_nss[n];
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() nominal slot = " << NS);
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() numSlots = " << m_numSlots);
-
-    // 2) compile the list of candidate slots
-    std::vector<uint32_t> candidates;
-    std::map<double, uint32_t> usedSlots;
-    int32_t lowerBound = (int32_t) NS - (int32_t) m_siHalf;
-    int32_t upperBound = (int32_t) NS + (int32_t) m_siHalf;
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() selection interval: [" << lowerBound << ":" << upperBound << "]");
-    for (int32_t i = lowerBound; i <= upperBound; i++)
-      {
-        // Handle negative indices properly by wrapping around
-        int32_t j = i;
-
-        // ... but skip negative indices when this is the first packet to be sent at all
-        if (i < 0 && m_selections.empty())
-          {
-            continue;
-          }
-        else if (i < 0)
-          {
-            j = m_numSlots + i;
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() negative index, wrapping around: " << i << " -> " << j);
-          }
-        else if (i >= m_numSlots)
-          {
-            j = i - m_numSlots;
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() too large index, wrapping around: " << i << " -> " << j);
-          }
-
-        // Then fetch the corresponding slot object and add it to the list according to its current status
-        NS_ASSERT(j >= 0);
-        NS_ASSERT(j < m_slots.size());
-        ns3::Ptr<StdmaSlot> slot = m_slots[j];
-        if (slot->IsFree(until))
-          {
-            candidates.push_back(slot->GetSlotIndex());
-          }
-        else if (slot->IsAllocated() && !slot->IsInternallyAllocated())
-          {
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() not considering slot "
-                << slot->GetSlotIndex() << " yet since it is already allocated by someone else.");
-            ns3::Vector owner = slot->GetPosition();
-            ns3::Vector myself = ns3::NodeList::GetNode(ns3::Simulator::GetContext())->GetObject<ns3::MobilityModel>()->GetPosition();
-            double distance = ns3::CalculateDistance(owner, myself);
-            while (usedSlots.find(distance) != usedSlots.end())
-              {
-                distance += 0.000001;
-              }
-            usedSlots[distance] = slot->GetSlotIndex();
-          }
-        else if (slot->IsBusy())
-          {
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() not considering slot "
-                << slot->GetSlotIndex() << " yet since it is marked busy.");
-          }
-      }
-
-    uint32_t numFree = candidates.size();
-
-    // If we do not have enough slots yet, we will add
-    if (candidates.size() < m_mininumCandidates)
-      {
-        // Add as many allocated slots until we have at least 4 candidates
-        // but only add slots owned by vehicles with which we do not collide yet
-        uint32_t missing = m_mininumCandidates - candidates.size();
-        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() " << missing << " slots need to be added that are already allocated");
-        std::map<double, uint32_t>::reverse_iterator it;
-        for (it = usedSlots.rbegin(); it != usedSlots.rend(); ++it)
-          {
-            uint32_t index = it->second;
-            ns3::Mac48Address owner = m_slots[index]->GetOwner();
-
-            // Add this slot if we do not already have a collision with the owner of it
-            if (m_collisions.find(owner) == m_collisions.end())
-              {
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() adding already allocated slot "
-                    << index << " to candidate set since its owner is " << it->first << " meters away");
-                candidates.push_back(index);
-                missing--;
-                if (missing == 0)
-                  {
-                    break;
-                  }
-              }
-            else
-              {
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() not adding already allocated slot "
-                    << index << " to candidate set because we already have a collision with the owner.");
-              }
-          }
-      }
-
-    // 3) randomly select one of these candidate slots
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() " << candidates.size() << " candidates available to choose from");
-    ns3::UniformVariable randomizer(0, candidates.size()-0.00001);
-    uint32_t selection = floor(randomizer.GetValue());
-    NS_ASSERT(selection < candidates.size());
-    uint32_t index = candidates[selection];
+    // 1) select one of the candidate slots, but skip negative indices when this is the first packet to be sent at all
+    uint32_t numFree = 0;
+    uint32_t index = SelectCandidateSlot(n, timeout, !m_selections.empty(), numFree);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectTransmissionSlotForReservationWithNo() reserved slot: " << index << ", timeout will be set to: " << (uint32_t) timeout);
 
-    // 4a) mark this slot as internally allocated
-    ns3::Ptr<StdmaSlot> slot = m_slots[index];
-    bool wasFree = slot->IsFree();
-    slot->MarkAsInternallyAllocated(timeout);
-    m_slots[index] = slot;
-    // 4b) and remember that we now introduced a collision with this node in case
-    //     this slot was already externally allocated
-    if (slot->IsAllocated())
-      {
-        ns3::Mac48Address owner = slot->GetOwner();
-        m_collisions[owner] = index;
-      }
-
-    // 5) Save this slot also in the map of scheduled transmissions
-    m_selections[n] = slot;
+    // 2) mark this slot as internally allocated
+    bool wasFree = ReserveSlot(n, index, timeout);
 
     // Trace this event...
-    m_reservationTrace(candidates.size(), numFree, wasFree);
+    m_statistics.reservations++;
+    m_reservationTrace(m_candidates.size(), numFree, wasFree);
   }
 
   uint32_t
@@ -569,7 +928,6 @@ namespace stdma {
     NS_LOG_FUNCTION(this << n << (uint32_t) timeout);
     NS_ASSERT(m_selections.find(n) != m_selections.end());
     NS_ASSERT(n < m_nss.size());
-    ns3::Time until = ns3::Simulator::Now() + ns3::Seconds(timeout * m_frameDuration.GetSeconds());
 
     // Update the slot reservation / observation / allocation status at the beginning
     // of each new frame
@@ -580,131 +938,85 @@ namespace stdma {
 
     // We basically perform exactly the same procedure as in the first frame phase, except that
     // we need to release the old slot before
-    uint32_t oldIndex = m_selections[n]->GetSlotIndex();
-    m_slots[oldIndex]->MarkAsFree();
+    uint32_t oldIndex = m_selections[n];
+    GetSlot(oldIndex).MarkAsFree();
+
+    // 1) select one of the candidate slots
+    uint32_t numFree = 0;
+    uint32_t newIndex = SelectCandidateSlot(n, timeout, true, numFree);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() newly reserved slot: " << newIndex);
+
+    // 2) mark this slot as internally allocated
+    bool isSame = (oldIndex == newIndex);
+    bool wasFree = ReserveSlot(n, newIndex, timeout);
+    NS_ASSERT(GetSlot(newIndex).IsInternallyAllocated());
+    NS_ASSERT(GetSlot(newIndex).GetInternalTimeout() == timeout);
+
+    // Trace this event...
+    m_statistics.reReservations++;
+    m_reReservationTrace(m_candidates.size(), numFree, wasFree, isSame);
+
+    // 3) Return offset to previously reserved slot
+    return (newIndex - oldIndex) + m_numSlots;
+  }
+
+  uint32_t
+  StdmaSlotManager::SelectCandidateSlot(uint32_t n, uint8_t timeout, bool wrap, uint32_t &numFree)
+  {
+    ns3::Time until = ns3::Simulator::Now() + ns3::Seconds(timeout * m_frameDuration.GetSeconds());
 
     // 1) get the nominal slot for this packet
     uint32_t NS = m_nss[n];
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() nominal slot = " << NS);
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() numSlots = " << m_numSlots);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectCandidateSlot() nominal slot = " << NS << ", numSlots = " << m_numSlots);
 
-    // 2) compile the list of candidate slots
-    std::vector<uint32_t> candidates;
-    std::map<double, uint32_t> usedSlots;
+    // 2) compile the list of candidate slots, wrapping around at both ends of the frame
     int32_t lowerBound = (int32_t) NS - (int32_t) m_siHalf;
     int32_t upperBound = (int32_t) NS + (int32_t) m_siHalf;
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() selection interval: [" << lowerBound << ":" << upperBound << "]");
-    for (int32_t i = lowerBound; i <= upperBound; i++)
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:SelectCandidateSlot() selection interval: [" << lowerBound << ":" << upperBound << "]");
+    uint32_t start = (lowerBound < 0) ? (uint32_t) (lowerBound + (int32_t) m_numSlots) : (uint32_t) lowerBound;
+    uint32_t count = upperBound - lowerBound + 1;
+    if (lowerBound < 0 && !wrap)
       {
-        // Handle negative indices properly by wrapping around
-        int32_t j = i;
-
-        // Wrap around if the index is smaller than zero...
-        if (i < 0)
-          {
-            j = m_numSlots + i;
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() negative index, wrapping around: " << i << " -> " << j);
-          }
-        else if (i >= m_numSlots) // ... or greater than the maximum number of slots per frame
-          {
-            j = i - m_numSlots;
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() too large index, wrapping around: " << i << " -> " << j);
-          }
-
-        // Then fetch the corresponding slot object and add it to the list according to its current status
-        NS_ASSERT(j >= 0);
-        NS_ASSERT(j < m_slots.size());
-        ns3::Ptr<StdmaSlot> slot = m_slots[j];
-        if (slot->IsFree(until))
-          {
-            candidates.push_back(slot->GetSlotIndex());
-          }
-        else if (slot->IsAllocated() && !slot->IsInternallyAllocated())
-          {
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() not considering slot "
-                << slot->GetSlotIndex() << " yet since it is already allocated by someone else.");
-            ns3::Vector owner = slot->GetPosition();
-            ns3::Vector myself = ns3::NodeList::GetNode(ns3::Simulator::GetContext())->GetObject<ns3::MobilityModel>()->GetPosition();
-            double distance = ns3::CalculateDistance(owner, myself);
-            while (usedSlots.find(distance) != usedSlots.end())
-              {
-                distance += 0.000001;
-              }
-            usedSlots[distance] = slot->GetSlotIndex();
-          }
-        else if (slot->IsBusy())
-          {
-            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() not considering slot "
-                << slot->GetSlotIndex() << " yet since it is marked busy.");
-          }
+        start = 0;
+        count = upperBound + 1;
       }
-    uint32_t numFree = candidates.size();
-
-    // If we do not have enough slots yet, we will add
-    if (candidates.size() < m_mininumCandidates)
-      {
-        // Add as many allocated slots until we have at least 4 candidates
-        // but only add slots owned by vehicles with which we do not collide yet
-        uint32_t missing = m_mininumCandidates - candidates.size();
-        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() " << missing << " slots need to be added that are already allocated");
-        std::map<double, uint32_t>::reverse_iterator it;
-        for (it = usedSlots.rbegin(); it != usedSlots.rend(); ++it)
-          {
-            uint32_t index = it->second;
-            ns3::Mac48Address owner = m_slots[index]->GetOwner();
-
-            // Add this slot if we do not already have a collision with the owner of it
-            if (m_collisions.find(owner) == m_collisions.end())
-              {
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() adding already allocated slot "
-                    << index << " to candidate set since its owner is " << it->first << " meters away");
-                candidates.push_back(index);
-                missing--;
-                if (missing == 0)
-                  {
-                    break;
-                  }
-              }
-            else
-              {
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() not adding already allocated slot "
-                    << index << " to candidate set because we already have a collision with the owner.");
-              }
-          }
-      }
-
-    // 3) randomly select one of these candidate slots
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() " << candidates.size() << " candidates available to choose from");
-    ns3::UniformVariable randomizer(0, candidates.size()-0.00001);
-    uint32_t selection = floor(randomizer.GetValue());
-    NS_ASSERT(selection < candidates.size());
-    uint32_t newIndex = candidates[selection];
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:ReSelectTransmissionSlotForReservationWithNo() newly reserved slot: " << newIndex);
+    m_candidates.clear();
+    m_allocated.clear();
+    numFree = ScanSlots(start % m_numSlots, std::min(count, m_numSlots), until, ns3::Seconds(0), &m_candidates, &m_allocated);
+
+    // 3) let the policy fill up the candidate set if needed and choose one of the candidates
+    uint32_t index = m_policy->SelectSlot(*this, m_position, m_candidates, m_allocated);
+    NS_ASSERT(index < m_numSlots);
+    m_statistics.candidateSetSizes[StdmaFrameStatistics::GetCandidateSetSizeBin(m_candidates.size())]++;
+    return index;
+  }
 
-    // 4a) mark this slot as internally allocated
-    ns3::Ptr<StdmaSlot> slot = m_slots[newIndex];
-    bool wasFree = slot->IsFree();
-    bool isSame = (oldIndex == newIndex);
-    slot->MarkAsInternallyAllocated(timeout);
-    NS_ASSERT(slot->IsInternallyAllocated());
-    NS_ASSERT(slot->GetInternalTimeout() == timeout);
-    m_slots[newIndex] = slot;
-    // 4b) and remember that we now introduced a collision with this node in case
-    //     this slot was already externally allocated
-    if (slot->IsAllocated())
+  bool
+  StdmaSlotManager::ReserveSlot(uint32_t n, uint32_t index, uint8_t timeout)
+  {
+    // a) mark this slot as internally allocated
+    StdmaSlot slot = GetSlot(index);
+    bool wasFree = slot.IsFree();
+    slot.MarkAsInternallyAllocated(timeout);
+    // b) and remember that we now introduced a collision with this node in case
+    //    this slot was already externally allocated
+    if (slot.IsAllocated())
       {
-        ns3::Mac48Address owner = slot->GetOwner();
-        m_collisions[owner] = newIndex;
+        ns3::Mac48Address owner = slot.GetOwner();
+        m_collisions[owner] = index;
       }
 
-    // 5) Save this slot also in the map of scheduled transmissions
-    m_selections[n] = slot;
-
-    // Trace this event...
-    m_reReservationTrace(candidates.size(), numFree, wasFree, isSame);
+    // c) Save this slot also in the map of scheduled transmissions
+    m_selections[n] = index;
+    return wasFree;
+  }
 
-    // 6) Return offset to previously reserved slot
-    return (newIndex - oldIndex) + m_numSlots;
+  uint32_t
+  StdmaSlotManager::GetSlotIndexOfReservationWithNo (uint32_t n)
+  {
+    std::map<uint32_t, uint32_t>::iterator it = m_selections.find(n);
+    NS_ASSERT(it != m_selections.end());
+    return it->second;
   }
 
   ns3::Time
@@ -723,10 +1035,10 @@ namespace stdma {
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetTimeUntilTransmissionOfReservationWithNo() last frame started at " << m_lastFrameStart);
     // ...determine the slot that is going to be used for this packet and derive the additional waiting time.
     NS_ASSERT(m_selections.find(n) != m_selections.end());
-    ns3::Ptr<StdmaSlot> slot = m_selections[n];
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetTimeUntilTransmissionOfReservationWithNo() slot chosen: " << slot->GetSlotIndex());
+    StdmaSlot slot = GetSlot(m_selections[n]);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetTimeUntilTransmissionOfReservationWithNo() slot chosen: " << slot.GetSlotIndex());
 
-    ns3::Time delayInFrame = ns3::NanoSeconds(slot->GetSlotIndex() * m_slotDuration.GetNanoSeconds());
+    ns3::Time delayInFrame = ns3::NanoSeconds(slot.GetSlotIndex() * m_slotDuration.GetNanoSeconds());
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetTimeUntilTransmissionOfReservationWithNo() delay within frame: " << delayInFrame.GetSeconds());
 
     // The result is then the starting time of the current frame plus the delay within the frame until the
@@ -743,8 +1055,9 @@ namespace stdma {
     	delay = m_lastFrameStart + delayInFrame - ns3::Simulator::Now();
       }
 
-    // In case we are calculating the scheduled time for a packet in the next frame, we have to add one frame duration
-    if (delay.IsNegative())
+    // In case we are calculating the scheduled time for a packet in the next frame, we have to add one frame duration.
+    // This includes the slot we are in right now, which is the case for a report rate of one.
+    if (!delay.IsStrictlyPositive())
       {
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetTimeUntilTransmissionOfReservationWithNo() slot is in next frame, will add one frame duration to correct for that");
         delay += m_frameDuration;
@@ -779,6 +1092,44 @@ namespace stdma {
     return (withinFrame / m_slotDuration.GetNanoSeconds());
   }
 
+  uint32_t
+  StdmaSlotManager::GetCurrentSlotIndex ()
+  {
+    if (m_clock == 0)
+      {
+        return GetSlotIndexForTimestamp(ns3::Simulator::Now());
+      }
+    return GetSlotIndexForGlobalSlot(m_clock->GetCurrentSlot());
+  }
+
+  uint32_t
+  StdmaSlotManager::GetSlotIndexForGlobalSlot (uint64_t slot)
+  {
+    // Update the slot reservation / observation / allocation status at the beginning
+    // of each new frame
+    if (ns3::Simulator::Now() >= m_lastFrameStart + m_frameDuration)
+      {
+        UpdateSlotObservations();
+      }
+
+    // Within the current frame (the common case) no division is needed
+    if (slot >= m_lastFrameStartSlot && slot < m_lastFrameStartSlot + m_numSlots)
+      {
+        return slot - m_lastFrameStartSlot;
+      }
+    // Same convention as GetSlotIndexForTimestamp(): slots prior to the last frame start are counted from m_start
+    uint64_t base = (slot >= m_lastFrameStartSlot) ? m_lastFrameStartSlot : m_start.GetNanoSeconds() / m_slotDuration.GetNanoSeconds();
+    NS_ASSERT(slot >= base);
+    return (slot - base) % m_numSlots;
+  }
+
+  void
+  StdmaSlotManager::SetSlotClock (ns3::Ptr<StdmaSlotClock> clock)
+  {
+    NS_ASSERT(clock->GetSlotDuration() == m_slotDuration);
+    m_clock = clock;
+  }
+
   uint64_t
   StdmaSlotManager::GetGlobalSlotIndexForTimestamp(ns3::Time t)
   {
@@ -801,20 +1152,20 @@ namespace stdma {
     if (k == l) return 0;
     NS_ASSERT(m_selections.find(k) != m_selections.end());
     NS_ASSERT(m_selections.find(l) != m_selections.end());
-    ns3::Ptr<StdmaSlot> first = m_selections[k];
-    ns3::Ptr<StdmaSlot> second = m_selections[l];
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:CalculateSlotOffsetBetweenTransmissions() first  = " << first->GetSlotIndex());
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:CalculateSlotOffsetBetweenTransmissions() second = " << second->GetSlotIndex());
+    StdmaSlot first = GetSlot(m_selections[k]);
+    StdmaSlot second = GetSlot(m_selections[l]);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:CalculateSlotOffsetBetweenTransmissions() first  = " << first.GetSlotIndex());
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:CalculateSlotOffsetBetweenTransmissions() second = " << second.GetSlotIndex());
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:CalculateSlotOffsetBetweenTransmissions() numSlots = " << m_numSlots);
-    if (second->GetSlotIndex() > first->GetSlotIndex())
+    if (second.GetSlotIndex() > first.GetSlotIndex())
       {
-        return second->GetSlotIndex() - first->GetSlotIndex();
+        return second.GetSlotIndex() - first.GetSlotIndex();
       }
     else
       {
-        uint32_t remaining = (m_numSlots - first->GetSlotIndex());
+        uint32_t remaining = (m_numSlots - first.GetSlotIndex());
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:CalculateSlotOffsetBetweenTransmissions() remaining = " << remaining);
-        return (remaining + second->GetSlotIndex());
+        return (remaining + second.GetSlotIndex());
       }
   }
 
@@ -831,7 +1182,7 @@ namespace stdma {
       }
 
     // If the internal timeout of this slot is zero (or less), we need to perform a re-reservation
-    if (m_selections[n]->GetInternalTimeout() <= 0)
+    if (GetSlot(m_selections[n]).GetInternalTimeout() <= 0)
       {
         return true;
       }
@@ -846,15 +1197,15 @@ namespace stdma {
   {
     NS_LOG_FUNCTION (n);
     NS_ASSERT(m_selections.find(n) != m_selections.end());
-    NS_LOG_DEBUG("isAllocated: " << m_selections[n]->IsAllocated());
-    NS_LOG_DEBUG("isInternallyAllocated: " << m_selections[n]->IsInternallyAllocated());
-    NS_LOG_DEBUG("isBusy: " << m_selections[n]->IsBusy());
-    NS_LOG_DEBUG("isFree: " << m_selections[n]->IsFree());
-    NS_LOG_DEBUG("internal timeout: " << (uint32_t) m_selections[n]->GetInternalTimeout());
-    NS_LOG_DEBUG("external timeout: " << (uint32_t) m_selections[n]->GetTimeout());
-    NS_LOG_DEBUG("id: " << (uint32_t) m_selections[n]->GetSlotIndex());
-    NS_ASSERT(m_selections[n]->IsInternallyAllocated());
-    NS_ASSERT(m_selections[n]->GetInternalTimeout() > 0);
+    NS_LOG_DEBUG("isAllocated: " << GetSlot(m_selections[n]).IsAllocated());
+    NS_LOG_DEBUG("isInternallyAllocated: " << GetSlot(m_selections[n]).IsInternallyAllocated());
+    NS_LOG_DEBUG("isBusy: " << GetSlot(m_selections[n]).IsBusy());
+    NS_LOG_DEBUG("isFree: " << GetSlot(m_selections[n]).IsFree());
+    NS_LOG_DEBUG("internal timeout: " << (uint32_t) GetSlot(m_selections[n]).GetInternalTimeout());
+    NS_LOG_DEBUG("external timeout: " << (uint32_t) GetSlot(m_selections[n]).GetTimeout());
+    NS_LOG_DEBUG("id: " << (uint32_t) GetSlot(m_selections[n]).GetSlotIndex());
+    NS_ASSERT(GetSlot(m_selections[n]).IsInternallyAllocated());
+    NS_ASSERT(GetSlot(m_selections[n]).GetInternalTimeout() > 0);
 
     // Update the slot reservation / observation / allocation status at the beginning
     // of each new frame
@@ -864,9 +1215,8 @@ namespace stdma {
       }
 
     // Update the timeout
-    uint8_t newValue = m_selections[n]->GetInternalTimeout() - 1;
-    m_slots[m_selections[n]->GetSlotIndex()]->SetInternalTimeout(newValue);
-    m_selections[n]->SetInternalTimeout(newValue);
+    uint8_t newValue = GetSlot(m_selections[n]).GetInternalTimeout() - 1;
+    GetSlot(m_selections[n]).SetInternalTimeout(newValue);
 
     return newValue;
   }
@@ -880,7 +1230,14 @@ namespace stdma {
   void
   StdmaSlotManager::MarkSlotAsAllocated(uint32_t index, uint8_t timeout, ns3::Mac48Address node, ns3::Vector position, ns3::Time notbefore)
   {
-    NS_LOG_FUNCTION(index << (uint32_t) timeout << position);
+    MarkSlotAsAllocated(index, timeout, node, position, notbefore, std::numeric_limits<double>::quiet_NaN());
+  }
+
+  void
+  StdmaSlotManager::MarkSlotAsAllocated(uint32_t index, uint8_t timeout, ns3::Mac48Address node, ns3::Vector position, ns3::Time notbefore,
+                                        double rxPowerDbm)
+  {
+    NS_LOG_FUNCTION(index << (uint32_t) timeout << position << rxPowerDbm);
 
     // Update the slot reservation / observation / allocation status at the beginning
     // of each new frame
@@ -889,76 +1246,204 @@ namespace stdma {
         UpdateSlotObservations();
       }
 
-    NS_ASSERT(m_slots.find(index) != m_slots.end());
-    m_slots[index]->MarkAsAllocated(timeout, node, position, notbefore);
+    NS_ASSERT(index < m_numSlots);
+    GetSlot(index).MarkAsAllocated(timeout, node, position, notbefore, rxPowerDbm);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:MarkSlotAsAllocated() marked slot " << index
-        << " as allocated (notBefore = " << notbefore.GetSeconds() << "), has current timeout value of " << (uint32_t) m_slots[index]->GetTimeout());
+        << " as allocated (notBefore = " << notbefore.GetSeconds() << "), has current timeout value of " << (uint32_t) GetSlot(index).GetTimeout());
   }
 
   void
   StdmaSlotManager::UpdateSlotObservations()
   {
     NS_LOG_FUNCTION_NOARGS();
-    m_lastFrameStart += m_frameDuration;
+    // A station that has not been active for a while may have missed several frame boundaries
+    uint64_t elapsed = (ns3::Simulator::Now() - m_lastFrameStart).GetNanoSeconds();
+    UpdateSlotObservations(elapsed / m_frameDuration.GetNanoSeconds());
+  }
+
+  void
+  StdmaSlotManager::UpdateSlotObservations(uint32_t frames)
+  {
+    NS_LOG_FUNCTION(frames);
+    if (frames > 0)
+      {
+        // Complete the statistics of the frame that has just ended before any of its slots expire
+        CountSlots(m_statistics);
+        m_lastStatistics = m_statistics;
+        m_statistics = StdmaFrameStatistics();
+        m_frameStatisticsTrace(m_lastStatistics);
+      }
+    m_lastFrameStart += ns3::NanoSeconds(frames * m_frameDuration.GetNanoSeconds());
+    m_lastFrameStartSlot += (uint64_t) frames * m_numSlots;
+    m_frame += frames;
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() called at node " << ns3::Simulator::GetContext() << " at " << ns3::Simulator::Now().GetSeconds());
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() m_lastFrameStart is now: " << m_lastFrameStart);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() m_lastFrameStart is now: " << m_lastFrameStart << " (frame " << m_frame << ")");
 
-    // Iterate over all slots and update their status
-    for (uint32_t i = 0; i < m_slots.size(); i++)
+    // External allocations and busy slots expire lazily (see RefreshSlot). Internally allocated slots
+    // are all referenced by a reservation, so we only iterate over these.
+    std::map<uint32_t, uint32_t>::iterator it;
+    for (it = m_selections.begin(); it != m_selections.end(); ++it)
       {
+        uint32_t i = it->second;
         // If this slot is marked as internally allocated, but has an internal timeout value equal or less than zero,
         // we can free this slot
-        if (m_slots[i]->IsInternallyAllocated() && m_slots[i]->GetInternalTimeout() <= 0)
+        if (m_slotInternal[i] && m_slotInternalTimeout[i] <= 0)
           {
             // But before we release check whether we introduced a collision on this slot, because if we need
             // to remove the initial owner from our memory
-            if (m_slots[i]->IsAllocated())
+            if (GetSlot(i).IsAllocated())
               {
-                ns3::Mac48Address owner = m_slots[i]->GetOwner();
+                ns3::Mac48Address owner = m_slotOwner[i];
                 NS_ASSERT(m_collisions.find(owner) != m_collisions.end());
                 m_collisions.erase(owner);
                 NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() --> slot " << i << " had been shared with node at " << owner << ", hence we can forget "
                     "about it now.");
               }
-            m_slots[i]->MarkAsFree();
+            GetSlot(i).MarkAsFree();
             NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() --> marking slot " << i << " as FREE again (was internally allocated before)");
           }
+      }
+  }
+
+  void
+  StdmaSlotManager::RefreshSlot(uint32_t index)
+  {
+    // Internally allocated slots keep their external state until they are released by us
+    if (m_slotState[index] != StdmaSlot::FREE && !m_slotInternal[index] && m_slotExpiry[index] <= m_frame)
+      {
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:RefreshSlot() --> marking slot " << index << " as FREE again (expired in frame " << m_slotExpiry[index] << ")");
+        GetSlot(index).MarkAsFree();
+      }
+  }
+
+  uint32_t
+  StdmaSlotManager::GetFrameNumberBefore(ns3::Time t)
+  {
+    if (t <= m_lastFrameStart)
+      {
+        return m_frame;
+      }
+    uint64_t elapsed = (t - m_lastFrameStart).GetNanoSeconds() - 1;
+    return m_frame + (elapsed / m_frameDuration.GetNanoSeconds());
+  }
+
+  void
+  StdmaSlotManager::UpdateSlotIndex(uint32_t index)
+  {
+    uint8_t state = m_slotState[index];
+    bool internal = m_slotInternal[index];
+    AssignBit(m_freeSlots, index, state == StdmaSlot::FREE);
+    AssignBit(m_allocatedSlots, index, state == StdmaSlot::ALLOCATED);
+    AssignBit(m_internalSlots, index, internal);
+    AssignBit(m_deferredSlots, index, state != StdmaSlot::FREE && m_slotPreviousState[index] == StdmaSlot::FREE
+                                      && m_slotNotBefore[index].IsStrictlyPositive());
+    if (state != StdmaSlot::FREE && !internal)
+      {
+        uint32_t word = index / 64;
+        m_wordExpiry[word] = std::min(m_wordExpiry[word], m_slotExpiry[index]);
+      }
+  }
 
-        // If this slot had been allocated by an external station, either decrease the timeout value of
-        // this slot or mark it as free again
-        if (m_slots[i]->IsAllocated() && !m_slots[i]->IsInternallyAllocated())
+  void
+  StdmaSlotManager::RefreshSlotWord(uint32_t word)
+  {
+    if (m_wordExpiry[word] > m_frame)
+      {
+        return;
+      }
+    // At least one slot within this word may have expired, check all of them that are not free and
+    // remember when the next one of the remaining ones is going to expire
+    uint32_t next = std::numeric_limits<uint32_t>::max();
+    uint64_t used = ~m_freeSlots[word];
+    if (word == m_freeSlots.size() - 1 && m_numSlots % 64 != 0)
+      {
+        used &= GetBitRange(0, (m_numSlots % 64) - 1);
+      }
+    while (used != 0)
+      {
+        uint32_t i = word * 64 + __builtin_ctzll(used);
+        used &= used - 1;
+        RefreshSlot(i);
+        if (m_slotState[i] != StdmaSlot::FREE && !m_slotInternal[i])
           {
-            if (m_slots[i]->GetTimeout() > 0)
-              {
-                uint8_t newValue = m_slots[i]->GetTimeout() - 1;
-                m_slots[i]->SetTimeout(newValue);
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() --> reducing timeout of slot " << i << " to " << (uint32_t) newValue);
-              }
-            else
-              {
-                m_slots[i]->MarkAsFree();
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() --> marking slot " << i << " as FREE again (was externally allocated before)");
-              }
+            next = std::min(next, m_slotExpiry[i]);
           }
+      }
+    m_wordExpiry[word] = next;
+  }
 
-        // Handle the slots that are busy correctly and count their timeout down properly
-        // If the timeout is zero or less, then we can mark them as free again (because we will set
-        // a timeout value of 1 every time the slot is detected CCS busy)
-        if (m_slots[i]->IsBusy() && !m_slots[i]->IsInternallyAllocated())
+  uint32_t
+  StdmaSlotManager::ScanSlots(uint32_t start, uint32_t count, ns3::Time untilBase, ns3::Time untilStep,
+                              std::vector<uint32_t> *free, std::vector<uint32_t> *allocated)
+  {
+    NS_ASSERT(start < m_numSlots);
+    NS_ASSERT(count <= m_numSlots);
+    uint32_t numFree = 0;
+    uint32_t offset = 0;
+    // The range consists of at most two contiguous segments: up to the end of the frame, and from the
+    // beginning of the frame on
+    while (offset < count)
+      {
+        uint32_t first = start + offset;
+        if (first >= m_numSlots)
           {
-            if (m_slots[i]->GetTimeout() > 0)
+            first -= m_numSlots;
+          }
+        uint32_t last = std::min(first + (count - offset), m_numSlots) - 1;
+        for (uint32_t word = first / 64; word <= last / 64; word++)
+          {
+            uint32_t base = word * 64;
+            uint64_t mask = GetBitRange(std::max(first, base) - base, std::min(last, base + 63) - base);
+            RefreshSlotWord(word);
+            uint64_t freeBits = m_freeSlots[word] & mask;
+
+            // Slots that are only allocated from notBefore on and have been free before are still free
+            // for reservations that end before
+            uint64_t deferred = m_deferredSlots[word] & mask & ~freeBits;
+            while (deferred != 0)
               {
-                uint8_t newValue = m_slots[i]->GetTimeout() - 1;
-                m_slots[i]->SetTimeout(newValue);
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() --> reducing timeout of BUSY slot " << i << " to " << (uint32_t) newValue);
+                uint32_t bit = __builtin_ctzll(deferred);
+                deferred &= deferred - 1;
+                uint32_t i = base + bit;
+                ns3::Time until = untilBase + ns3::NanoSeconds(untilStep.GetNanoSeconds() * (offset + i - first));
+                if (until < m_slotNotBefore[i])
+                  {
+                    freeBits |= ((uint64_t) 1) << bit;
+                  }
+              }
+
+            if (free == 0)
+              {
+                numFree += __builtin_popcountll(freeBits);
               }
             else
               {
-                m_slots[i]->MarkAsFree();
-                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:UpdateSlotObservations() --> marking slot " << i << " as FREE again (was busy before)");
+                uint64_t bits = freeBits;
+                while (bits != 0)
+                  {
+                    free->push_back(base + __builtin_ctzll(bits));
+                    bits &= bits - 1;
+                    numFree++;
+                  }
+              }
+
+            if (allocated != 0)
+              {
+                uint64_t bits = m_allocatedSlots[word] & ~m_internalSlots[word] & mask & ~freeBits;
+                while (bits != 0)
+                  {
+                    uint32_t i = base + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    if (ns3::Simulator::Now() >= m_slotNotBefore[i])
+                      {
+                        allocated->push_back(i);
+                      }
+                  }
               }
           }
+        offset += last - first + 1;
       }
+    return numFree;
   }
 
   void
@@ -973,8 +1458,8 @@ namespace stdma {
         UpdateSlotObservations();
       }
 
-    NS_ASSERT(m_slots.find(index) != m_slots.end());
-    m_slots[index]->MarkAsFree();
+    NS_ASSERT(index < m_numSlots);
+    GetSlot(index).MarkAsFree();
   }
 
   void
@@ -989,8 +1474,66 @@ namespace stdma {
         UpdateSlotObservations();
       }
 
-    NS_ASSERT(m_slots.find(index) != m_slots.end());
-    m_slots[index]->MarkAsBusy();
+    NS_ASSERT(index < m_numSlots);
+    GetSlot(index).MarkAsBusy();
+  }
+
+  void
+  StdmaSlotManager::MarkSlotRangeAsBusy(uint32_t first, uint32_t count)
+  {
+    NS_LOG_FUNCTION(this << first << count);
+
+    // Update the slot reservation / observation / allocation status at the beginning
+    // of each new frame
+    if (ns3::Simulator::Now() >= m_lastFrameStart + m_frameDuration)
+      {
+        UpdateSlotObservations();
+      }
+
+    NS_ASSERT(first < m_numSlots);
+    count = std::min(count, m_numSlots);
+    if (count == 0)
+      {
+        return;
+      }
+    if (first + count <= m_numSlots)
+      {
+        MarkSlotSegmentAsBusy(first, first + count - 1);
+      }
+    else
+      {
+        MarkSlotSegmentAsBusy(first, m_numSlots - 1);
+        MarkSlotSegmentAsBusy(0, first + count - m_numSlots - 1);
+      }
+  }
+
+  void
+  StdmaSlotManager::MarkSlotSegmentAsBusy(uint32_t first, uint32_t last)
+  {
+    // Expired slots have to be freed first, since their previous state is recorded below
+    for (uint32_t w = first / 64; w <= last / 64; w++)
+      {
+        RefreshSlotWord(w);
+      }
+
+    // Same transition as StdmaSlot::MarkAsBusy(), but applied to the whole segment at once
+    uint32_t expiry = m_frame + 2;
+    std::copy(m_slotState.begin() + first, m_slotState.begin() + last + 1, m_slotPreviousState.begin() + first);
+    std::fill(m_slotState.begin() + first, m_slotState.begin() + last + 1, (uint8_t) StdmaSlot::BUSY);
+    std::fill(m_slotNotBefore.begin() + first, m_slotNotBefore.begin() + last + 1, ns3::Seconds(0));
+    std::fill(m_slotExpiry.begin() + first, m_slotExpiry.begin() + last + 1, expiry);
+
+    // Busy slots are neither free, allocated nor deferred, but may still be internally allocated
+    for (uint32_t w = first / 64; w <= last / 64; w++)
+      {
+        uint32_t from = (w == first / 64) ? first % 64 : 0;
+        uint32_t to = (w == last / 64) ? last % 64 : 63;
+        uint64_t mask = GetBitRange(from, to);
+        m_freeSlots[w] &= ~mask;
+        m_allocatedSlots[w] &= ~mask;
+        m_deferredSlots[w] &= ~mask;
+        m_wordExpiry[w] = std::min(m_wordExpiry[w], expiry);
+      }
   }
 
   void
@@ -1008,39 +1551,29 @@ namespace stdma {
     // Step 1: Calculate the number of slots that have passed since last frame start
     //         That means: all slot indices have to be reduced by this number
     uint32_t offset = baseTime.GetNanoSeconds() / m_slotDuration.GetNanoSeconds();
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:RebaseFrameStart() applying offset of " << (offset) << " to all " << m_slots.size() << " slots.");
-
-    // Step 2: Adjust the slots IDs of all slot objects accordingly
-    std::vector<ns3::Ptr<StdmaSlot> > newOrder;
-    for (uint32_t i = 0; i < m_slots.size(); i++)
-      {
-        ns3::Ptr<StdmaSlot> slot = m_slots[i];
-        uint32_t newIndex;
-        if (slot->GetSlotIndex() < offset)
-          {
-            newIndex = m_numSlots - offset + slot->GetSlotIndex();
-          }
-        else
-          {
-            newIndex = slot->GetSlotIndex() - offset;
-          }
-        slot->RebaseIndex(newIndex);
-        newOrder.push_back(slot);
-      }
-    m_slots.clear();
-
-    // Re-insert the slots into the m_slots map
-    for (uint32_t i = 0; i < newOrder.size(); i++)
-      {
-        ns3::Ptr<StdmaSlot> slot = newOrder.at(i);
-        m_slots[slot->GetSlotIndex()] = slot;
-      }
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:RebaseFrameStart() applying offset of " << (offset) << " to all " << m_numSlots << " slots.");
+
+    // Step 2: Rotate the reservation table accordingly, such that the slot with the old index
+    //         'offset' becomes the slot with the new index 0
+    std::rotate(m_slotState.begin(), m_slotState.begin() + offset, m_slotState.end());
+    std::rotate(m_slotPreviousState.begin(), m_slotPreviousState.begin() + offset, m_slotPreviousState.end());
+    std::rotate(m_slotInternal.begin(), m_slotInternal.begin() + offset, m_slotInternal.end());
+    std::rotate(m_slotExpiry.begin(), m_slotExpiry.begin() + offset, m_slotExpiry.end());
+    std::rotate(m_slotInternalTimeout.begin(), m_slotInternalTimeout.begin() + offset, m_slotInternalTimeout.end());
+    std::rotate(m_slotNotBefore.begin(), m_slotNotBefore.begin() + offset, m_slotNotBefore.end());
+    std::rotate(m_slotOwner.begin(), m_slotOwner.begin() + offset, m_slotOwner.end());
+    std::rotate(m_slotPosition.begin(), m_slotPosition.begin() + offset, m_slotPosition.end());
+    std::rotate(m_slotRxPower.begin(), m_slotRxPower.begin() + offset, m_slotRxPower.end());
+
+    //         and rebuild the slot indices from scratch
+    RebuildSlotIndices();
 
     // Step 3: Save the new m_lastFrameStart time stamp
     m_lastFrameStart = now;
+    m_lastFrameStartSlot = now.GetNanoSeconds() / m_slotDuration.GetNanoSeconds();
   }
 
-  ns3::Ptr<RandomAccessDetails>
+  RandomAccessDetails
   StdmaSlotManager::GetNetworkEntryTimestamp(uint32_t remainingSlots, double p)
   {
     NS_LOG_FUNCTION(this << remainingSlots << p);
@@ -1053,55 +1586,40 @@ namespace stdma {
       }
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() current global slot id = " << GetGlobalSlotIndexForTimestamp(ns3::Simulator::Now()));
 
-    ns3::UniformVariable randomizer(0, 1);
-    ns3::Ptr<RandomAccessDetails> details = ns3::Create<RandomAccessDetails>();
+    RandomAccessDetails details;
 
-    double randomValue = randomizer.GetValue();
+    double randomValue = m_networkEntryRng->GetValue(0, 1);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() randomValue = " << randomValue);
 
-    std::vector<uint32_t> candidates;
+    // The scratch buffers are reused across attempts, such that repeated network entries do not allocate
+    m_candidates.clear();
     uint32_t start = GetSlotIndexForTimestamp(ns3::Simulator::Now());
-    uint32_t end = start + remainingSlots;
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() start = " << start);
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() end = " << end);
-    for (uint32_t i = start; i < end; i++)
-      {
-        NS_ASSERT(m_slots.find(i) != m_slots.end());
-        NS_ASSERT(m_slots[i]->GetSlotIndex() == i);
-        ns3::Time until = ns3::Simulator::Now() + ns3::Seconds((i-start+1) * m_slotDuration.GetSeconds());
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() remaining = " << remainingSlots);
+    m_allocated.clear();
+    ScanSlots(start, std::min(remainingSlots, m_numSlots), ns3::Simulator::Now() + m_slotDuration, m_slotDuration, &m_candidates, &m_allocated);
 
-        if (m_slots[i]->IsFree(until))
+    // If up to now no free slot is available we will reuse the allocated slot whose owner is farthest away
+    if (m_candidates.size() < 1)
+      {
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << "StdmaSlotManager:GetNetworkEntryTimestamp() has to add one already allocated slot");
+        NS_ASSERT(!m_allocated.empty());
+        uint32_t index = m_allocated[0];
+        double farthest = -1;
+        for (std::vector<uint32_t>::iterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
           {
-            candidates.push_back(i);
+            double distance = ns3::CalculateDistance(m_slotPosition[*it], m_position);
+            if (distance >= farthest)
+              {
+                farthest = distance;
+                index = *it;
+              }
           }
-      }
-
-    // If up to now no free slot is available we will reuse an allocated slot
-    if (candidates.size() < 1)
-      {
-    	NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << "StdmaSlotManager:GetNetworkEntryTimestamp() has to add one already allocated slot");
-    	std::map<double, uint32_t> usedSlots;
-    	for (uint32_t i = start; i < end; i++)
-    	  {
-    		if (m_slots[i]->IsAllocated())
-    		  {
-    			ns3::Vector owner = m_slots[i]->GetPosition();
-    			ns3::Vector myself = ns3::NodeList::GetNode(ns3::Simulator::GetContext())->GetObject<ns3::MobilityModel>()->GetPosition();
-    			double distance = ns3::CalculateDistance(owner, myself);
-    			while (usedSlots.find(distance) != usedSlots.end())
-    			  {
-    				distance += 0.000001;
-    			  }
-    			usedSlots[distance] = m_slots[i]->GetSlotIndex();
-    		  }
-    	  }
-    	std::map<double, uint32_t>::reverse_iterator it = usedSlots.rbegin();
-    	uint32_t index = it->second;
-    	candidates.push_back(index);
+        m_candidates.push_back(index);
       }
 
     // Calculate the probability value that has to be met in order to transmit in the next slot
-    uint32_t n = candidates.size();
+    uint32_t n = m_candidates.size();
     uint32_t no = 0;
     double prob = p; // 1.0 / n;
     double incr = 0;
@@ -1118,7 +1636,7 @@ namespace stdma {
     // candidate slot
     while (randomValue > prob && no < (n-1))
       {
-        randomValue = randomizer.GetValue();
+        randomValue = m_networkEntryRng->GetValue(0, 1);
         no++;
         prob += incr;
         NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() no = " << no << ", prob = " << prob
@@ -1130,19 +1648,19 @@ namespace stdma {
       }
 
     // Okay, we identified the candidate slot in which we will perform network entry
-    uint32_t slotIndex = candidates.at(no);
+    uint32_t slotIndex = m_candidates.at(no);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() slotIndex = " << slotIndex);
-    uint32_t slotoffset = (slotIndex - start);
+    uint32_t slotoffset = (slotIndex + m_numSlots - start) % m_numSlots;
     ns3::Time delay = ns3::NanoSeconds(slotoffset * m_slotDuration.GetNanoSeconds());
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() offset to selected slot is " << slotoffset);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() delay until selected slot is " << delay.GetSeconds());
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() timestamp is " << (ns3::Simulator::Now() + delay));
 
     // Set the information in the result object
-    details->SetProbability(prob);
-    details->SetRemainingSlots(remainingSlots - (slotIndex-start));
-    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() remaining slots = " << details->GetRemainingSlots());
-    details->SetWhen(ns3::Simulator::Now() + delay);
+    details.SetProbability(prob);
+    details.SetRemainingSlots(remainingSlots - slotoffset);
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:GetNetworkEntryTimestamp() remaining slots = " << details.GetRemainingSlots());
+    details.SetWhen(ns3::Simulator::Now() + delay);
 
     return details;
   }
@@ -1151,18 +1669,7 @@ namespace stdma {
   StdmaSlotManager::HasFreeSlotsLeft(uint32_t remainingSlots)
   {
     uint32_t start = GetSlotIndexForTimestamp(ns3::Simulator::Now());
-    uint32_t i = start;
-    uint32_t end = start + remainingSlots;
-    while (i < end)
-      {
-        ns3::Time until = ns3::Simulator::Now() + ns3::Seconds((i-start+1) * m_slotDuration.GetSeconds());
-        if (m_slots[i]->IsFree(until))
-          {
-            return true;
-          }
-	i++;
-      }
-    return false;
+    return ScanSlots(start, std::min(remainingSlots, m_numSlots), ns3::Simulator::Now() + m_slotDuration, m_slotDuration, 0, 0) > 0;
   }
 
   bool
@@ -1180,15 +1687,21 @@ namespace stdma {
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:IsCurrentSlotStillFree() m_lastFrameStart = " << m_lastFrameStart);
     NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaSlotManager:IsCurrentSlotStillFree() index = " << index);
     NS_ASSERT(index >= 0);
-    NS_ASSERT(index < m_slots.size());
-    return m_slots[index]->IsFree(ns3::Simulator::Now() + m_slotDuration);
+    NS_ASSERT(index < m_numSlots);
+    return GetSlot(index).IsFree(ns3::Simulator::Now() + m_slotDuration);
   }
 
-  ns3::Ptr<StdmaSlot>
+  StdmaSlot
   StdmaSlotManager::GetSlot(uint32_t index)
   {
-    NS_ASSERT(m_slots.find(index) != m_slots.end());
-    return m_slots[index];
+    NS_ASSERT(index < m_numSlots);
+    return StdmaSlot(this, index);
+  }
+
+  bool
+  StdmaSlotManager::HasCollisionWith(ns3::Mac48Address owner)
+  {
+    return m_collisions.find(owner) != m_collisions.end();
   }
 
 }
@@ -27,13 +27,21 @@
 #include "ns3/vector.h"
 #include "ns3/traced-callback.h"
 #include "ns3/mac48-address.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "stdma-slot-selection-policy.h"
+#include "stdma-slot-clock.h"
+#include "stdma-snapshot.h"
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace stdma {
 
-/**
+  class StdmaSlotManager;
+
+  /**
    * \brief Single slot that is managed by the StdmaSlotManager
    *
    * This class implements the logic / state of a single STDMA slot. A slot can either be free, busy or allocated, whereas
@@ -52,9 +60,15 @@ namespace stdma {
    * as follows (from lowest to highest): free, busy, allocated, and a state can only be overwritten if the new state is of
    * higher priority.
    *
+   * The slot itself does not own any state: it is a lightweight view (slot manager plus slot index) onto the reservation
+   * table of the StdmaSlotManager, which stores the state of all slots of a frame in contiguous arrays. A view is cheap to
+   * copy and should be passed around by value. It remains valid as long as the slot manager it refers to exists, but it
+   * refers to a slot index and not to a particular slot, i.e. after StdmaSlotManager::RebaseFrameStart it refers to a
+   * different slot.
+   *
    * * \ingroup stdma
    */
-  class StdmaSlot : public ns3::Object {
+  class StdmaSlot {
 
   public:
 
@@ -65,8 +79,7 @@ namespace stdma {
                         // was above the clear channel assignment (CCA)threshold
     };
 
-    StdmaSlot (uint32_t index);
-    virtual ~StdmaSlot();
+    StdmaSlot (StdmaSlotManager *manager, uint32_t index);
 
     StdmaSlot::State GetState();
     bool IsInternallyAllocated();
@@ -75,11 +88,11 @@ namespace stdma {
     bool IsFree();
     bool IsFree(ns3::Time until);
     void MarkAsAllocated(uint8_t timeout, ns3::Mac48Address owner, ns3::Vector position, ns3::Time notBefore);
+    void MarkAsAllocated(uint8_t timeout, ns3::Mac48Address owner, ns3::Vector position, ns3::Time notBefore, double rxPowerDbm);
     bool IsAllocated();
     void MarkAsInternallyAllocated(uint8_t timeout);
     void MarkAsBusy();
     bool IsBusy();
-    void RebaseIndex(uint32_t index);
 
     uint32_t GetSlotIndex();
     void SetTimeout(uint8_t t);
@@ -88,35 +101,38 @@ namespace stdma {
     uint8_t GetInternalTimeout();
     ns3::Vector GetPosition();
     ns3::Mac48Address GetOwner();
+    /**
+     * @return Whether the power at which the last transmission of the owner has been received is known
+     */
+    bool HasRxPower();
+    /**
+     * @return The power (in dBm) at which the last transmission of the owner has been received
+     */
+    double GetRxPower();
 
   private:
 
-    bool m_internal;
-    State m_state;
-    State m_previousState;
-    uint8_t m_timeout;
-    uint8_t m_internalTimeout;
+    StdmaSlotManager *m_manager;
     uint32_t m_index;
-    ns3::Vector m_position;
-    ns3::Mac48Address m_owner;
-    ns3::Time m_notBefore;
 
   };
 
-  class RandomAccessDetails : public ns3::Object {
+  /**
+   * \brief Outcome of a network entry (RA-TDMA) slot selection, returned by value
+   */
+  class RandomAccessDetails {
 
     public:
 
       RandomAccessDetails ();
-      virtual ~RandomAccessDetails();
 
       void SetWhen (ns3::Time when);
       void SetProbability (double p);
       void SetRemainingSlots (uint16_t left);
 
-      ns3::Time GetWhen();
-      double GetProbability();
-      uint16_t GetRemainingSlots();
+      ns3::Time GetWhen() const;
+      double GetProbability() const;
+      uint16_t GetRemainingSlots() const;
 
     private:
 
@@ -126,6 +142,38 @@ namespace stdma {
 
     };
 
+  /**
+   * \brief Counters that describe the channel load and the reservation activity of a station within one frame
+   *
+   * The slot counts partition the frame: slots reserved by the station itself are counted as internal, all
+   * other slots according to their (external) state. The reservation counters and the candidate set size
+   * histogram cover all slot selections of the frame, i.e. first reservations (including those made when the
+   * report rate changes) and re-reservations. Bin b of the histogram counts candidate sets of a size within
+   * [2^b, 2^(b+1)), where bin 0 also counts empty sets and the last bin is open-ended.
+   */
+  struct StdmaFrameStatistics
+  {
+    static const uint32_t HISTOGRAM_BINS = 8;
+
+    StdmaFrameStatistics ();
+
+    /**
+     * @param size The size of a candidate set
+     * @return The histogram bin the size is counted in
+     */
+    static uint32_t GetCandidateSetSizeBin (uint32_t size);
+
+    uint32_t frame;                     // Number of the frame, counted from the first frame
+    uint32_t freeSlots;
+    uint32_t busySlots;
+    uint32_t allocatedSlots;            // Externally allocated slots, shared ones are counted as internal
+    uint32_t internalSlots;
+    uint32_t collisions;                // Slots we share with another station on purpose
+    uint32_t reservations;
+    uint32_t reReservations;
+    uint32_t candidateSetSizes[HISTOGRAM_BINS];
+  };
+
   /**
    * \brief The slot manager of a STDMA-based medium access control layer.
    *
@@ -196,6 +244,20 @@ namespace stdma {
      */
     void SetMinimumCandidateSlotSetSize (uint32_t size);
 
+    /**
+     * Sets the position of the station that is used to rank externally allocated slots by the distance to their
+     * owners. The position is a snapshot that is expected to be updated by the MAC layer before each round of
+     * slot reservations, i.e. the slot manager does not track the mobility of the station itself.
+     *
+     * @param position The current position of the station
+     */
+    void SetPosition (ns3::Vector position);
+
+    /**
+     * @return The minimum number of candidate slots required before randomly choosing one of them
+     */
+    uint32_t GetMinimumCandidateSlotSetSize ();
+
     /**
      * Sets the size of the selection interval relative to the size of the nominal increment (NI),
      * such that the number of slots in the interval [NS-SI/2, NS+SI/2] equals ceil(NI*ratio)
@@ -204,6 +266,14 @@ namespace stdma {
      */
     void SetSelectionIntervalRatio(double ratio);
 
+    /**
+     * Assigns a fixed random variable stream number to the random variables used by this slot manager
+     *
+     * @param stream The first stream index to use
+     * @return The number of stream indices assigned
+     */
+    int64_t AssignStreams (int64_t stream);
+
     /**
      * This method should be called only once, according to the standard during network entry. It is responsible
      * for the selection of the nominal start slots, which pre-determine the location of the selection intervals
@@ -218,6 +288,64 @@ namespace stdma {
      */
     uint32_t GetCurrentReservationNo();
 
+    /**
+     * Changes the report rate of a station that has already completed its first frame. The nominal slots are
+     * re-anchored at the slot of the reservation that is about to be transmitted, which becomes reservation 0
+     * and keeps its slot. For every other new nominal slot the closest existing reservation within the new
+     * selection interval is kept, remaining reservations are released and missing ones are selected from the
+     * candidate set of their selection interval. Afterwards, the current reservation number points to the
+     * anchor again, such that the following call of GetCurrentReservationNo() returns 0 and the offset announced
+     * for the current transmission refers to the slot of reservation 1 already.
+     *
+     * @param rate The new report rate, i.e. the number of reservations per frame
+     * @param timeout The number of frames newly selected reservations shall be kept
+     */
+    void ChangeReportRate(uint32_t rate, uint8_t timeout);
+
+    /**
+     * @return The fraction of slots of the frame that are currently not free or reserved by this station, which
+     *         is a measure of the channel load as seen by this station
+     */
+    double GetChannelLoad();
+
+    /**
+     * Returns the statistics of the frame that is currently in progress, with the slot counts referring to the
+     * current state of the reservation table
+     *
+     * @return The statistics of the current frame so far
+     */
+    StdmaFrameStatistics GetFrameStatistics();
+
+    /**
+     * Returns the statistics of the last frame that has been completed, which are also reported through the
+     * FrameStatistics trace source. The statistics are completed lazily at the first activity of the station
+     * after the end of the frame, frames in which the station has not been active at all are skipped.
+     *
+     * @return The statistics of the last completed frame
+     */
+    const StdmaFrameStatistics &GetLastFrameStatistics() const;
+
+    /**
+     * @return The start of the current frame, i.e. the frame that contains the current simulation time
+     */
+    ns3::Time GetCurrentFrameStart();
+
+    /**
+     * Writes the state of the slot manager (frame phase, reservation table, nominal slots, reservations and
+     * collisions) to a snapshot. Slots that are free and not reserved by the station itself are skipped.
+     *
+     * @param writer The snapshot writer, whose origin must not be later than the start of the current frame
+     */
+    void SaveState(StdmaSnapshotWriter &writer);
+
+    /**
+     * Restores the state written by SaveState(). The slot manager has to be set up with the same frame and
+     * slot durations as the one the snapshot has been taken from. The frame statistics start from scratch.
+     *
+     * @param reader The snapshot reader
+     */
+    void RestoreState(StdmaSnapshotReader &reader);
+
     /**
      * Instructs the slot manager to select a nominal transmission slot (NTS) for the n-th packet reservation
      * of the current super frame. This shall only be successful if the packet for this reservation has not been
@@ -242,6 +370,14 @@ namespace stdma {
      */
     uint32_t ReSelectTransmissionSlotForReservationWithNo (uint32_t n, uint8_t timeout);
 
+    /**
+     * Returns the index of the slot that is currently reserved for the reservation with index n.
+     *
+     * @param n The index of the reservation
+     * @return The slot index within the frame
+     */
+    uint32_t GetSlotIndexOfReservationWithNo (uint32_t n);
+
     /**
      * Return the scheduled transmission time for the reservation with index n. This method
      * is typically used by the StdmaMac implementation to schedule the next transmission event
@@ -257,6 +393,24 @@ namespace stdma {
      */
     uint32_t GetSlotIndexForTimestamp (ns3::Time t);
 
+    /**
+     * Returns the slot index for the current simulation time. If a slot clock is attached, the index is
+     * derived from the global slot index published by the clock.
+     */
+    uint32_t GetCurrentSlotIndex ();
+
+    /**
+     * Returns the slot index (within the frame) of the slot with the given global slot index
+     * @param slot The global slot index, as published by the slot clock
+     */
+    uint32_t GetSlotIndexForGlobalSlot (uint64_t slot);
+
+    /**
+     * Attaches the slot clock shared by all stations on the channel
+     * @param clock The slot clock, using the same slot duration as this slot manager
+     */
+    void SetSlotClock (ns3::Ptr<StdmaSlotClock> clock);
+
     /**
      * Calculates the offset (i.e. the number of slots) between two arbitrary packet reservations.
      * The reservations are referenced through their local number within the frame (e.g. first own packet
@@ -302,6 +456,18 @@ namespace stdma {
      */
     void MarkSlotAsAllocated(uint32_t index, uint8_t timeout, ns3::Mac48Address node, ns3::Vector position, ns3::Time notbefore);
 
+    /**
+     * Marks the slot with the given index as externally reserved by a transmission that has just been received.
+     * @param index The slot index
+     * @param timeout The number of subsequent frames during which this slot will be used
+     * @param node The MAC address of the node who owns this slot
+     * @param position The position of the owner of this slot
+     * @param notbefore Don't treat as allocated before this timestamp
+     * @param rxPowerDbm The power at which the transmission of the owner has been received
+     */
+    void MarkSlotAsAllocated(uint32_t index, uint8_t timeout, ns3::Mac48Address node, ns3::Vector position, ns3::Time notbefore,
+                             double rxPowerDbm);
+
     /**
      * Marks the slot with the given index as free again.
      * @param index The slot index
@@ -314,6 +480,15 @@ namespace stdma {
      */
     void MarkSlotAsBusy(uint32_t index);
 
+    /**
+     * Marks count consecutive slots as busy, starting with the slot with the given index and wrapping around
+     * at the end of the frame. Equivalent to calling MarkSlotAsBusy() for each of the slots.
+     *
+     * @param first The index of the first slot
+     * @param count The number of slots, ranges longer than a frame mark the whole frame
+     */
+    void MarkSlotRangeAsBusy(uint32_t first, uint32_t count);
+
     /**
      * Tells the slot manager to adjust its frame starting and end times such that the frame
      * is starting at the provided time stamp. All slot numbers are re-arranged accordingly.
@@ -325,7 +500,7 @@ namespace stdma {
      * on the number of slots remaining in the network entry entry phase, and the current probability
      * level.
      */
-    ns3::Ptr<RandomAccessDetails> GetNetworkEntryTimestamp(uint32_t remainingSlots, double p);
+    RandomAccessDetails GetNetworkEntryTimestamp(uint32_t remainingSlots, double p);
 
     /**
      * Determines whether there are still free slots left among the next N slots
@@ -338,22 +513,162 @@ namespace stdma {
      */
     bool IsCurrentSlotStillFree();
 
-    ns3::Ptr<StdmaSlot> GetSlot(uint32_t index);
+    /**
+     * Returns a view onto the slot with the given index. The view is not bound to the slot state but reads and
+     * writes the reservation table of this slot manager directly.
+     *
+     * @param index The slot index
+     * @return A view onto the slot with the given index
+     */
+    StdmaSlot GetSlot(uint32_t index);
+
+    /**
+     * Determines whether one of our own reservations currently shares its slot with the given station
+     *
+     * @param owner The MAC address of the other station
+     * @return True if we already introduced a collision with this station
+     */
+    bool HasCollisionWith(ns3::Mac48Address owner);
 
     uint64_t GetGlobalSlotIndexForTimestamp(ns3::Time t);
 
   private:
     /**
-     * Updates the internal reservation table and marks the status of each slot according to its
-     * new status when going from one frame to another. This method is called internally whenever
-     * the beginning of the next frame is detected.
+     * Moves the slot manager forward to the frame that contains the current simulation time. This
+     * method is called internally whenever the beginning of the next frame is detected. Any number
+     * of frames may have passed since the last call.
      */
     void UpdateSlotObservations();
 
+    /**
+     * Moves the slot manager forward by the given number of frames. External allocations and busy
+     * markings are stored with the absolute number of the frame in which they expire, hence they are
+     * not touched here but evaluated lazily whenever a slot is accessed (see RefreshSlot). Only the
+     * internally allocated slots, whose number is bounded by the report rate, are released eagerly
+     * once their internal timeout has run out, since releasing them also updates the collision memory.
+     *
+     * @param frames The number of frame boundaries that have been crossed
+     */
+    void UpdateSlotObservations(uint32_t frames);
+
+    /**
+     * Brings the stored state of a single slot up to date with the current frame number, i.e. marks
+     * the slot as free if its external allocation or busy marking has expired in the meantime.
+     *
+     * @param index The slot index
+     */
+    void RefreshSlot(uint32_t index);
+
+    /**
+     * Returns the number of the last frame that started strictly before the given time stamp, but never
+     * a frame number smaller than the one of the current frame. Frame boundaries that are crossed after this
+     * frame are counted against the timeout of an allocation that is not valid before the time stamp.
+     *
+     * @param t The time stamp
+     * @return The frame number
+     */
+    uint32_t GetFrameNumberBefore(ns3::Time t);
+
+    /**
+     * Updates the bits of the slot with the given index in the free/allocated/internal slot indices after its
+     * stored state has changed. Has to be called by every method that changes the stored state of a slot.
+     *
+     * @param index The slot index
+     */
+    void UpdateSlotIndex(uint32_t index);
+
+    /**
+     * Brings all slots that are covered by the given word of the slot indices up to date, but only if one of them
+     * may have expired since the word has been refreshed the last time.
+     *
+     * @param word The number of the word, i.e. the slot index divided by 64
+     */
+    void RefreshSlotWord(uint32_t word);
+
+    /**
+     * Marks the slots from index first (inclusive) to index last (inclusive) as busy without wrapping around.
+     */
+    void MarkSlotSegmentAsBusy(uint32_t first, uint32_t last);
+
+    /**
+     * Scans count slots starting at the slot with index start, wrapping around at the end of the frame, by
+     * means of the free/allocated slot indices. A slot is counted as free according to StdmaSlot::IsFree(until),
+     * where the until time stamp of the k-th slot of the range is untilBase + k * untilStep. Free slots and
+     * slots that are externally allocated by other stations are appended in the order of the range.
+     *
+     * @param start The index of the first slot to scan
+     * @param count The number of slots to scan, at most the number of slots per frame
+     * @param untilBase The until time stamp to use for the first slot of the range
+     * @param untilStep The increase of the until time stamp from one slot to the next one
+     * @param free The vector to which free slots are appended, or 0 if only their number is of interest
+     * @param allocated The vector to which externally allocated slots are appended, or 0 if not of interest
+     * @return The number of free slots within the range
+     */
+    uint32_t ScanSlots(uint32_t start, uint32_t count, ns3::Time untilBase, ns3::Time untilStep,
+                       std::vector<uint32_t> *free, std::vector<uint32_t> *allocated);
+
+    /**
+     * Rebuilds the free/allocated/internal slot indices from the stored state of all slots
+     */
+    void RebuildSlotIndices();
+
+    /**
+     * Fills in the slot counts of the given statistics according to the current state of the reservation table
+     */
+    void CountSlots(StdmaFrameStatistics &statistics);
+
+    /**
+     * Fires the nominal slot trace with the current nominal slots, re-based to an imaginary frame start at 0 seconds
+     */
+    void TraceNominalSlots();
+
+    /**
+     * Compiles the candidate set within the selection interval of the n-th reservation and lets the
+     * selection policy choose one of the candidates. The candidate set is left in m_candidates.
+     *
+     * @param n The index of the reservation for which a slot shall be selected
+     * @param timeout The number of frames the reservation shall be kept
+     * @param wrap Whether slots before the beginning of the frame wrap around to the end of the frame
+     * @param numFree Is set to the number of free slots within the selection interval
+     * @return The index of the selected slot
+     */
+    uint32_t SelectCandidateSlot(uint32_t n, uint8_t timeout, bool wrap, uint32_t &numFree);
+
+    /**
+     * Marks the given slot as internally allocated for the n-th reservation and remembers the collision
+     * with its owner in case the slot is externally allocated.
+     *
+     * @param n The index of the reservation
+     * @param index The slot index
+     * @param timeout The number of frames the reservation shall be kept
+     * @return Whether the slot was free before
+     */
+    bool ReserveSlot(uint32_t n, uint32_t index, uint8_t timeout);
+
     ns3::Time GetTimeForSlotIndex(uint32_t index);
 
-    std::map<uint32_t, ns3::Ptr<StdmaSlot> > m_slots;
-    std::map<uint32_t, ns3::Ptr<StdmaSlot> > m_selections;
+    // The reservation table, stored as a structure of arrays indexed by the slot number. The
+    // state related fields that are touched on every scan are kept apart from the rarely read
+    // owner and position of externally allocated slots.
+    std::vector<uint8_t> m_slotState;
+    std::vector<uint8_t> m_slotPreviousState;
+    std::vector<uint8_t> m_slotInternal;
+    std::vector<uint32_t> m_slotExpiry;         // Frame number in which an external allocation or busy marking expires
+    std::vector<uint8_t> m_slotInternalTimeout;
+    std::vector<ns3::Time> m_slotNotBefore;
+    std::vector<ns3::Mac48Address> m_slotOwner;
+    std::vector<ns3::Vector> m_slotPosition;
+    std::vector<double> m_slotRxPower;          // Received power of the owner in dBm, NaN if unknown
+
+    // Bit indices (64 slots per word) over the reservation table, maintained as slots change their stored
+    // state. They allow to build candidate sets and to look for free slots one word at a time.
+    std::vector<uint64_t> m_freeSlots;          // Stored state is FREE
+    std::vector<uint64_t> m_allocatedSlots;     // Stored state is ALLOCATED
+    std::vector<uint64_t> m_internalSlots;      // Slot is internally allocated
+    std::vector<uint64_t> m_deferredSlots;      // Slot was FREE before and is not allocated/busy before notBefore
+    std::vector<uint32_t> m_wordExpiry;         // Earliest frame in which an external state within the word may expire
+
+    std::map<uint32_t, uint32_t> m_selections;  // Reservation number -> slot index
     std::map<ns3::Mac48Address, uint32_t> m_collisions;
 
     ns3::Time m_start;
@@ -363,18 +678,33 @@ namespace stdma {
     uint32_t m_rate;
     uint32_t m_ni;
     uint32_t m_siHalf;
+    double m_selectionRatio;
 
     std::vector<uint32_t> m_nss;        // Nominal start slots
     ns3::Time m_lastFrameStart;
+    uint64_t m_lastFrameStartSlot;      // Global slot index of m_lastFrameStart
+    ns3::Ptr<StdmaSlotClock> m_clock;
+    uint32_t m_frame;                   // Number of the current frame, counted from the first frame
     uint32_t m_current;
 
     uint32_t m_mininumCandidates;
+    ns3::Vector m_position;             // Position snapshot of the station, provided by the MAC layer
+    ns3::Ptr<StdmaSlotSelectionPolicy> m_policy;
+    std::vector<uint32_t> m_candidates; // Scratch buffers for the candidate collection, reused across reservations
+    std::vector<uint32_t> m_allocated;
+    ns3::Ptr<ns3::UniformRandomVariable> m_networkEntryRng;
+    StdmaFrameStatistics m_statistics;       // Counters of the current frame, without slot counts
+    StdmaFrameStatistics m_lastStatistics;   // Statistics of the last completed frame
 
     ns3::TracedCallback<std::vector<uint32_t> > m_nominalSlotTrace;
     ns3::TracedCallback<uint32_t, uint32_t, bool> m_reservationTrace;
     ns3::TracedCallback<uint32_t, uint32_t, bool, bool> m_reReservationTrace;
+    ns3::TracedCallback<const StdmaFrameStatistics &> m_frameStatisticsTrace;
 
+    friend class StdmaSlot;
     friend class StdmaSlotManagerTest;
+    friend class StdmaChangeReportRateTest;
+    friend class StdmaFrameStatisticsTest;
   };
 
 } // namespace stdma
@@ -0,0 +1,240 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-slot-phy.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("StdmaSlotPhy");
+
+namespace stdma {
+
+  NS_OBJECT_ENSURE_REGISTERED (StdmaSlotPhy);
+
+  ns3::TypeId
+  StdmaSlotPhy::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaSlotPhy")
+            .SetParent<ns3::YansWifiPhy>().AddConstructor<StdmaSlotPhy>();
+    return tid;
+  }
+
+  StdmaSlotPhy::StdmaSlotPhy()
+    : m_slotChannelIndex(0),
+      m_txEnd(ns3::Seconds(0)),
+      m_lastRxStart(ns3::Seconds(0)),
+      m_stateStart(ns3::Seconds(0))
+  {
+  }
+
+  StdmaSlotPhy::~StdmaSlotPhy()
+  {
+  }
+
+  void
+  StdmaSlotPhy::DoDispose (void)
+  {
+    // The slot channel holds a reference to this phy as well
+    m_slotChannel = 0;
+    m_listeners.clear();
+    m_rxOkCallback = ns3::WifiPhy::RxOkCallback();
+    m_rxErrorCallback = ns3::WifiPhy::RxErrorCallback();
+    ns3::YansWifiPhy::DoDispose();
+  }
+
+  void
+  StdmaSlotPhy::SetSlotChannel (ns3::Ptr<StdmaSlotChannel> channel)
+  {
+    m_slotChannel = channel;
+    m_slotChannelIndex = m_slotChannel->Add(this);
+  }
+
+  uint32_t
+  StdmaSlotPhy::GetSlotChannelIndex (void) const
+  {
+    return m_slotChannelIndex;
+  }
+
+  double
+  StdmaSlotPhy::GetTxPowerDbm (uint8_t level) const
+  {
+    NS_ASSERT(GetNTxPower() > 0);
+    if (GetNTxPower() > 1)
+      {
+        return GetTxPowerStart() + level * (GetTxPowerEnd() - GetTxPowerStart()) / (GetNTxPower() - 1);
+      }
+    NS_ASSERT_MSG(GetTxPowerStart() == GetTxPowerEnd(), "StdmaSlotPhy:GetTxPowerDbm() cannot have TxPowerEnd != TxPowerStart with TxPowerLevels == 1");
+    return GetTxPowerStart();
+  }
+
+  void
+  StdmaSlotPhy::SendPacket (ns3::Ptr<const ns3::Packet> packet, ns3::WifiMode mode, enum ns3::WifiPreamble preamble,
+                            ns3::WifiTxVector txVector)
+  {
+    NS_LOG_FUNCTION(this << packet << mode << preamble);
+    NS_ASSERT(!IsStateTx());
+    NS_ASSERT(m_slotChannel != 0);
+
+    ns3::Time duration = CalculateTxDuration(packet->GetSize(), txVector, preamble);
+    NotifyTxBegin(packet);
+    m_txEnd = ns3::Simulator::Now() + duration;
+    m_stateStart = ns3::Simulator::Now();
+    for (std::vector<ns3::WifiPhyListener *>::iterator i = m_listeners.begin(); i != m_listeners.end(); ++i)
+      {
+        (*i)->NotifyTxStart(duration);
+      }
+    m_slotChannel->Send(this, packet, GetTxPowerDbm(txVector.GetTxPowerLevel()) + GetTxGain(), txVector.GetMode(), preamble, duration);
+  }
+
+  void
+  StdmaSlotPhy::ReceiveOk (ns3::Ptr<ns3::Packet> packet, double snr, double rxPowerDbm, ns3::WifiMode mode,
+                           ns3::WifiPreamble preamble)
+  {
+    NS_LOG_FUNCTION(this << packet << snr << rxPowerDbm << mode);
+    ns3::WifiTxVector txVector;
+    txVector.SetMode(mode);
+    NotifyReceptionStart(packet, CalculateTxDuration(packet->GetSize(), txVector, preamble));
+    NotifyRxEnd(packet);
+    // Report the reception power the same way as the yans phy does, so that the mac can rank slot owners by it
+    double noiseDbm = rxPowerDbm - 10.0 * std::log10(snr) - GetRxNoiseFigure();
+    NotifyMonitorSniffRx(packet, (uint16_t) GetChannelFrequencyMhz(), GetChannelNumber(), mode.GetDataRate() / 500000,
+                         preamble == ns3::WIFI_PREAMBLE_SHORT, rxPowerDbm, noiseDbm);
+    for (std::vector<ns3::WifiPhyListener *>::iterator i = m_listeners.begin(); i != m_listeners.end(); ++i)
+      {
+        (*i)->NotifyRxEndOk();
+      }
+    if (!m_rxOkCallback.IsNull())
+      {
+        m_rxOkCallback(packet, snr, mode, preamble);
+      }
+  }
+
+  void
+  StdmaSlotPhy::ReceiveError (ns3::Ptr<ns3::Packet> packet, double snr, ns3::Time duration)
+  {
+    NS_LOG_FUNCTION(this << packet << snr);
+    NotifyReceptionStart(packet, duration);
+    NotifyRxDrop(packet);
+    for (std::vector<ns3::WifiPhyListener *>::iterator i = m_listeners.begin(); i != m_listeners.end(); ++i)
+      {
+        (*i)->NotifyRxEndError();
+      }
+    if (!m_rxErrorCallback.IsNull())
+      {
+        m_rxErrorCallback(packet, snr);
+      }
+  }
+
+  void
+  StdmaSlotPhy::NotifyReceptionStart (ns3::Ptr<ns3::Packet> packet, ns3::Time duration)
+  {
+    m_lastRxStart = ns3::Simulator::Now() - duration;
+    m_stateStart = ns3::Simulator::Now();
+    NotifyRxBegin(packet);
+    for (std::vector<ns3::WifiPhyListener *>::iterator i = m_listeners.begin(); i != m_listeners.end(); ++i)
+      {
+        (*i)->NotifyRxStart(duration);
+      }
+  }
+
+  void
+  StdmaSlotPhy::SetReceiveOkCallback (ns3::WifiPhy::RxOkCallback callback)
+  {
+    m_rxOkCallback = callback;
+  }
+
+  void
+  StdmaSlotPhy::SetReceiveErrorCallback (ns3::WifiPhy::RxErrorCallback callback)
+  {
+    m_rxErrorCallback = callback;
+  }
+
+  void
+  StdmaSlotPhy::RegisterListener (ns3::WifiPhyListener *listener)
+  {
+    m_listeners.push_back(listener);
+  }
+
+  bool
+  StdmaSlotPhy::IsStateCcaBusy (void)
+  {
+    return false;
+  }
+
+  bool
+  StdmaSlotPhy::IsStateIdle (void)
+  {
+    return !IsStateTx();
+  }
+
+  bool
+  StdmaSlotPhy::IsStateBusy (void)
+  {
+    return IsStateTx();
+  }
+
+  bool
+  StdmaSlotPhy::IsStateRx (void)
+  {
+    // Receptions are reported at once when the slot is resolved
+    return false;
+  }
+
+  bool
+  StdmaSlotPhy::IsStateTx (void)
+  {
+    return ns3::Simulator::Now() < m_txEnd;
+  }
+
+  bool
+  StdmaSlotPhy::IsStateSwitching (void)
+  {
+    return false;
+  }
+
+  ns3::Time
+  StdmaSlotPhy::GetStateDuration (void)
+  {
+    ns3::Time start = IsStateTx() ? m_stateStart : std::max(m_stateStart, m_txEnd);
+    return ns3::Simulator::Now() - start;
+  }
+
+  ns3::Time
+  StdmaSlotPhy::GetDelayUntilIdle (void)
+  {
+    return IsStateTx() ? (m_txEnd - ns3::Simulator::Now()) : ns3::Seconds(0);
+  }
+
+  ns3::Time
+  StdmaSlotPhy::GetLastRxStartTime (void) const
+  {
+    return m_lastRxStart;
+  }
+
+  ns3::Ptr<ns3::WifiChannel>
+  StdmaSlotPhy::GetChannel (void) const
+  {
+    return m_slotChannel;
+  }
+
+} // namespace stdma
@@ -0,0 +1,126 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SLOT_PHY_H_
+#define STDMA_SLOT_PHY_H_
+
+#include "ns3/yans-wifi-phy.h"
+#include "stdma-slot-channel.h"
+
+#include <vector>
+
+namespace stdma {
+
+  /**
+   * \brief Physical layer attached to a StdmaSlotChannel
+   *
+   * The slot phy reuses the configuration of the YansWifiPhy (transmission power levels, antenna gains,
+   * energy detection and CCA thresholds, noise figure, error rate model and the modes of the configured
+   * standard), but hands its transmissions to the StdmaSlotChannel, which decides upon the outcome of all
+   * transmissions of a slot at once. A reception is therefore reported to the MAC layer in one go at the end
+   * of the slot: the listeners are notified about the start of the reception, immediately followed by its
+   * successful or erroneous end. The phy does not track CCA busy periods, slots in which energy has been
+   * detected but no packet could be decoded are reported as erroneous receptions.
+   */
+  class StdmaSlotPhy : public ns3::YansWifiPhy
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaSlotPhy ();
+    virtual ~StdmaSlotPhy ();
+
+    /**
+     * Attaches the phy to the given slot channel
+     *
+     * @param channel The slot channel
+     */
+    void SetSlotChannel (ns3::Ptr<StdmaSlotChannel> channel);
+
+    /**
+     * @return The index of this phy on its slot channel
+     */
+    uint32_t GetSlotChannelIndex (void) const;
+
+    /**
+     * Reports a successful reception that has been resolved by the slot channel
+     *
+     * @param packet The received packet (a copy owned by this phy)
+     * @param snr The signal to interference plus noise ratio of the reception
+     * @param rxPowerDbm The power at which the packet has been received
+     * @param mode The transmission mode
+     * @param preamble The preamble
+     */
+    void ReceiveOk (ns3::Ptr<ns3::Packet> packet, double snr, double rxPowerDbm, ns3::WifiMode mode,
+                    ns3::WifiPreamble preamble);
+
+    /**
+     * Reports an erroneous reception, or energy above the CCA threshold, that has been resolved by the slot channel
+     *
+     * @param packet The packet of the strongest transmission (a copy owned by this phy)
+     * @param snr The signal to interference plus noise ratio of the reception
+     * @param duration The duration of the transmission
+     */
+    void ReceiveError (ns3::Ptr<ns3::Packet> packet, double snr, ns3::Time duration);
+
+    /**
+     * @param level The transmission power level
+     * @return The transmission power of the given level in dBm, excluding the antenna gain
+     */
+    double GetTxPowerDbm (uint8_t level) const;
+
+    virtual void SetReceiveOkCallback (ns3::WifiPhy::RxOkCallback callback);
+    virtual void SetReceiveErrorCallback (ns3::WifiPhy::RxErrorCallback callback);
+    virtual void SendPacket (ns3::Ptr<const ns3::Packet> packet, ns3::WifiMode mode, enum ns3::WifiPreamble preamble,
+                             ns3::WifiTxVector txvector);
+    virtual void RegisterListener (ns3::WifiPhyListener *listener);
+    virtual bool IsStateCcaBusy (void);
+    virtual bool IsStateIdle (void);
+    virtual bool IsStateBusy (void);
+    virtual bool IsStateRx (void);
+    virtual bool IsStateTx (void);
+    virtual bool IsStateSwitching (void);
+    virtual ns3::Time GetStateDuration (void);
+    virtual ns3::Time GetDelayUntilIdle (void);
+    virtual ns3::Time GetLastRxStartTime (void) const;
+    virtual ns3::Ptr<ns3::WifiChannel> GetChannel (void) const;
+
+  private:
+    virtual void DoDispose (void);
+
+    /**
+     * Notifies the listeners and traces about the start of a reception that ended just now
+     */
+    void NotifyReceptionStart (ns3::Ptr<ns3::Packet> packet, ns3::Time duration);
+
+    ns3::Ptr<StdmaSlotChannel> m_slotChannel;
+    uint32_t m_slotChannelIndex;
+    std::vector<ns3::WifiPhyListener *> m_listeners;
+    ns3::WifiPhy::RxOkCallback m_rxOkCallback;
+    ns3::WifiPhy::RxErrorCallback m_rxErrorCallback;
+    ns3::Time m_txEnd;
+    ns3::Time m_lastRxStart;
+    ns3::Time m_stateStart;
+  };
+
+} // namespace stdma
+
+#endif /* STDMA_SLOT_PHY_H_ */
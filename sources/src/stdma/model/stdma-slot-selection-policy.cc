@@ -0,0 +1,201 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-slot-selection-policy.h"
+#include "stdma-slot-manager.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("StdmaSlotSelectionPolicy");
+
+namespace stdma {
+
+  NS_OBJECT_ENSURE_REGISTERED (StdmaSlotSelectionPolicy);
+  NS_OBJECT_ENSURE_REGISTERED (StdmaDistanceSlotSelectionPolicy);
+  NS_OBJECT_ENSURE_REGISTERED (StdmaRxPowerSlotSelectionPolicy);
+
+  ns3::TypeId
+  StdmaSlotSelectionPolicy::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaSlotSelectionPolicy")
+            .SetParent<Object>();
+    return tid;
+  }
+
+  StdmaSlotSelectionPolicy::StdmaSlotSelectionPolicy()
+  {
+  }
+
+  StdmaSlotSelectionPolicy::~StdmaSlotSelectionPolicy()
+  {
+  }
+
+  ns3::TypeId
+  StdmaDistanceSlotSelectionPolicy::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaDistanceSlotSelectionPolicy")
+            .SetParent<StdmaSlotSelectionPolicy>().AddConstructor<StdmaDistanceSlotSelectionPolicy>();
+    return tid;
+  }
+
+  StdmaDistanceSlotSelectionPolicy::StdmaDistanceSlotSelectionPolicy()
+  {
+  }
+
+  StdmaDistanceSlotSelectionPolicy::~StdmaDistanceSlotSelectionPolicy()
+  {
+  }
+
+  uint32_t
+  StdmaDistanceSlotSelectionPolicy::SelectSlot (StdmaSlotManager &manager, ns3::Vector position,
+                                                std::vector<uint32_t> &candidates, const std::vector<uint32_t> &allocated)
+  {
+    NS_LOG_FUNCTION(this << candidates.size() << allocated.size());
+
+    // If we do not have enough slots yet, we will add as many allocated slots until we have the minimum
+    // number of candidates, but only slots owned by vehicles with which we do not collide yet
+    if (candidates.size() < manager.GetMinimumCandidateSlotSetSize())
+      {
+        uint32_t missing = manager.GetMinimumCandidateSlotSetSize() - candidates.size();
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaDistanceSlotSelectionPolicy:SelectSlot() " << missing << " slots need to be added that are already allocated");
+        m_scratch.clear();
+        for (uint32_t i = 0; i < allocated.size(); i++)
+          {
+            StdmaSlot slot = manager.GetSlot(allocated[i]);
+            if (manager.HasCollisionWith(slot.GetOwner()))
+              {
+                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaDistanceSlotSelectionPolicy:SelectSlot() not adding already allocated slot "
+                    << allocated[i] << " to candidate set because we already have a collision with the owner.");
+                continue;
+              }
+            m_scratch.push_back(std::make_pair(ns3::CalculateDistance(slot.GetPosition(), position), i));
+          }
+
+        // Only the farthest owners are of interest, in decreasing order of their distance. Owners at the same
+        // distance are ordered by decreasing position within the selection interval.
+        uint32_t added = std::min<uint32_t>(missing, m_scratch.size());
+        std::partial_sort(m_scratch.begin(), m_scratch.begin() + added, m_scratch.end(),
+                          std::greater<std::pair<double, uint32_t> >());
+        for (uint32_t i = 0; i < added; i++)
+          {
+            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaDistanceSlotSelectionPolicy:SelectSlot() adding already allocated slot "
+                << allocated[m_scratch[i].second] << " to candidate set since its owner is " << m_scratch[i].first << " meters away");
+            candidates.push_back(allocated[m_scratch[i].second]);
+          }
+      }
+
+    // Randomly select one of these candidate slots
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaDistanceSlotSelectionPolicy:SelectSlot() " << candidates.size() << " candidates available to choose from");
+    NS_ASSERT(!candidates.empty());
+    uint32_t selection = floor(m_randomizer.GetValue(0, candidates.size()-0.00001));
+    NS_ASSERT(selection < candidates.size());
+    return candidates[selection];
+  }
+
+  ns3::TypeId
+  StdmaRxPowerSlotSelectionPolicy::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaRxPowerSlotSelectionPolicy")
+            .SetParent<StdmaSlotSelectionPolicy>().AddConstructor<StdmaRxPowerSlotSelectionPolicy>();
+    return tid;
+  }
+
+  StdmaRxPowerSlotSelectionPolicy::StdmaRxPowerSlotSelectionPolicy()
+  {
+  }
+
+  StdmaRxPowerSlotSelectionPolicy::~StdmaRxPowerSlotSelectionPolicy()
+  {
+  }
+
+  uint32_t
+  StdmaRxPowerSlotSelectionPolicy::SelectSlot (StdmaSlotManager &manager, ns3::Vector position,
+                                               std::vector<uint32_t> &candidates, const std::vector<uint32_t> &allocated)
+  {
+    NS_LOG_FUNCTION(this << candidates.size() << allocated.size());
+
+    // If we do not have enough slots yet, we will add as many allocated slots until we have the minimum
+    // number of candidates, but only slots owned by vehicles with which we do not collide yet
+    if (candidates.size() < manager.GetMinimumCandidateSlotSetSize())
+      {
+        uint32_t missing = manager.GetMinimumCandidateSlotSetSize() - candidates.size();
+        NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaRxPowerSlotSelectionPolicy:SelectSlot() " << missing << " slots need to be added that are already allocated");
+        m_measured.clear();
+        m_unmeasured.clear();
+        for (uint32_t i = 0; i < allocated.size(); i++)
+          {
+            StdmaSlot slot = manager.GetSlot(allocated[i]);
+            if (manager.HasCollisionWith(slot.GetOwner()))
+              {
+                NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaRxPowerSlotSelectionPolicy:SelectSlot() not adding already allocated slot "
+                    << allocated[i] << " to candidate set because we already have a collision with the owner.");
+                continue;
+              }
+            if (slot.HasRxPower())
+              {
+                m_measured.push_back(std::make_pair(slot.GetRxPower(), i));
+              }
+            else
+              {
+                m_unmeasured.push_back(std::make_pair(ns3::CalculateDistance(slot.GetPosition(), position), i));
+              }
+          }
+
+        // The weakest received owners interfere least with our own transmission. Only their set matters,
+        // which is selected in linear time.
+        uint32_t added = std::min<uint32_t>(missing, m_measured.size());
+        if (added < m_measured.size())
+          {
+            std::nth_element(m_measured.begin(), m_measured.begin() + added, m_measured.end());
+          }
+        for (uint32_t i = 0; i < added; i++)
+          {
+            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaRxPowerSlotSelectionPolicy:SelectSlot() adding already allocated slot "
+                << allocated[m_measured[i].second] << " to candidate set since its owner is received with " << m_measured[i].first << " dBm");
+            candidates.push_back(allocated[m_measured[i].second]);
+          }
+
+        // The remaining candidates are taken from the owners without a received power, in decreasing order of
+        // their reported distance
+        added = std::min<uint32_t>(missing - added, m_unmeasured.size());
+        std::partial_sort(m_unmeasured.begin(), m_unmeasured.begin() + added, m_unmeasured.end(),
+                          std::greater<std::pair<double, uint32_t> >());
+        for (uint32_t i = 0; i < added; i++)
+          {
+            NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaRxPowerSlotSelectionPolicy:SelectSlot() adding already allocated slot "
+                << allocated[m_unmeasured[i].second] << " to candidate set since its owner is " << m_unmeasured[i].first << " meters away");
+            candidates.push_back(allocated[m_unmeasured[i].second]);
+          }
+      }
+
+    // Randomly select one of these candidate slots
+    NS_LOG_DEBUG(ns3::Simulator::Now() << " " << ns3::Simulator::GetContext() << " StdmaRxPowerSlotSelectionPolicy:SelectSlot() " << candidates.size() << " candidates available to choose from");
+    NS_ASSERT(!candidates.empty());
+    uint32_t selection = floor(m_randomizer.GetValue(0, candidates.size()-0.00001));
+    NS_ASSERT(selection < candidates.size());
+    return candidates[selection];
+  }
+
+} // namespace stdma
@@ -0,0 +1,124 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SLOT_SELECTION_POLICY_H_
+#define STDMA_SLOT_SELECTION_POLICY_H_
+
+#include "ns3/object.h"
+#include "ns3/vector.h"
+#include "ns3/random-variable.h"
+
+#include <utility>
+#include <vector>
+
+namespace stdma {
+
+  class StdmaSlotManager;
+
+  /**
+   * \brief Strategy used by the StdmaSlotManager to pick a transmission slot from the selection interval
+   *
+   * The slot manager compiles the free slots and the slots that are externally allocated by other stations
+   * within the selection interval of a reservation and hands both sets to the policy, which decides upon
+   * the slot that is going to be reserved. The policy is used for the initial reservation as well as for
+   * re-reservations, and can be replaced through the SelectionPolicy attribute of the slot manager.
+   */
+  class StdmaSlotSelectionPolicy : public ns3::Object
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaSlotSelectionPolicy();
+    virtual ~StdmaSlotSelectionPolicy();
+
+    /**
+     * Completes the candidate set for a reservation if necessary and selects one slot out of it.
+     *
+     * @param manager The slot manager on whose behalf the slot is selected
+     * @param position The current position of the station
+     * @param candidates The free slots within the selection interval, in the order of the interval. Any
+     *                   externally allocated slot that the policy considers as candidate is appended.
+     * @param allocated The slots within the selection interval that are externally allocated by other stations,
+     *                  in the order of the interval
+     * @return The index of the selected slot
+     */
+    virtual uint32_t SelectSlot (StdmaSlotManager &manager, ns3::Vector position,
+                                 std::vector<uint32_t> &candidates, const std::vector<uint32_t> &allocated) = 0;
+  };
+
+  /**
+   * \brief Slot selection policy as described in ITU-R M.1371
+   *
+   * If less than the minimum number of candidates is free, the candidate set is filled up with the externally
+   * allocated slots whose owners are located farthest away, skipping owners with which the station already
+   * shares a slot. The slot is then chosen uniformly at random from the candidate set.
+   */
+  class StdmaDistanceSlotSelectionPolicy : public StdmaSlotSelectionPolicy
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaDistanceSlotSelectionPolicy();
+    virtual ~StdmaDistanceSlotSelectionPolicy();
+
+    virtual uint32_t SelectSlot (StdmaSlotManager &manager, ns3::Vector position,
+                                 std::vector<uint32_t> &candidates, const std::vector<uint32_t> &allocated);
+
+  private:
+    // Distance to the owner and position within the selection interval of the allocated slots, kept
+    // across calls to avoid allocations for every reservation
+    std::vector<std::pair<double, uint32_t> > m_scratch;
+    ns3::UniformVariable m_randomizer;
+  };
+
+  /**
+   * \brief Default slot selection policy, which ranks the owners of allocated slots by their received power
+   *
+   * If less than the minimum number of candidates is free, the candidate set is filled up with the externally
+   * allocated slots whose owners are received with the lowest power, skipping owners with which the station
+   * already shares a slot. Owners whose received power is not known (e.g. because the phy does not report it)
+   * are only used if there are not enough other owners, farthest first according to their reported positions
+   * as in ITU-R M.1371. The slot is then chosen uniformly at random from the candidate set.
+   */
+  class StdmaRxPowerSlotSelectionPolicy : public StdmaSlotSelectionPolicy
+  {
+  public:
+    static ns3::TypeId GetTypeId (void);
+
+    StdmaRxPowerSlotSelectionPolicy();
+    virtual ~StdmaRxPowerSlotSelectionPolicy();
+
+    virtual uint32_t SelectSlot (StdmaSlotManager &manager, ns3::Vector position,
+                                 std::vector<uint32_t> &candidates, const std::vector<uint32_t> &allocated);
+
+  private:
+    // Received power of the owner and position within the selection interval of the allocated slots, kept
+    // across calls to avoid allocations for every reservation
+    std::vector<std::pair<double, uint32_t> > m_measured;
+    // Distance to the owner and position within the selection interval of the allocated slots whose owner
+    // has no received power
+    std::vector<std::pair<double, uint32_t> > m_unmeasured;
+    ns3::UniformVariable m_randomizer;
+  };
+
+} // namespace stdma
+
+#endif /* STDMA_SLOT_SELECTION_POLICY_H_ */
@@ -0,0 +1,180 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-snapshot.h"
+#include "ns3/log.h"
+
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("StdmaSnapshot");
+
+namespace stdma {
+
+  StdmaSnapshotWriter::StdmaSnapshotWriter (ns3::Time origin)
+    : m_origin(origin)
+  {
+  }
+
+  void
+  StdmaSnapshotWriter::WriteU8 (uint8_t value)
+  {
+    m_data.push_back((char) value);
+  }
+
+  void
+  StdmaSnapshotWriter::WriteU16 (uint16_t value)
+  {
+    WriteU8(value & 0xff);
+    WriteU8(value >> 8);
+  }
+
+  void
+  StdmaSnapshotWriter::WriteU32 (uint32_t value)
+  {
+    WriteU16(value & 0xffff);
+    WriteU16(value >> 16);
+  }
+
+  void
+  StdmaSnapshotWriter::WriteU64 (uint64_t value)
+  {
+    WriteU32(value & 0xffffffff);
+    WriteU32(value >> 32);
+  }
+
+  void
+  StdmaSnapshotWriter::WriteDouble (double value)
+  {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU64(bits);
+  }
+
+  void
+  StdmaSnapshotWriter::WriteTime (ns3::Time t)
+  {
+    WriteU64((uint64_t) (t - m_origin).GetNanoSeconds());
+  }
+
+  void
+  StdmaSnapshotWriter::WriteVector (ns3::Vector v)
+  {
+    WriteDouble(v.x);
+    WriteDouble(v.y);
+    WriteDouble(v.z);
+  }
+
+  void
+  StdmaSnapshotWriter::WriteAddress (ns3::Mac48Address address)
+  {
+    uint8_t buffer[6];
+    address.CopyTo(buffer);
+    m_data.append((const char *) buffer, 6);
+  }
+
+  const std::string &
+  StdmaSnapshotWriter::GetData () const
+  {
+    return m_data;
+  }
+
+  StdmaSnapshotReader::StdmaSnapshotReader (const std::string &data, ns3::Time origin)
+    : m_data(data),
+      m_origin(origin),
+      m_position(0)
+  {
+  }
+
+  uint8_t
+  StdmaSnapshotReader::ReadU8 ()
+  {
+    if (m_position >= m_data.size())
+      {
+        NS_FATAL_ERROR("StdmaSnapshotReader:ReadU8() the snapshot is truncated");
+      }
+    return (uint8_t) m_data[m_position++];
+  }
+
+  uint16_t
+  StdmaSnapshotReader::ReadU16 ()
+  {
+    uint16_t low = ReadU8();
+    return low | (ReadU8() << 8);
+  }
+
+  uint32_t
+  StdmaSnapshotReader::ReadU32 ()
+  {
+    uint32_t low = ReadU16();
+    return low | ((uint32_t) ReadU16() << 16);
+  }
+
+  uint64_t
+  StdmaSnapshotReader::ReadU64 ()
+  {
+    uint64_t low = ReadU32();
+    return low | ((uint64_t) ReadU32() << 32);
+  }
+
+  double
+  StdmaSnapshotReader::ReadDouble ()
+  {
+    uint64_t bits = ReadU64();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  ns3::Time
+  StdmaSnapshotReader::ReadTime ()
+  {
+    return m_origin + ns3::NanoSeconds((int64_t) ReadU64());
+  }
+
+  ns3::Vector
+  StdmaSnapshotReader::ReadVector ()
+  {
+    double x = ReadDouble();
+    double y = ReadDouble();
+    double z = ReadDouble();
+    return ns3::Vector(x, y, z);
+  }
+
+  ns3::Mac48Address
+  StdmaSnapshotReader::ReadAddress ()
+  {
+    uint8_t buffer[6];
+    for (uint32_t i = 0; i < 6; i++)
+      {
+        buffer[i] = ReadU8();
+      }
+    ns3::Mac48Address address;
+    address.CopyFrom(buffer);
+    return address;
+  }
+
+  bool
+  StdmaSnapshotReader::IsAtEnd () const
+  {
+    return m_position == m_data.size();
+  }
+
+} // namespace stdma
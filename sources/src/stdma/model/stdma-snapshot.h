@@ -0,0 +1,104 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SNAPSHOT_H_
+#define STDMA_SNAPSHOT_H_
+
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/mac48-address.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace stdma {
+
+  /**
+   * \brief Writes the state of a STDMA station into a compact binary snapshot
+   *
+   * All values are written in little endian byte order with a fixed width. Time stamps are written relative
+   * to the origin of the snapshot, such that the state can be restored at a different simulation time (see
+   * StdmaSnapshotReader). The origin has to be a multiple of the slot duration to keep the slot grid.
+   */
+  class StdmaSnapshotWriter
+  {
+  public:
+    /**
+     * @param origin The time stamp that corresponds to the time stamp zero of the snapshot
+     */
+    StdmaSnapshotWriter (ns3::Time origin);
+
+    void WriteU8 (uint8_t value);
+    void WriteU16 (uint16_t value);
+    void WriteU32 (uint32_t value);
+    void WriteU64 (uint64_t value);
+    void WriteDouble (double value);
+    void WriteTime (ns3::Time t);
+    void WriteVector (ns3::Vector v);
+    void WriteAddress (ns3::Mac48Address address);
+
+    /**
+     * @return The snapshot written so far
+     */
+    const std::string &GetData () const;
+
+  private:
+    ns3::Time m_origin;
+    std::string m_data;
+  };
+
+  /**
+   * \brief Reads the state of a STDMA station from a binary snapshot written by a StdmaSnapshotWriter
+   *
+   * Time stamps are re-based to the origin of the reader. Reading beyond the end of the snapshot is a fatal error.
+   */
+  class StdmaSnapshotReader
+  {
+  public:
+    /**
+     * @param data The snapshot
+     * @param origin The time stamp that corresponds to the time stamp zero of the snapshot
+     */
+    StdmaSnapshotReader (const std::string &data, ns3::Time origin);
+
+    uint8_t ReadU8 ();
+    uint16_t ReadU16 ();
+    uint32_t ReadU32 ();
+    uint64_t ReadU64 ();
+    double ReadDouble ();
+    ns3::Time ReadTime ();
+    ns3::Vector ReadVector ();
+    ns3::Mac48Address ReadAddress ();
+
+    /**
+     * @return Whether the whole snapshot has been read
+     */
+    bool IsAtEnd () const;
+
+  private:
+    const std::string &m_data;
+    ns3::Time m_origin;
+    uint32_t m_position;
+  };
+
+} // namespace stdma
+
+#endif /* STDMA_SNAPSHOT_H_ */
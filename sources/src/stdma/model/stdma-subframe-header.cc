@@ -0,0 +1,90 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "stdma-subframe-header.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("StdmaSubframeHeader");
+
+namespace stdma {
+
+  ns3::TypeId
+  StdmaSubframeHeader::GetTypeId (void)
+  {
+    static ns3::TypeId tid = ns3::TypeId("stdma::StdmaSubframeHeader")
+        .SetParent<ns3::Header>()
+        .AddConstructor<StdmaSubframeHeader>();
+    return tid;
+  }
+
+  StdmaSubframeHeader::StdmaSubframeHeader ()
+    : m_length(0)
+  {
+  }
+
+  StdmaSubframeHeader::~StdmaSubframeHeader ()
+  {
+  }
+
+  ns3::TypeId
+  StdmaSubframeHeader::GetInstanceTypeId (void) const
+  {
+    return GetTypeId();
+  }
+
+  uint32_t
+  StdmaSubframeHeader::GetSerializedSize (void) const
+  {
+    return sizeof(m_length);
+  }
+
+  void
+  StdmaSubframeHeader::Serialize (ns3::Buffer::Iterator start) const
+  {
+    start.WriteHtonU16(m_length);
+  }
+
+  uint32_t
+  StdmaSubframeHeader::Deserialize (ns3::Buffer::Iterator start)
+  {
+    m_length = start.ReadNtohU16();
+    return sizeof(m_length);
+  }
+
+  void
+  StdmaSubframeHeader::Print (std::ostream &os) const
+  {
+    os << "STDMA Subframe Header: (Length: " << m_length << ")";
+  }
+
+  void
+  StdmaSubframeHeader::SetLength(uint16_t length)
+  {
+    m_length = length;
+  }
+
+  uint16_t
+  StdmaSubframeHeader::GetLength() const
+  {
+    return m_length;
+  }
+
+} // namespace stdma
@@ -0,0 +1,66 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_SUBFRAME_HEADER_H_
+#define STDMA_SUBFRAME_HEADER_H_
+
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+
+namespace stdma {
+
+/**
+ * \brief Precedes each packet within the payload of an aggregated STDMA frame
+ *
+ * If the StdmaHeader indicates an aggregated frame, the payload consists of a sequence of packets, each one
+ * preceded by this sub-header, which only carries the length of the packet that follows.
+ *
+ * \ingroup stdma
+ */
+class StdmaSubframeHeader : public ns3::Header
+{
+
+public:
+
+  static ns3::TypeId GetTypeId (void);
+  StdmaSubframeHeader ();
+  virtual ~StdmaSubframeHeader ();
+  virtual ns3::TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (ns3::Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (ns3::Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+  /**
+   * \param length The size of the packet that follows the sub-header in bytes
+   */
+  void SetLength(uint16_t length);
+  uint16_t GetLength() const;
+
+private:
+
+  uint16_t m_length;
+
+};
+
+} // namespace stdma
+
+#endif /* STDMA_SUBFRAME_HEADER_H_ */
@@ -0,0 +1,151 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "aggregation-test.h"
+#include "stdma-test-utils.h"
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaAggregationTest::StdmaAggregationTest ()
+    : ns3::TestCase ("StdmaAggregationTest"),
+      m_frames(0),
+      m_packets(0),
+      m_packetSize(50),
+      m_groupPacketSize(60),
+      m_group(ns3::Mac48Address("01:00:5e:00:00:01")),
+      m_groupPackets(0),
+      m_misaddressed(0)
+  {
+  }
+
+  void
+  StdmaAggregationTest::DoRun (void)
+  {
+    ns3::SeedManager::SetSeed (1);
+
+    stdma::StdmaHelper stdma;
+    stdma.SetStandard(ns3::WIFI_PHY_STANDARD_80211p_CCH);
+    SetTwoStationsDefaults(ns3::UniformVariable(8, 8));
+    ns3::Config::SetDefault ("stdma::StdmaMac::Aggregation", ns3::BooleanValue(true));
+
+    // Create two network nodes next to each other
+    ns3::Config::SetDefault ("ns3::LogDistancePropagationLossModel::Exponent", ns3::DoubleValue(1.85));
+    ns3::Config::SetDefault ("ns3::LogDistancePropagationLossModel::ReferenceLoss", ns3::DoubleValue(59.7));
+    ns3::NodeContainer m_nodes;
+    ns3::NetDeviceContainer devices = InstallTwoStations(stdma, CreateTwoStationsPhy(), m_nodes);
+    devices.Get(1)->SetPromiscReceiveCallback(ns3::MakeCallback(&stdma::StdmaAggregationTest::PromiscRx, this));
+
+    ns3::PacketSocketHelper packetSocket;
+    packetSocket.Install(m_nodes);
+    ns3::PacketSocketAddress socket;
+    socket.SetAllDevices();
+    socket.SetPhysicalAddress(ns3::Mac48Address::GetBroadcast());
+    socket.SetProtocol(1);
+
+    // The applications generate 50 small packets per second, while there are only 10 slots per second
+    ns3::OnOffHelper onOff ("ns3::PacketSocketFactory", ns3::Address (socket));
+    onOff.SetAttribute ("PacketSize", ns3::UintegerValue (m_packetSize));
+    onOff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+    onOff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+    onOff.SetAttribute ("DataRate", ns3::DataRateValue (ns3::DataRate ("20kb/s")));
+    ns3::ApplicationContainer app = onOff.Install (m_nodes);
+    app.Start(ns3::Seconds (0.0));
+    app.Stop(ns3::Seconds (4.05));
+
+    // The first station also sends a few packets of another protocol to a multicast group, which must not be
+    // aggregated with the broadcast packets since the subframes share the MAC header of the frame
+    ns3::PacketSocketAddress group;
+    group.SetAllDevices();
+    group.SetPhysicalAddress(m_group);
+    group.SetProtocol(2);
+    ns3::OnOffHelper multicast ("ns3::PacketSocketFactory", ns3::Address (group));
+    multicast.SetAttribute ("PacketSize", ns3::UintegerValue (m_groupPacketSize));
+    multicast.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+    multicast.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+    multicast.SetAttribute ("DataRate", ns3::DataRateValue (ns3::DataRate ("2kb/s")));
+    ns3::ApplicationContainer groupApp = multicast.Install (m_nodes.Get(0));
+    groupApp.Start(ns3::Seconds (0.0));
+    groupApp.Stop(ns3::Seconds (4.05));
+
+    ns3::PacketSocketAddress local;
+    local.SetAllDevices();
+    local.SetProtocol(1);
+    ns3::PacketSinkHelper sink ("ns3::PacketSocketFactory", ns3::Address (local));
+    ns3::ApplicationContainer sinks = sink.Install (m_nodes);
+    sinks.Start(ns3::Seconds (0.0));
+
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Tx", ns3::MakeCallback (&stdma::StdmaAggregationTest::StdmaTxTrace, this) );
+    ns3::Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::PacketSink/Rx", ns3::MakeCallback (&stdma::StdmaAggregationTest::SinkRxTrace, this) );
+
+    ns3::Simulator::Stop(ns3::Seconds(4.05));
+    ns3::Simulator::Run ();
+    ns3::Simulator::Destroy ();
+    ns3::Config::SetDefault ("stdma::StdmaMac::Aggregation", ns3::BooleanValue(false));
+
+    NS_TEST_EXPECT_MSG_GT (m_frames, 0, "The stations should have transmitted frames");
+    NS_TEST_EXPECT_MSG_GT (m_packets, 4 * m_frames, "The frames should carry several packets each");
+    NS_TEST_EXPECT_MSG_GT (m_groupPackets, 0, "The multicast packets should have been received");
+    NS_TEST_EXPECT_MSG_EQ (m_misaddressed, 0, "Every packet should be received with its own destination address");
+  }
+
+  void
+  StdmaAggregationTest::StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset)
+  {
+    NS_TEST_EXPECT_MSG_LT (p->GetSize(), 401, "The aggregated frame should not exceed the maximum packet size");
+    m_frames++;
+  }
+
+  void
+  StdmaAggregationTest::SinkRxTrace (ns3::Ptr<const ns3::Packet> p, const ns3::Address &from)
+  {
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize(), m_packetSize, "The packets should have been de-aggregated");
+    m_packets++;
+  }
+
+  bool
+  StdmaAggregationTest::PromiscRx (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<const ns3::Packet> p, uint16_t protocol,
+                                   const ns3::Address &from, const ns3::Address &to, ns3::NetDevice::PacketType type)
+  {
+    ns3::Mac48Address destination = ns3::Mac48Address::ConvertFrom(to);
+    if (p->GetSize() == m_groupPacketSize)
+      {
+        m_groupPackets++;
+        m_misaddressed += (destination != m_group);
+      }
+    else
+      {
+        m_misaddressed += (destination != ns3::Mac48Address::GetBroadcast());
+      }
+    return true;
+  }
+
+} // namespace stdma
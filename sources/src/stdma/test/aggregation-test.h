@@ -0,0 +1,61 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef AGGREGATION_TEST_H_
+#define AGGREGATION_TEST_H_
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device.h"
+
+namespace stdma {
+
+class StdmaAggregationTest : public ns3::TestCase
+{
+public:
+  StdmaAggregationTest ();
+
+  virtual void DoRun (void);
+  void StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset);
+  void SinkRxTrace (ns3::Ptr<const ns3::Packet> p, const ns3::Address &from);
+  bool PromiscRx (ns3::Ptr<ns3::NetDevice> device, ns3::Ptr<const ns3::Packet> p, uint16_t protocol,
+                  const ns3::Address &from, const ns3::Address &to, ns3::NetDevice::PacketType type);
+
+private:
+  uint32_t m_frames;
+  uint32_t m_packets;
+  uint32_t m_packetSize;
+  uint32_t m_groupPacketSize;
+  ns3::Mac48Address m_group;    // Multicast group of the packets of the second protocol
+  uint32_t m_groupPackets;
+  uint32_t m_misaddressed;      // Packets received with the destination of another packet
+
+
+};
+
+} // namespace stdma
+
+#endif /* AGGREGATION_TEST_H_ */
@@ -0,0 +1,78 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/stdma-module.h"
+#include "frame-statistics-test.h"
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaFrameStatisticsTest::StdmaFrameStatisticsTest ()
+    : ns3::TestCase ("StdmaFrameStatisticsTest")
+  {
+  }
+
+  void
+  StdmaFrameStatisticsTest::DoRun (void)
+  {
+    ns3::Ptr<StdmaSlotManager> manager = Create<StdmaSlotManager>();
+    manager->Setup(ns3::Seconds(1.0), ns3::Seconds(1.0), ns3::NanoSeconds(566000.0), 4);
+    uint32_t numSlots = manager->GetSlotsPerFrame();
+
+    manager->SetReportRate(4);
+    manager->SetSelectionIntervalRatio(0.2);
+    manager->SelectNominalSlots();
+    for (uint32_t n = 0; n < 4; n++)
+      {
+        manager->SelectTransmissionSlotForReservationWithNo(n, 5);
+      }
+    manager->ChangeReportRate(3, 5);
+
+    // The frame statistics count every slot selection of the frame and partition the frame by slot state
+    StdmaFrameStatistics statistics = manager->GetFrameStatistics();
+    NS_TEST_EXPECT_MSG_EQ (3, statistics.internalSlots, "The slots of the current reservations should be counted as internal.");
+    NS_TEST_EXPECT_MSG_EQ (numSlots - 3, statistics.freeSlots, "All other slots should be counted as free.");
+    NS_TEST_EXPECT_MSG_EQ (0, statistics.busySlots + statistics.allocatedSlots + statistics.collisions, "No other station uses the channel.");
+    NS_TEST_EXPECT_MSG_GT (statistics.reservations, 3, "The initial reservations and those of the rate change should be counted.");
+    uint32_t selections = 0;
+    for (uint32_t bin = 0; bin < StdmaFrameStatistics::HISTOGRAM_BINS; bin++)
+      {
+        selections += statistics.candidateSetSizes[bin];
+      }
+    NS_TEST_EXPECT_MSG_EQ (statistics.reservations + statistics.reReservations, selections, "Every slot selection should be counted in the histogram.");
+    NS_TEST_EXPECT_MSG_EQ (0, StdmaFrameStatistics::GetCandidateSetSizeBin(1), "Single candidates should be counted in the first bin.");
+    NS_TEST_EXPECT_MSG_EQ (2, StdmaFrameStatistics::GetCandidateSetSizeBin(7), "Seven candidates should be counted in the third bin.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaFrameStatistics::HISTOGRAM_BINS - 1, StdmaFrameStatistics::GetCandidateSetSizeBin(100000), "Large candidate sets should be counted in the last bin.");
+
+    // A slot halfway between two nominal slots is outside of every selection interval
+    manager->MarkSlotAsBusy((manager->m_nss[1] + manager->m_ni / 2) % numSlots);
+    manager->UpdateSlotObservations(1);
+    const StdmaFrameStatistics &last = manager->GetLastFrameStatistics();
+    NS_TEST_EXPECT_MSG_EQ (statistics.frame, last.frame, "The statistics of the completed frame should be kept.");
+    NS_TEST_EXPECT_MSG_EQ (statistics.reservations, last.reservations, "The statistics of the completed frame should be kept.");
+    NS_TEST_EXPECT_MSG_EQ (1, last.busySlots, "The busy slot should be counted when the frame is completed.");
+    NS_TEST_EXPECT_MSG_EQ (0, manager->GetFrameStatistics().reservations, "The counters should start from scratch in the next frame.");
+  }
+
+} // namespace stdma
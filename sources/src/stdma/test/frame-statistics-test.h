@@ -0,0 +1,44 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef FRAME_STATISTICS_TEST_H_
+#define FRAME_STATISTICS_TEST_H_
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+
+namespace stdma {
+
+/**
+ * Checks the per-frame statistics of a slot manager that selects and changes its reservations without
+ * running the simulator
+ */
+class StdmaFrameStatisticsTest : public ns3::TestCase
+{
+public:
+  StdmaFrameStatisticsTest ();
+
+  virtual void DoRun (void);
+};
+
+} // namespace stdma
+
+#endif /* FRAME_STATISTICS_TEST_H_ */
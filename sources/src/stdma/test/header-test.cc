@@ -0,0 +1,101 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/stdma-module.h"
+#include "header-test.h"
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaHeaderTest::StdmaHeaderTest ()
+    : ns3::TestCase ("StdmaHeaderTest")
+  {
+  }
+
+  void
+  StdmaHeaderTest::DoRun (void)
+  {
+    // Absolute positions are exact up to the resolution, and negative coordinates do not wrap. The resolution
+    // is the same for all headers, as configured by the global value.
+    ns3::Config::SetGlobal("StdmaPositionResolution", ns3::DoubleValue(0.01));
+    StdmaHeader hdr;
+    NS_TEST_EXPECT_MSG_EQ (hdr.GetResolution(), 0.01, "The header should use the global resolution");
+    hdr.SetLatitude(-1234.567);
+    hdr.SetLongitude(98765.4321);
+    hdr.SetOffset(0x3fff);
+    hdr.SetTimeout(8);
+    hdr.SetNetworkEntry();
+    NS_TEST_EXPECT_MSG_EQ (hdr.GetSerializedSize(), 11, "An absolute position report should take 11 bytes");
+    ns3::Ptr<ns3::Packet> packet = ns3::Create<ns3::Packet>(10);
+    packet->AddHeader(hdr);
+    NS_TEST_EXPECT_MSG_EQ (packet->GetSize(), 21, "The header should have been serialized into 11 bytes");
+    StdmaHeader rx;
+    packet->RemoveHeader(rx);
+    ns3::Config::SetGlobal("StdmaPositionResolution", ns3::DoubleValue(0.1));
+    NS_TEST_EXPECT_MSG_EQ (rx.GetPositionCoding(), StdmaHeader::ABSOLUTE, "The report should be absolute");
+    NS_TEST_EXPECT_MSG_EQ_TOL (rx.GetLatitude(), -1234.57, 1e-9, "The latitude should be rounded to the resolution");
+    NS_TEST_EXPECT_MSG_EQ_TOL (rx.GetLongitude(), 98765.43, 1e-9, "The longitude should be rounded to the resolution");
+    NS_TEST_EXPECT_MSG_EQ (rx.GetOffset(), 0x3fff, "The offset should use all 14 bits");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t) rx.GetTimeout(), 8, "The timeout should be decoded");
+    NS_TEST_EXPECT_MSG_EQ (rx.GetNetworkEntry(), true, "The network entry flag should be decoded");
+    NS_TEST_EXPECT_MSG_EQ (rx.GetAggregated(), false, "The aggregation flag should not be set");
+
+    // A key report carries the key in addition
+    StdmaHeader key;
+    key.SetLatitude(500.0);
+    key.SetLongitude(-20.0);
+    key.SetPositionKey(7);
+    key.SetAggregated();
+    NS_TEST_EXPECT_MSG_EQ (key.GetSerializedSize(), 12, "A key report should take 12 bytes");
+    packet = ns3::Create<ns3::Packet>(0);
+    packet->AddHeader(key);
+    rx = StdmaHeader();
+    packet->RemoveHeader(rx);
+    NS_TEST_EXPECT_MSG_EQ (rx.GetPositionCoding(), StdmaHeader::KEY, "The report should be a key report");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t) rx.GetPositionKey(), 7, "The key should be decoded");
+    NS_TEST_EXPECT_MSG_EQ (rx.GetNetworkEntry(), false, "The network entry flag should not be set");
+    NS_TEST_EXPECT_MSG_EQ (rx.GetAggregated(), true, "The aggregation flag should be decoded");
+
+    // A delta report is relative to the key position and resolved by the receiver
+    StdmaHeader delta;
+    delta.SetLatitude(503.1);
+    delta.SetLongitude(-25.4);
+    NS_TEST_EXPECT_MSG_EQ (delta.SetPositionDelta(7, 500.0, -20.0), true, "The difference should fit into a delta report");
+    NS_TEST_EXPECT_MSG_EQ (delta.GetSerializedSize(), 8, "A delta report should take 8 bytes");
+    packet = ns3::Create<ns3::Packet>(0);
+    packet->AddHeader(delta);
+    rx = StdmaHeader();
+    packet->RemoveHeader(rx);
+    NS_TEST_EXPECT_MSG_EQ (rx.GetPositionCoding(), StdmaHeader::DELTA, "The report should be a delta report");
+    NS_TEST_EXPECT_MSG_EQ ((uint32_t) rx.GetPositionKey(), 7, "The referenced key should be decoded");
+    rx.ResolvePositionDelta(500.0, -20.0);
+    NS_TEST_EXPECT_MSG_EQ_TOL (rx.GetLatitude(), 503.1, 1e-9, "The latitude should be resolved");
+    NS_TEST_EXPECT_MSG_EQ_TOL (rx.GetLongitude(), -25.4, 1e-9, "The longitude should be resolved");
+
+    // Differences beyond 16 bits can not be delta coded
+    delta.SetLatitude(500.0 + 3300.0);
+    NS_TEST_EXPECT_MSG_EQ (delta.SetPositionDelta(8, 500.0, -20.0), false, "The difference should not fit into a delta report");
+  }
+
+} // namespace stdma
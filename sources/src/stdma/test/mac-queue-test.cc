@@ -0,0 +1,99 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/llc-snap-header.h"
+#include "mac-queue-test.h"
+
+using namespace ns3;
+
+namespace stdma {
+
+  static ns3::Ptr<ns3::Packet>
+  CreateFlowPacket (uint16_t protocol, uint32_t size)
+  {
+    ns3::Ptr<ns3::Packet> packet = ns3::Create<ns3::Packet>(size);
+    ns3::LlcSnapHeader llc;
+    llc.SetType(protocol);
+    packet->AddHeader(llc);
+    return packet;
+  }
+
+  StdmaMacQueueTest::StdmaMacQueueTest ()
+    : ns3::TestCase ("StdmaMacQueueTest"),
+      m_drops(0)
+  {
+  }
+
+  void
+  StdmaMacQueueTest::DoRun (void)
+  {
+    ns3::WifiMacHeader hdr;
+    ns3::Ptr<StdmaMacQueue> queue = ns3::CreateObject<StdmaMacQueue>();
+    queue->TraceConnectWithoutContext("Drop", ns3::MakeCallback(&StdmaMacQueueTest::DropTrace, this));
+    queue->SetMaxSize(3);
+    NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty(), true, "A new queue should be empty");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), 0, "An empty queue should not return a packet");
+
+    // First in, first out, and the oldest packet is dropped if the queue is full
+    ns3::Ptr<ns3::Packet> packets[4];
+    for (uint32_t i = 0; i < 4; i++)
+      {
+        packets[i] = CreateFlowPacket(1, 10 + i);
+        queue->Enqueue(packets[i], hdr);
+      }
+    NS_TEST_EXPECT_MSG_EQ (queue->GetSize(), 3, "The queue should be bounded");
+    NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "The oldest packet should have been dropped");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), packets[1], "The queue should be first in, first out");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), packets[2], "The queue should be first in, first out");
+    queue->Enqueue(packets[0], hdr);
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), packets[3], "The ring buffer should wrap around");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), packets[0], "The ring buffer should wrap around");
+    NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty(), true, "The queue should be empty again");
+
+    // With latest wins, a new packet replaces the queued packet of its flow in place
+    m_drops = 0;
+    queue->SetAttribute("LatestWins", ns3::BooleanValue(true));
+    ns3::Ptr<ns3::Packet> cam = CreateFlowPacket(1, 100);
+    ns3::Ptr<ns3::Packet> denm = CreateFlowPacket(2, 200);
+    ns3::Ptr<ns3::Packet> tagged = CreateFlowPacket(1, 300);
+    tagged->AddPacketTag(StdmaFlowTag(7));
+    ns3::Ptr<ns3::Packet> newerCam = CreateFlowPacket(1, 101);
+    queue->Enqueue(cam, hdr);
+    queue->Enqueue(denm, hdr);
+    queue->Enqueue(tagged, hdr);
+    queue->Enqueue(newerCam, hdr);
+    NS_TEST_EXPECT_MSG_EQ (queue->GetSize(), 3, "The newer packet should have replaced the older one of its flow");
+    NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "The replaced packet should have been reported as dropped");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), newerCam, "The newer packet should take the position of the replaced one");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), denm, "The other flows should be kept");
+    NS_TEST_EXPECT_MSG_EQ (queue->Dequeue(&hdr), tagged, "The tag should define a flow of its own");
+    queue->Dispose();
+  }
+
+  void
+  StdmaMacQueueTest::DropTrace (ns3::Ptr<const ns3::Packet> p)
+  {
+    m_drops++;
+  }
+
+} // namespace stdma
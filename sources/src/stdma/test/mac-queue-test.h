@@ -0,0 +1,47 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef MAC_QUEUE_TEST_H_
+#define MAC_QUEUE_TEST_H_
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+namespace stdma {
+
+class StdmaMacQueueTest : public ns3::TestCase
+{
+public:
+  StdmaMacQueueTest ();
+
+  virtual void DoRun (void);
+  void DropTrace (ns3::Ptr<const ns3::Packet> p);
+
+private:
+  uint32_t m_drops;
+
+};
+
+} // namespace stdma
+
+#endif /* MAC_QUEUE_TEST_H_ */
@@ -0,0 +1,156 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/mobility-module.h"
+#include "report-rate-test.h"
+#include "stdma-test-utils.h"
+
+#include <algorithm>
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaReportRateTest::StdmaReportRateTest ()
+    : ns3::TestCase ("StdmaReportRateTest")
+  {
+    for (uint32_t i = 0; i < 2; i++)
+      {
+        m_tx[i] = 0;
+        m_changes[i] = 0;
+        m_rate[i] = 0;
+      }
+  }
+
+  void
+  StdmaReportRateTest::DoRun (void)
+  {
+    ns3::SeedManager::SetSeed (1);
+
+    stdma::StdmaHelper stdma;
+    stdma.SetStandard(ns3::WIFI_PHY_STANDARD_80211p_CCH);
+    SetTwoStationsDefaults(ns3::UniformVariable(3, 7));
+
+    // Create two network nodes next to each other, which transmit keep-alive reports only
+    ns3::NodeContainer m_nodes;
+    ns3::NetDeviceContainer devices = InstallTwoStations(stdma, CreateTwoStationsPhy(), m_nodes);
+
+    // The first station halves its report rate through the congestion control callback, the second station
+    // doubles it explicitly in the middle of the third frame
+    ns3::Ptr<StdmaMac> first = devices.Get(0)->GetObject<StdmaNetDevice>()->GetMac();
+    ns3::Ptr<StdmaMac> second = devices.Get(1)->GetObject<StdmaNetDevice>()->GetMac();
+    first->SetReportRateCallback(ns3::MakeCallback(&stdma::StdmaReportRateTest::AdaptReportRate, this));
+    ns3::Simulator::Schedule(ns3::Seconds(2.5), &StdmaMac::SetReportRate, second, 20);
+
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Tx", ns3::MakeCallback (&stdma::StdmaReportRateTest::StdmaTxTrace, this) );
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/ReportRateChange", ns3::MakeCallback (&stdma::StdmaReportRateTest::ReportRateChangeTrace, this) );
+
+    ns3::Simulator::Stop(ns3::Seconds(6.0));
+    ns3::Simulator::Run ();
+    ns3::Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_EQ (1, m_changes[0], "The first station should have changed its report rate once");
+    NS_TEST_EXPECT_MSG_EQ (5, m_rate[0], "The first station should have halved its report rate");
+    NS_TEST_EXPECT_MSG_EQ (1, m_changes[1], "The second station should have changed its report rate once");
+    NS_TEST_EXPECT_MSG_EQ (20, m_rate[1], "The second station should have doubled its report rate");
+    // Reservations that are re-selected may move within their selection interval across the frame boundary
+    NS_TEST_EXPECT_MSG_EQ_TOL (5, m_tx[0], 1, "The first station should transmit at its new report rate");
+    NS_TEST_EXPECT_MSG_EQ_TOL (20, m_tx[1], 1, "The second station should transmit at its new report rate");
+  }
+
+  uint8_t
+  StdmaReportRateTest::AdaptReportRate (double load)
+  {
+    NS_TEST_EXPECT_MSG_GT (load, 0, "The own reservations should account for some channel load");
+    return 5;
+  }
+
+  void
+  StdmaReportRateTest::StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset)
+  {
+    // Count the transmissions of the last frame of the simulation
+    if (ns3::Simulator::Now() >= ns3::Seconds(5.0))
+      {
+        m_tx[GetNodeId(context)]++;
+      }
+  }
+
+  void
+  StdmaReportRateTest::ReportRateChangeTrace (std::string context, uint8_t previous, uint8_t rate)
+  {
+    uint32_t id = GetNodeId(context);
+    NS_TEST_EXPECT_MSG_EQ (10, previous, "Both stations should start with the configured report rate");
+    m_changes[id]++;
+    m_rate[id] = rate;
+  }
+
+  StdmaChangeReportRateTest::StdmaChangeReportRateTest ()
+    : ns3::TestCase ("StdmaChangeReportRateTest")
+  {
+  }
+
+  void
+  StdmaChangeReportRateTest::DoRun (void)
+  {
+    ns3::Ptr<StdmaSlotManager> manager = Create<StdmaSlotManager>();
+    manager->Setup(ns3::Seconds(1.0), ns3::Seconds(1.0), ns3::NanoSeconds(566000.0), 4);
+    uint32_t numSlots = manager->GetSlotsPerFrame();
+
+    // Changing the report rate at runtime keeps the slot of the reservation to be transmitted next, selects or
+    // releases reservations such that each one lies within the selection interval of its new nominal slot
+    manager->SetReportRate(4);
+    manager->SetSelectionIntervalRatio(0.2);
+    manager->SelectNominalSlots();
+    for (uint32_t n = 0; n < 4; n++)
+      {
+        manager->SelectTransmissionSlotForReservationWithNo(n, 5);
+      }
+    NS_TEST_EXPECT_MSG_EQ_TOL (4.0 / numSlots, manager->GetChannelLoad(), 1e-9, "The channel load should account for the four reserved slots.");
+    uint32_t rates[] = { 8, 2, 3 };
+    for (uint32_t k = 0; k < 3; k++)
+      {
+        uint32_t anchor = manager->GetSlotIndexOfReservationWithNo(manager->m_current);
+        manager->ChangeReportRate(rates[k], 5);
+        NS_TEST_EXPECT_MSG_EQ (rates[k], manager->m_selections.size(), "There should be one reservation per report of the new rate.");
+        NS_TEST_EXPECT_MSG_EQ (anchor, manager->GetSlotIndexOfReservationWithNo(0), "The reservation to be transmitted next should keep its slot.");
+        NS_TEST_EXPECT_MSG_EQ (0, manager->GetCurrentReservationNo(), "The reservation to be transmitted next should become the first one.");
+        uint32_t internal = 0;
+        for (uint32_t index = 0; index < numSlots; index++)
+          {
+            internal += manager->GetSlot(index).IsInternallyAllocated() ? 1 : 0;
+          }
+        NS_TEST_EXPECT_MSG_EQ (rates[k], internal, "Exactly the slots of the new reservations should be internally allocated.");
+        for (uint32_t n = 1; n < rates[k]; n++)
+          {
+            uint32_t index = manager->GetSlotIndexOfReservationWithNo(n);
+            uint32_t distance = (index + numSlots - manager->m_nss[n]) % numSlots;
+            distance = std::min(distance, numSlots - distance);
+            NS_TEST_EXPECT_MSG_LT (distance, manager->m_siHalf + 1, "Every reservation should lie within the selection interval of its nominal slot.");
+            NS_TEST_EXPECT_MSG_GT (manager->CalculateSlotOffsetBetweenTransmissions(n - 1, n), 0, "The reservations should follow each other within the frame.");
+          }
+      }
+  }
+
+} // namespace stdma
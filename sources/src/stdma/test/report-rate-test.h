@@ -0,0 +1,66 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef REPORT_RATE_TEST_H_
+#define REPORT_RATE_TEST_H_
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+#include <string>
+
+namespace stdma {
+
+class StdmaReportRateTest : public ns3::TestCase
+{
+public:
+  StdmaReportRateTest ();
+
+  virtual void DoRun (void);
+  void StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset);
+  void ReportRateChangeTrace (std::string context, uint8_t previous, uint8_t rate);
+  uint8_t AdaptReportRate (double load);
+
+private:
+  uint32_t m_tx[2];
+  uint32_t m_changes[2];
+  uint8_t m_rate[2];
+
+};
+
+/**
+ * Changes the report rate of a slot manager several times without running the simulator and checks the
+ * reservations that are kept, released and selected
+ */
+class StdmaChangeReportRateTest : public ns3::TestCase
+{
+public:
+  StdmaChangeReportRateTest ();
+
+  virtual void DoRun (void);
+};
+
+} // namespace stdma
+
+#endif /* REPORT_RATE_TEST_H_ */
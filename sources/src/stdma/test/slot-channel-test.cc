@@ -0,0 +1,214 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/mobility-module.h"
+#include "slot-channel-test.h"
+#include "stdma-test-utils.h"
+
+#include <string.h>
+#include <cmath>
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaSlotChannelLookaheadTest::StdmaSlotChannelLookaheadTest ()
+    : ns3::TestCase ("StdmaSlotChannelLookaheadTest"),
+      m_lookahead(ns3::MicroSeconds(500)),
+      m_slotDuration(ns3::Seconds(0)),
+      m_rx(0),
+      m_late(0)
+  {
+    m_lastTx[0] = ns3::Seconds(0);
+    m_lastTx[1] = ns3::Seconds(0);
+  }
+
+  void
+  StdmaSlotChannelLookaheadTest::DoRun (void)
+  {
+    // Positions are mapped to the segments of the systems
+    std::vector<double> bounds;
+    bounds.push_back(0.0);
+    bounds.push_back(1000.0);
+    bounds.push_back(2000.0);
+    NS_TEST_EXPECT_MSG_EQ (0, StdmaSlotChannel::GetSegment(bounds, -10.0), "Positions before the first border belong to the first segment");
+    NS_TEST_EXPECT_MSG_EQ (0, StdmaSlotChannel::GetSegment(bounds, 999.0), "The first segment ends at the second border");
+    NS_TEST_EXPECT_MSG_EQ (1, StdmaSlotChannel::GetSegment(bounds, 1000.0), "The second segment starts at the second border");
+    NS_TEST_EXPECT_MSG_EQ (1, StdmaSlotChannel::GetSegment(bounds, 2500.0), "Positions after the last border belong to the last segment");
+
+    ns3::SeedManager::SetSeed (1);
+
+    stdma::StdmaHelper stdma;
+    stdma.SetStandard(ns3::WIFI_PHY_STANDARD_80211p_CCH);
+    SetTwoStationsDefaults(ns3::UniformVariable(3, 7));
+
+    // Two stations on a slot channel that resolves each slot after the lookahead, as it does when it spans
+    // several systems of the distributed simulator
+    ns3::Ptr<stdma::StdmaSlotChannel> channel = ns3::CreateObject<stdma::StdmaSlotChannel>();
+    channel->SetPropagationLossModel(ns3::CreateObject<ns3::LogDistancePropagationLossModel>());
+    channel->SetAttribute("Lookahead", ns3::TimeValue(m_lookahead));
+    stdma::StdmaSlotPhyHelper slotPhy = stdma::StdmaSlotPhyHelper::Default();
+    slotPhy.SetChannel(channel);
+    ns3::NodeContainer m_nodes;
+    InstallTwoStations(stdma, slotPhy, m_nodes);
+
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Startup", ns3::MakeCallback (&stdma::StdmaSlotChannelLookaheadTest::StdmaStartupTrace, this) );
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Tx", ns3::MakeCallback (&stdma::StdmaSlotChannelLookaheadTest::StdmaTxTrace, this) );
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/NetworkEntry", ns3::MakeCallback (&stdma::StdmaSlotChannelLookaheadTest::StdmaNetworkEntryTrace, this) );
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Rx", ns3::MakeCallback (&stdma::StdmaSlotChannelLookaheadTest::StdmaRxTrace, this) );
+
+    ns3::Simulator::Stop(ns3::Seconds(4.0));
+    ns3::Simulator::Run ();
+    ns3::Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_LT (m_lookahead, m_slotDuration, "The lookahead of the test should be shorter than a slot");
+    NS_TEST_EXPECT_MSG_GT (m_rx, 50, "The stations should receive each other");
+    NS_TEST_EXPECT_MSG_EQ (0, m_late, "Every slot should be resolved just after the lookahead");
+  }
+
+  void
+  StdmaSlotChannelLookaheadTest::StdmaStartupTrace (std::string context, ns3::Time when, ns3::Time frameDuration, ns3::Time slotDuration)
+  {
+    m_slotDuration = slotDuration;
+  }
+
+  void
+  StdmaSlotChannelLookaheadTest::StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset)
+  {
+    m_lastTx[GetNodeId(context)] = ns3::Simulator::Now();
+  }
+
+  void
+  StdmaSlotChannelLookaheadTest::StdmaNetworkEntryTrace (std::string context, ns3::Ptr<const ns3::Packet> p, ns3::Time delay, bool isTaken)
+  {
+    m_lastTx[GetNodeId(context)] = ns3::Simulator::Now();
+  }
+
+  void
+  StdmaSlotChannelLookaheadTest::StdmaRxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint8_t timeout, uint32_t offset)
+  {
+    m_rx++;
+    if (ns3::Simulator::Now() != m_lastTx[1 - GetNodeId(context)] + m_lookahead + ns3::NanoSeconds(1))
+      {
+        m_late++;
+      }
+  }
+
+  StdmaSlotChannelEncodingTest::StdmaSlotChannelEncodingTest ()
+    : ns3::TestCase ("StdmaSlotChannelEncodingTest")
+  {
+  }
+
+  void
+  StdmaSlotChannelEncodingTest::DoRun (void)
+  {
+    ns3::Ptr<StdmaSlotChannel> channel = ns3::CreateObject<StdmaSlotChannel>();
+    channel->Add(ns3::CreateObject<StdmaSlotPhy>());
+    channel->Add(ns3::CreateObject<StdmaSlotPhy>());
+
+    uint8_t payload[300];
+    for (uint32_t k = 0; k < sizeof(payload); k++)
+      {
+        payload[k] = k * 7;
+      }
+    ns3::Ptr<ns3::ConstantPositionMobilityModel> mobility = ns3::CreateObject<ns3::ConstantPositionMobilityModel>();
+    mobility->SetPosition(ns3::Vector(1234.5, -6.25, 1.5));
+
+    StdmaSlotChannel::Transmission tx;
+    tx.sender = 1;
+    tx.mobility = mobility;
+    tx.packet = ns3::Create<ns3::Packet>(payload, sizeof(payload));
+    tx.txPowerDbm = 23.5;
+    tx.mode = ns3::WifiPhy::GetOfdmRate6MbpsBW10MHz();
+    tx.preamble = ns3::WIFI_PREAMBLE_SHORT;
+    tx.duration = ns3::MicroSeconds(432);
+
+    // Two records are concatenated within one message, the second one with an empty packet
+    StdmaSlotChannel::Transmission empty = tx;
+    empty.sender = 0;
+    empty.packet = ns3::Create<ns3::Packet>();
+    empty.mode = ns3::WifiPhy::GetOfdmRate27MbpsBW10MHz();
+    channel->DecodeTransmissions(StdmaSlotChannel::EncodeTransmission(tx) + StdmaSlotChannel::EncodeTransmission(empty));
+
+    NS_TEST_ASSERT_MSG_EQ (channel->m_transmissions.size(), 2, "Both records should have been decoded");
+    const StdmaSlotChannel::Transmission &first = channel->m_transmissions[0];
+    NS_TEST_EXPECT_MSG_EQ (first.sender, 1, "The sender should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.mobility->GetPosition().x, 1234.5, "The x coordinate should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.mobility->GetPosition().y, -6.25, "The y coordinate should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.mobility->GetPosition().z, 1.5, "The z coordinate should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.txPowerDbm, 23.5, "The transmission power should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.mode, tx.mode, "The mode should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.preamble, ns3::WIFI_PREAMBLE_SHORT, "The preamble should be restored");
+    NS_TEST_EXPECT_MSG_EQ (first.duration, ns3::MicroSeconds(432), "The duration should be restored");
+    NS_TEST_ASSERT_MSG_EQ (first.packet->GetSize(), sizeof(payload), "The packet size should be restored");
+    uint8_t copy[sizeof(payload)];
+    first.packet->CopyData(copy, sizeof(copy));
+    NS_TEST_EXPECT_MSG_EQ (memcmp(copy, payload, sizeof(payload)), 0, "The packet content should be restored");
+
+    const StdmaSlotChannel::Transmission &second = channel->m_transmissions[1];
+    NS_TEST_EXPECT_MSG_EQ (second.sender, 0, "The sender of the second record should be restored");
+    NS_TEST_EXPECT_MSG_EQ (second.mode, empty.mode, "The mode of the second record should be restored");
+    NS_TEST_EXPECT_MSG_EQ (second.packet->GetSize(), 0, "The empty packet should be restored");
+
+    channel->Dispose();
+    ns3::Simulator::Destroy ();
+  }
+
+  StdmaSlotChannelErrorRateTest::StdmaSlotChannelErrorRateTest ()
+    : ns3::TestCase ("StdmaSlotChannelErrorRateTest")
+  {
+  }
+
+  void
+  StdmaSlotChannelErrorRateTest::DoRun (void)
+  {
+    ns3::Ptr<StdmaSlotChannel> channel = ns3::CreateObject<StdmaSlotChannel>();
+    ns3::Ptr<StdmaSlotPhy> yans = ns3::CreateObject<StdmaSlotPhy>();
+    yans->SetErrorRateModel(ns3::CreateObject<ns3::YansErrorRateModel>());
+    ns3::Ptr<StdmaSlotPhy> nist = ns3::CreateObject<StdmaSlotPhy>();
+    nist->SetErrorRateModel(ns3::CreateObject<ns3::NistErrorRateModel>());
+
+    // 4 dB is an entry of the default tables, which is returned without interpolation
+    ns3::WifiMode mode = ns3::WifiPhy::GetOfdmRate6MbpsBW10MHz();
+    double snr = std::pow(10.0, 0.4);
+    double yansPer = 1.0 - yans->GetErrorRateModel()->GetChunkSuccessRate(mode, snr, 800);
+    double nistPer = 1.0 - nist->GetErrorRateModel()->GetChunkSuccessRate(mode, snr, 800);
+    NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetPacketErrorRate(yans, mode, 800, snr), yansPer, 1e-9, "The table should be built from the model of the first receiver");
+    NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetPacketErrorRate(nist, mode, 800, snr), nistPer, 1e-9, "A receiver with another model should not use the table of the first one");
+    NS_TEST_EXPECT_MSG_EQ (channel->m_perTables.size(), 2, "There should be one table per error rate model");
+
+    channel->SetAttribute("SnrStep", ns3::DoubleValue(0.5));
+    NS_TEST_EXPECT_MSG_EQ (channel->m_perTables.size(), 0, "Changing the step should discard all tables");
+    NS_TEST_EXPECT_MSG_EQ_TOL (channel->GetPacketErrorRate(yans, mode, 800, snr), yansPer, 1e-9, "The table should be built again with the new step");
+    channel->GetPacketErrorRate(yans, mode, 800, snr);
+    channel->SetAttribute("MinimumSnr", ns3::DoubleValue(0.0));
+    NS_TEST_EXPECT_MSG_EQ (channel->m_perTables.size(), 0, "Changing the minimum SNR should discard all tables");
+    channel->GetPacketErrorRate(yans, mode, 800, snr);
+    channel->SetAttribute("SnrEntries", ns3::UintegerValue(50));
+    NS_TEST_EXPECT_MSG_EQ (channel->m_perTables.size(), 0, "Changing the number of entries should discard all tables");
+    channel->Dispose();
+  }
+
+} // namespace stdma
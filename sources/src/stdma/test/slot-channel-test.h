@@ -0,0 +1,81 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef SLOT_CHANNEL_TEST_H_
+#define SLOT_CHANNEL_TEST_H_
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+#include <string>
+
+namespace stdma {
+
+class StdmaSlotChannelLookaheadTest : public ns3::TestCase
+{
+public:
+  StdmaSlotChannelLookaheadTest ();
+
+  virtual void DoRun (void);
+  void StdmaStartupTrace (std::string context, ns3::Time when, ns3::Time frameDuration, ns3::Time slotDuration);
+  void StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset);
+  void StdmaNetworkEntryTrace (std::string context, ns3::Ptr<const ns3::Packet> p, ns3::Time delay, bool isTaken);
+  void StdmaRxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint8_t timeout, uint32_t offset);
+
+private:
+  ns3::Time m_lookahead;
+  ns3::Time m_slotDuration;
+  ns3::Time m_lastTx[2];
+  uint32_t m_rx;
+  uint32_t m_late;
+
+};
+
+/**
+ * Round-trips transmissions through the records that the slot channel exchanges between the systems of the
+ * distributed simulator, without running the simulator in parallel
+ */
+class StdmaSlotChannelEncodingTest : public ns3::TestCase
+{
+public:
+  StdmaSlotChannelEncodingTest ();
+
+  virtual void DoRun (void);
+};
+
+/**
+ * Checks that the packet error rate lookup tables are kept per error rate model and discarded once their
+ * layout changes
+ */
+class StdmaSlotChannelErrorRateTest : public ns3::TestCase
+{
+public:
+  StdmaSlotChannelErrorRateTest ();
+
+  virtual void DoRun (void);
+};
+
+} // namespace stdma
+
+#endif /* SLOT_CHANNEL_TEST_H_ */
@@ -56,14 +56,14 @@ namespace stdma {
 
     for (uint32_t index = 0; index < numSlots; index++)
       {
-        NS_TEST_EXPECT_MSG_EQ (StdmaSlot::FREE, manager->GetSlot(index)->GetState(), "All slots should be free in the beginning.");
+        NS_TEST_EXPECT_MSG_EQ (StdmaSlot::FREE, manager->GetSlot(index).GetState(), "All slots should be free in the beginning.");
       }
     manager->MarkSlotAsBusy(20);
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(20)->GetState(), "The slot should be busy as we have marked it busy in the last instruction.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(20).GetState(), "The slot should be busy as we have marked it busy in the last instruction.");
     ns3::Mac48Address owner("ab:cd:ef:12:34:56");
     manager->MarkSlotAsAllocated(30, 8, owner, ns3::Vector(1.0, 0.0, 0.0), ns3::Seconds(0.0));
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(30)->GetState(), "The slot should be allocated as we have marked it busy in the last instruction.");
-    NS_TEST_EXPECT_MSG_EQ (8, manager->GetSlot(30)->GetTimeout(), "The slot should have a timeout of 8 as we have marked it busy in the last instruction.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(30).GetState(), "The slot should be allocated as we have marked it busy in the last instruction.");
+    NS_TEST_EXPECT_MSG_EQ (8, manager->GetSlot(30).GetTimeout(), "The slot should have a timeout of 8 as we have marked it busy in the last instruction.");
 
     ns3::Time t1 = start + ns3::NanoSeconds(slotDuration.GetNanoSeconds() * 27);
     ns3::Time t2 = start + ns3::NanoSeconds(slotDuration.GetNanoSeconds() * 27.5);
@@ -75,20 +75,51 @@ namespace stdma {
     manager->RebaseFrameStart(newStart);
     NS_TEST_EXPECT_MSG_EQ (15, manager->GetSlotIndexForTimestamp(t1), "After rebasing the slot index for the given time stamp t1 should be 15");
     NS_TEST_EXPECT_MSG_EQ (15, manager->GetSlotIndexForTimestamp(t2), "After rebasing the slot index for the given time stamp t2 should be 15");
+    ns3::Ptr<StdmaSlotClock> clock = CreateObject<StdmaSlotClock>();
+    clock->SetSlotDuration(slotDuration);
+    NS_TEST_EXPECT_MSG_EQ (15, manager->GetSlotIndexForGlobalSlot(clock->GetSlotForTimestamp(t2)), "The global slot of t2 should map to the same slot index as t2 itself");
+    NS_TEST_EXPECT_MSG_EQ (3, manager->GetSlotIndexForGlobalSlot(clock->GetSlotForTimestamp(start) + 3), "Slots prior to the rebased frame start should be counted from the start of the first frame");
 
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(8)->GetState(), "The slot should still be busy after rebase as only the index should have changed.");
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18)->GetState(), "The slot should still be allocated after rebase as only the index should have changed.");
-    NS_TEST_EXPECT_MSG_EQ (8, manager->GetSlot(18)->GetTimeout(), "The slot should still have a timeout of 8 after rebase as only the index should have changed.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(8).GetState(), "The slot should still be busy after rebase as only the index should have changed.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18).GetState(), "The slot should still be allocated after rebase as only the index should have changed.");
+    NS_TEST_EXPECT_MSG_EQ (8, manager->GetSlot(18).GetTimeout(), "The slot should still have a timeout of 8 after rebase as only the index should have changed.");
 
-    manager->UpdateSlotObservations();
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(8)->GetState(), "The slot should still be busy after updating slot observations.");
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18)->GetState(), "The slot should still be allocated after updating slot observations.");
-    NS_TEST_EXPECT_MSG_EQ (7, manager->GetSlot(18)->GetTimeout(), "The slot timeout should now be 7 after updating slot observations.");
+    std::vector<uint32_t> free;
+    std::vector<uint32_t> allocated;
+    NS_TEST_EXPECT_MSG_EQ (numSlots - 2, manager->ScanSlots(0, numSlots, ns3::Seconds(0), ns3::Seconds(0), &free, &allocated), "All but the busy and the allocated slot should be free.");
+    NS_TEST_EXPECT_MSG_EQ (numSlots - 2, free.size(), "Every free slot should have been reported.");
+    NS_TEST_EXPECT_MSG_EQ (1, allocated.size(), "Only one slot should be reported as allocated.");
+    NS_TEST_EXPECT_MSG_EQ (18, allocated[0], "The allocated slot should be reported with its rebased index.");
+    free.clear();
+    NS_TEST_EXPECT_MSG_EQ (19, manager->ScanSlots(numSlots - 2, 20, ns3::Seconds(0), ns3::Seconds(0), &free, 0), "A range wrapping around the end of the frame should skip the busy slot.");
+    NS_TEST_EXPECT_MSG_EQ (numSlots - 2, free[0], "Free slots should be reported in the order of the range.");
+    NS_TEST_EXPECT_MSG_EQ (0, free[2], "Free slots should be reported in the order of the range.");
 
-    manager->UpdateSlotObservations();
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::FREE, manager->GetSlot(8)->GetState(), "After a second count down this slot should be free again.");
-    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18)->GetState(), "The slot should still be allocated after updating slot observations.");
-    NS_TEST_EXPECT_MSG_EQ (6, manager->GetSlot(18)->GetTimeout(), "The slot timeout should now be 6 after updating slot observations.");
+    manager->UpdateSlotObservations(1);
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(8).GetState(), "The slot should still be busy after updating slot observations.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18).GetState(), "The slot should still be allocated after updating slot observations.");
+    NS_TEST_EXPECT_MSG_EQ (7, manager->GetSlot(18).GetTimeout(), "The slot timeout should now be 7 after updating slot observations.");
+
+    manager->UpdateSlotObservations(1);
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::FREE, manager->GetSlot(8).GetState(), "After a second count down this slot should be free again.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18).GetState(), "The slot should still be allocated after updating slot observations.");
+    NS_TEST_EXPECT_MSG_EQ (6, manager->GetSlot(18).GetTimeout(), "The slot timeout should now be 6 after updating slot observations.");
+
+    manager->UpdateSlotObservations(5);
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::ALLOCATED, manager->GetSlot(18).GetState(), "The slot should still be allocated after skipping five frames at once.");
+    NS_TEST_EXPECT_MSG_EQ (1, manager->GetSlot(18).GetTimeout(), "The slot timeout should now be 1 after skipping five frames at once.");
+
+    manager->UpdateSlotObservations(2);
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::FREE, manager->GetSlot(18).GetState(), "The slot should be free again once its timeout has run out.");
+    NS_TEST_EXPECT_MSG_EQ (numSlots, manager->ScanSlots(0, numSlots, ns3::Seconds(0), ns3::Seconds(0), 0, 0), "All slots should be free again once all timeouts have run out.");
+
+    manager->MarkSlotRangeAsBusy(numSlots - 2, 4);
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(numSlots - 2).GetState(), "The first slot of a wrapping range should be busy.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::BUSY, manager->GetSlot(1).GetState(), "The last slot of a wrapping range should be busy.");
+    NS_TEST_EXPECT_MSG_EQ (StdmaSlot::FREE, manager->GetSlot(2).GetState(), "The slot following a wrapping range should still be free.");
+    NS_TEST_EXPECT_MSG_EQ (numSlots - 4, manager->ScanSlots(0, numSlots, ns3::Seconds(0), ns3::Seconds(0), 0, 0), "Exactly the slots of the range should no longer be free.");
+    manager->UpdateSlotObservations(2);
+    NS_TEST_EXPECT_MSG_EQ (numSlots, manager->ScanSlots(0, numSlots, ns3::Seconds(0), ns3::Seconds(0), 0, 0), "Slots marked busy as a range should expire like individually marked slots.");
 
   }
 
@@ -0,0 +1,142 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/mac48-address.h"
+#include "slot-selection-policy-test.h"
+
+#include <algorithm>
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaSlotSelectionPolicyTest::StdmaSlotSelectionPolicyTest ()
+    : ns3::TestCase ("StdmaSlotSelectionPolicyTest")
+  {
+  }
+
+  void
+  StdmaSlotSelectionPolicyTest::DoRun (void)
+  {
+    ns3::Ptr<StdmaSlotManager> manager = Create<StdmaSlotManager>();
+    manager->Setup(ns3::Seconds(1.0), ns3::Seconds(1.0), ns3::NanoSeconds(566000.0), 4);
+    ns3::Ptr<StdmaDistanceSlotSelectionPolicy> policy = CreateObject<StdmaDistanceSlotSelectionPolicy>();
+
+    // Slots 10 to 14 are allocated by stations at distances 5, 1, 4, 2 and 3 meters
+    double distances[] = { 5.0, 1.0, 4.0, 2.0, 3.0 };
+    std::vector<uint32_t> allocated;
+    for (uint32_t i = 0; i < 5; i++)
+      {
+        uint8_t address[6] = { 0, 0, 0, 0, 0, (uint8_t) (i + 1) };
+        ns3::Mac48Address owner;
+        owner.CopyFrom(address);
+        manager->MarkSlotAsAllocated(10 + i, 8, owner, ns3::Vector(distances[i], 0.0, 0.0));
+        allocated.push_back(10 + i);
+      }
+
+    std::vector<uint32_t> candidates;
+    candidates.push_back(3);
+    uint32_t index = policy->SelectSlot(*manager, ns3::Vector(0.0, 0.0, 0.0), candidates, allocated);
+    NS_TEST_EXPECT_MSG_EQ (4, candidates.size(), "The candidate set should have been filled up to the minimum size.");
+    NS_TEST_EXPECT_MSG_EQ (3, candidates[0], "The free slot should remain the first candidate.");
+    NS_TEST_EXPECT_MSG_EQ (10, candidates[1], "The slot of the farthest owner should be added first.");
+    NS_TEST_EXPECT_MSG_EQ (12, candidates[2], "The slot of the second farthest owner should be added second.");
+    NS_TEST_EXPECT_MSG_EQ (14, candidates[3], "The slot of the third farthest owner should be added third.");
+    NS_TEST_EXPECT_MSG_EQ (true, (std::find(candidates.begin(), candidates.end(), index) != candidates.end()), "The selected slot should be one of the candidates.");
+
+    candidates.clear();
+    for (uint32_t i = 0; i < 4; i++)
+      {
+        candidates.push_back(20 + i);
+      }
+    index = policy->SelectSlot(*manager, ns3::Vector(0.0, 0.0, 0.0), candidates, allocated);
+    NS_TEST_EXPECT_MSG_EQ (4, candidates.size(), "No allocated slot should be added if enough free slots are available.");
+    NS_TEST_EXPECT_MSG_EQ (true, (index >= 20 && index < 24), "The selected slot should be one of the free slots.");
+
+    // The distance policy ignores the received power
+    double powers[] = { -70.0, -95.0, -80.0, -90.0, -60.0 };
+    for (uint32_t i = 0; i < 5; i++)
+      {
+        uint8_t address[6] = { 0, 0, 0, 0, 0, (uint8_t) (i + 1) };
+        ns3::Mac48Address owner;
+        owner.CopyFrom(address);
+        manager->MarkSlotAsAllocated(10 + i, 8, owner, ns3::Vector(distances[i], 0.0, 0.0), ns3::Seconds(0), powers[i]);
+      }
+    candidates.clear();
+    candidates.push_back(3);
+    policy->SelectSlot(*manager, ns3::Vector(0.0, 0.0, 0.0), candidates, allocated);
+    NS_TEST_EXPECT_MSG_EQ (4, candidates.size(), "The candidate set should have been filled up to the minimum size.");
+    NS_TEST_EXPECT_MSG_EQ (10, candidates[1], "The slot of the farthest owner should be added first.");
+    NS_TEST_EXPECT_MSG_EQ (12, candidates[2], "The slot of the second farthest owner should be added second.");
+    NS_TEST_EXPECT_MSG_EQ (14, candidates[3], "The slot of the third farthest owner should be added third.");
+
+    // The received power policy adds the weakest received owners regardless of their reported distance
+    ns3::Ptr<StdmaRxPowerSlotSelectionPolicy> rxPowerPolicy = CreateObject<StdmaRxPowerSlotSelectionPolicy>();
+    candidates.clear();
+    candidates.push_back(3);
+    index = rxPowerPolicy->SelectSlot(*manager, ns3::Vector(0.0, 0.0, 0.0), candidates, allocated);
+    NS_TEST_EXPECT_MSG_EQ (4, candidates.size(), "The candidate set should have been filled up to the minimum size.");
+    NS_TEST_EXPECT_MSG_EQ (3, candidates[0], "The free slot should remain the first candidate.");
+    std::sort(candidates.begin() + 1, candidates.end());
+    NS_TEST_EXPECT_MSG_EQ (11, candidates[1], "The slot of the weakest received owner should be a candidate.");
+    NS_TEST_EXPECT_MSG_EQ (12, candidates[2], "The slot of the third weakest received owner should be a candidate.");
+    NS_TEST_EXPECT_MSG_EQ (13, candidates[3], "The slot of the second weakest received owner should be a candidate.");
+    NS_TEST_EXPECT_MSG_EQ (true, (std::find(candidates.begin(), candidates.end(), index) != candidates.end()), "The selected slot should be one of the candidates.");
+
+    // Owners without a received power do not affect the ranking of the others, as long as enough of them
+    // have one
+    for (uint32_t i = 2; i < 4; i++)
+      {
+        uint8_t address[6] = { 0, 0, 0, 0, 0, (uint8_t) (i + 1) };
+        ns3::Mac48Address owner;
+        owner.CopyFrom(address);
+        manager->MarkSlotAsAllocated(10 + i, 8, owner, ns3::Vector(distances[i], 0.0, 0.0));
+      }
+    candidates.clear();
+    candidates.push_back(3);
+    rxPowerPolicy->SelectSlot(*manager, ns3::Vector(0.0, 0.0, 0.0), candidates, allocated);
+    NS_TEST_EXPECT_MSG_EQ (4, candidates.size(), "The candidate set should have been filled up to the minimum size.");
+    std::sort(candidates.begin() + 1, candidates.end());
+    NS_TEST_EXPECT_MSG_EQ (10, candidates[1], "The slot of the third weakest received owner should be a candidate.");
+    NS_TEST_EXPECT_MSG_EQ (11, candidates[2], "The slot of the weakest received owner should be a candidate.");
+    NS_TEST_EXPECT_MSG_EQ (14, candidates[3], "The slot of the second weakest received owner should be a candidate.");
+
+    // Otherwise the farthest owners without a received power fill up the candidate set
+    for (uint32_t i = 0; i < 2; i++)
+      {
+        uint8_t address[6] = { 0, 0, 0, 0, 0, (uint8_t) (i + 1) };
+        ns3::Mac48Address owner;
+        owner.CopyFrom(address);
+        manager->MarkSlotAsAllocated(10 + i, 8, owner, ns3::Vector(distances[i], 0.0, 0.0));
+      }
+    candidates.clear();
+    candidates.push_back(3);
+    rxPowerPolicy->SelectSlot(*manager, ns3::Vector(0.0, 0.0, 0.0), candidates, allocated);
+    NS_TEST_EXPECT_MSG_EQ (4, candidates.size(), "The candidate set should have been filled up to the minimum size.");
+    NS_TEST_EXPECT_MSG_EQ (14, candidates[1], "The slot of the only received owner should be added first.");
+    NS_TEST_EXPECT_MSG_EQ (10, candidates[2], "The slot of the farthest owner should be added second.");
+    NS_TEST_EXPECT_MSG_EQ (12, candidates[3], "The slot of the second farthest owner should be added third.");
+  }
+
+} // namespace stdma
@@ -0,0 +1,131 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/mobility-module.h"
+#include "snapshot-test.h"
+#include "stdma-test-utils.h"
+
+using namespace ns3;
+
+namespace stdma {
+
+
+  StdmaSnapshotTest::StdmaSnapshotTest ()
+    : ns3::TestCase ("StdmaSnapshotTest"),
+      m_restored(false),
+      m_saved(ns3::Seconds(4.95)),
+      m_origin(ns3::Seconds(0)),
+      m_entries(0)
+  {
+    for (uint32_t i = 0; i < 2; i++)
+      {
+        m_firstTx[0][i] = ns3::Seconds(-1);
+        m_firstTx[1][i] = ns3::Seconds(-1);
+        m_tx[i] = 0;
+      }
+  }
+
+  ns3::NetDeviceContainer
+  StdmaSnapshotTest::Run (ns3::Time duration, std::string warmStart)
+  {
+    ns3::SeedManager::SetSeed (1);
+
+    stdma::StdmaHelper stdma;
+    stdma.SetStandard(ns3::WIFI_PHY_STANDARD_80211p_CCH);
+    stdma.SetWarmStart(warmStart);
+
+    ns3::NodeContainer m_nodes;
+    ns3::NetDeviceContainer devices = InstallTwoStations(stdma, CreateTwoStationsPhy(), m_nodes);
+
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/Tx", ns3::MakeCallback (&stdma::StdmaSnapshotTest::StdmaTxTrace, this) );
+    ns3::Config::Connect("/NodeList/*/DeviceList/*/$stdma::StdmaNetDevice/Mac/NetworkEntry", ns3::MakeCallback (&stdma::StdmaSnapshotTest::NetworkEntryTrace, this) );
+
+    ns3::Simulator::Stop(duration);
+    return devices;
+  }
+
+  void
+  StdmaSnapshotTest::DoRun (void)
+  {
+    SetTwoStationsDefaults(ns3::UniformVariable(3, 7));
+    std::string filename = CreateTempDirFilename("stdma-snapshot.bin");
+
+    // Let two stations enter the network and take a snapshot of them within their fifth frame
+    ns3::NetDeviceContainer devices = Run(ns3::Seconds(6.0), "");
+    ns3::Simulator::Schedule(m_saved, &stdma::StdmaSnapshotTest::SaveSnapshot, this, filename, devices);
+    ns3::Simulator::Run ();
+    ns3::Simulator::Destroy ();
+
+    // Warm start the same scenario from the snapshot
+    m_restored = true;
+    Run(ns3::Seconds(2.0), filename);
+    ns3::Simulator::Run ();
+    ns3::Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_EQ (0, m_entries, "The restored stations should not perform a network entry");
+    for (uint32_t i = 0; i < 2; i++)
+      {
+        NS_TEST_EXPECT_MSG_GT (m_firstTx[0][i], m_saved, "The first run should continue to transmit after the snapshot");
+        NS_TEST_EXPECT_MSG_EQ (m_firstTx[1][i], m_firstTx[0][i] - m_origin, "The restored station should resume its schedule");
+        NS_TEST_EXPECT_MSG_EQ_TOL (10, m_tx[i], 1, "The restored station should transmit at its report rate");
+      }
+  }
+
+  void
+  StdmaSnapshotTest::SaveSnapshot (std::string filename, ns3::NetDeviceContainer devices)
+  {
+    m_origin = ns3::Simulator::Now();
+    for (uint32_t i = 0; i < devices.GetN(); i++)
+      {
+        ns3::Ptr<StdmaMac> mac = devices.Get(i)->GetObject<StdmaNetDevice>()->GetMac();
+        m_origin = std::min(m_origin, mac->GetSlotManager()->GetCurrentFrameStart());
+      }
+    StdmaHelper::SaveSnapshot(filename, devices);
+  }
+
+  void
+  StdmaSnapshotTest::StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset)
+  {
+    uint32_t id = GetNodeId(context);
+    ns3::Time now = ns3::Simulator::Now();
+    if (m_firstTx[m_restored][id].IsStrictlyNegative() && (m_restored || now > m_saved))
+      {
+        m_firstTx[m_restored][id] = now;
+      }
+    if (m_restored && now >= ns3::Seconds(1.0))
+      {
+        m_tx[id]++;
+      }
+  }
+
+  void
+  StdmaSnapshotTest::NetworkEntryTrace (std::string context, ns3::Ptr<const ns3::Packet> p, ns3::Time delay, bool isTaken)
+  {
+    if (m_restored)
+      {
+        m_entries++;
+      }
+  }
+
+} // namespace stdma
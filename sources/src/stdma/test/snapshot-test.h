@@ -0,0 +1,63 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef SNAPSHOT_TEST_H_
+#define SNAPSHOT_TEST_H_
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/net-device-container.h"
+
+#include <string>
+
+namespace stdma {
+
+class StdmaSnapshotTest : public ns3::TestCase
+{
+public:
+  StdmaSnapshotTest ();
+
+  virtual void DoRun (void);
+  void SaveSnapshot (std::string filename, ns3::NetDeviceContainer devices);
+  void StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset);
+  void NetworkEntryTrace (std::string context, ns3::Ptr<const ns3::Packet> p, ns3::Time delay, bool isTaken);
+
+private:
+  /**
+   * Runs two stations for the given time, either from scratch or warm started from the given snapshot
+   */
+  ns3::NetDeviceContainer Run (ns3::Time duration, std::string warmStart);
+
+  bool m_restored;
+  ns3::Time m_saved;
+  ns3::Time m_origin;
+  ns3::Time m_firstTx[2][2];    // First transmission after the snapshot, per run and node
+  uint32_t m_tx[2];             // Transmissions within the second frame of the restored run
+  uint32_t m_entries;           // Network entries within the restored run
+
+};
+
+} // namespace stdma
+
+#endif /* SNAPSHOT_TEST_H_ */
@@ -23,6 +23,14 @@
 #include "single-node-test.h"
 #include "two-nodes-test.h"
 #include "slot-manager-test.h"
+#include "slot-selection-policy-test.h"
+#include "header-test.h"
+#include "aggregation-test.h"
+#include "mac-queue-test.h"
+#include "report-rate-test.h"
+#include "frame-statistics-test.h"
+#include "snapshot-test.h"
+#include "slot-channel-test.h"
 
 using namespace ns3;
 
@@ -34,8 +42,38 @@ namespace stdma {
     AddTestCase (new StdmaTwoNodesTest, TestCase::QUICK);
     AddTestCase (new StdmaSingleNodeTest, TestCase::QUICK);
     AddTestCase (new StdmaSlotManagerTest, TestCase::QUICK);
+    AddTestCase (new StdmaSlotSelectionPolicyTest, TestCase::QUICK);
+    AddTestCase (new StdmaHeaderTest, TestCase::QUICK);
+    AddTestCase (new StdmaAggregationTest, TestCase::QUICK);
+    AddTestCase (new StdmaMacQueueTest, TestCase::QUICK);
+    AddTestCase (new StdmaReportRateTest, TestCase::QUICK);
+    AddTestCase (new StdmaChangeReportRateTest, TestCase::QUICK);
+    AddTestCase (new StdmaFrameStatisticsTest, TestCase::QUICK);
+    AddTestCase (new StdmaSnapshotTest, TestCase::QUICK);
   }
 
   StdmaSingleNodeTestSuite g_stdmaSingleNodeTestSuite;
 
+  // The slot clock runs the same scenario as the two nodes test, in a suite of its own such that it starts
+  // from the same state of the random number generators
+  StdmaSlotClockTestSuite::StdmaSlotClockTestSuite ()
+    : ns3::TestSuite ("stdma-slot-clock", UNIT)
+  {
+    AddTestCase (new StdmaTwoNodesTest (true), TestCase::QUICK);
+  }
+
+  StdmaSlotClockTestSuite g_stdmaSlotClockTestSuite;
+
+  // The same scenario once more, with both stations attached to the slot-level abstract channel
+  StdmaSlotChannelTestSuite::StdmaSlotChannelTestSuite ()
+    : ns3::TestSuite ("stdma-slot-channel", UNIT)
+  {
+    AddTestCase (new StdmaTwoNodesTest (true, true), TestCase::QUICK);
+    AddTestCase (new StdmaSlotChannelLookaheadTest, TestCase::QUICK);
+    AddTestCase (new StdmaSlotChannelEncodingTest, TestCase::QUICK);
+    AddTestCase (new StdmaSlotChannelErrorRateTest, TestCase::QUICK);
+  }
+
+  StdmaSlotChannelTestSuite g_stdmaSlotChannelTestSuite;
+
 }
@@ -35,6 +35,18 @@ namespace stdma {
     StdmaSingleNodeTestSuite ();
   };
 
+  class StdmaSlotClockTestSuite : public TestSuite
+  {
+  public:
+    StdmaSlotClockTestSuite ();
+  };
+
+  class StdmaSlotChannelTestSuite : public TestSuite
+  {
+  public:
+    StdmaSlotChannelTestSuite ();
+  };
+
 }
 
 #endif /* STDMA_TEST_SUITE_H_ */
@@ -0,0 +1,78 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/mobility-module.h"
+#include "stdma-test-utils.h"
+
+#include <stdlib.h>
+
+namespace stdma {
+
+  void
+  SetTwoStationsDefaults (ns3::RandomVariable timeout)
+  {
+    ns3::Config::SetDefault ("stdma::StdmaMac::FrameDuration", ns3::TimeValue(ns3::Seconds(1.0)));
+    ns3::Config::SetDefault ("stdma::StdmaMac::MaximumPacketSize", ns3::UintegerValue(400));
+    ns3::Config::SetDefault ("stdma::StdmaMac::ReportRate", ns3::UintegerValue(10));
+    ns3::Config::SetDefault ("stdma::StdmaMac::Timeout", ns3::RandomVariableValue (timeout));
+    ns3::Config::SetDefault ("stdma::StdmaMac::SlotClock", ns3::BooleanValue(false));
+  }
+
+  ns3::YansWifiPhyHelper
+  CreateTwoStationsPhy (void)
+  {
+    ns3::YansWifiChannelHelper wifiChannel;
+    wifiChannel.AddPropagationLoss("ns3::LogDistancePropagationLossModel");
+    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+    ns3::YansWifiPhyHelper wifiPhy = ns3::YansWifiPhyHelper::Default();
+    wifiPhy.SetChannel(wifiChannel.Create());
+    return wifiPhy;
+  }
+
+  ns3::NetDeviceContainer
+  InstallTwoStations (const StdmaHelper &stdma, const ns3::WifiPhyHelper &phy, ns3::NodeContainer &nodes)
+  {
+    ns3::NodeContainer created;
+    created.Create(2);
+    nodes.Add(created);
+    stdma::StdmaMacHelper stdmaMac = stdma::StdmaMacHelper::Default();
+    ns3::NetDeviceContainer devices = stdma.Install(phy, stdmaMac, created);
+
+    ns3::MobilityHelper mobility;
+    ns3::Ptr<ns3::ListPositionAllocator> positionAlloc = ns3::CreateObject<ns3::ListPositionAllocator>();
+    positionAlloc->Add(ns3::Vector(0.0, 0.0, 0.0));
+    positionAlloc->Add(ns3::Vector(1.0, 0.0, 0.0));
+    mobility.SetPositionAllocator(positionAlloc);
+    mobility.Install(created);
+    return devices;
+  }
+
+  uint32_t
+  GetNodeId (std::string context)
+  {
+    // The context starts with /NodeList/<id>/
+    return atoi(context.substr(10).c_str());
+  }
+
+} // namespace stdma
@@ -0,0 +1,69 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013 Jens Mittag, Tristan Gaugel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@gmail.com>
+ *         Tristan Gaugel <tristan.gaugel@kit.edu>
+ */
+
+#ifndef STDMA_TEST_UTILS_H_
+#define STDMA_TEST_UTILS_H_
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/wifi-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/random-variable.h"
+#include "ns3/stdma-helper.h"
+
+#include <string>
+
+namespace stdma {
+
+  /**
+   * Sets the defaults of the STDMA MAC that are shared by the tests with two stations: frames of one second
+   * with ten reports of at most 400 bytes each, reservations with the given timeout and no slot clock.
+   *
+   * @param timeout The random variable for the timeout of the reservations
+   */
+  void SetTwoStationsDefaults (ns3::RandomVariable timeout);
+
+  /**
+   * @return A helper for YansWifiPhy instances attached to a new YansWifiChannel with log-distance
+   * propagation loss and constant speed propagation delay
+   */
+  ns3::YansWifiPhyHelper CreateTwoStationsPhy (void);
+
+  /**
+   * Creates two nodes one meter apart from each other, with a STDMA device each
+   *
+   * @param stdma The STDMA helper used to install the devices
+   * @param phy The helper for the phys of the devices
+   * @param nodes The container to which the two nodes are added
+   * @return The devices of the two nodes
+   */
+  ns3::NetDeviceContainer InstallTwoStations (const StdmaHelper &stdma, const ns3::WifiPhyHelper &phy,
+                                              ns3::NodeContainer &nodes);
+
+  /**
+   * @param context The context of a trace source connected through the node list
+   * @return The id of the node the trace source belongs to
+   */
+  uint32_t GetNodeId (std::string context);
+
+} // namespace stdma
+
+#endif /* STDMA_TEST_UTILS_H_ */
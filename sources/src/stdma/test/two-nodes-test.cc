@@ -34,8 +34,10 @@ using namespace ns3;
 namespace stdma {
 
 
-  StdmaTwoNodesTest::StdmaTwoNodesTest ()
-    : ns3::TestCase ("StdmaTwoNodesTest")
+  StdmaTwoNodesTest::StdmaTwoNodesTest (bool slotClock, bool slotChannel)
+    : ns3::TestCase (slotChannel ? "StdmaTwoNodesSlotChannelTest" : (slotClock ? "StdmaTwoNodesSlotClockTest" : "StdmaTwoNodesTest")),
+      m_slotClock(slotClock),
+      m_slotChannel(slotChannel)
   {
   }
 
@@ -52,23 +54,40 @@ namespace stdma {
     ns3::Config::SetDefault ("stdma::StdmaMac::MaximumPacketSize", ns3::UintegerValue(400));
     ns3::Config::SetDefault ("stdma::StdmaMac::ReportRate", ns3::UintegerValue(10));
     ns3::Config::SetDefault ("stdma::StdmaMac::Timeout", ns3::RandomVariableValue (ns3::UniformVariable(8, 8)));
+    ns3::Config::SetDefault ("stdma::StdmaMac::SlotClock", ns3::BooleanValue(m_slotClock));
 
     // Create network nodes
     ns3::NodeContainer m_nodes;
     m_nodes.Create(2);
+    ns3::NetDeviceContainer devices;
 
     // Configure the wireless channel characteristics
-    ns3::YansWifiChannelHelper wifiChannel;
-    wifiChannel.AddPropagationLoss("ns3::LogDistancePropagationLossModel");
     ns3::Config::SetDefault ("ns3::LogDistancePropagationLossModel::Exponent", ns3::DoubleValue(1.85));
     ns3::Config::SetDefault ("ns3::LogDistancePropagationLossModel::ReferenceLoss", ns3::DoubleValue(59.7));
-    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
-
-    ns3::YansWifiPhyHelper wifiPhy = ns3::YansWifiPhyHelper::Default();
-    wifiPhy.SetChannel(wifiChannel.Create());
-
-    // Install wifiPhy and link it with STDMA medium access control layer implementation
-    stdma.Install(wifiPhy, stdmaMac, m_nodes);
+    if (m_slotChannel)
+      {
+        ns3::Ptr<stdma::StdmaSlotChannel> channel = ns3::CreateObject<stdma::StdmaSlotChannel>();
+        channel->SetPropagationLossModel(ns3::CreateObject<ns3::LogDistancePropagationLossModel>());
+        stdma::StdmaSlotPhyHelper slotPhy = stdma::StdmaSlotPhyHelper::Default();
+        slotPhy.SetChannel(channel);
+
+        // Install the slot phy and link it with STDMA medium access control layer implementation
+        devices = stdma.Install(slotPhy, stdmaMac, m_nodes);
+      }
+    else
+      {
+        ns3::YansWifiChannelHelper wifiChannel;
+        wifiChannel.AddPropagationLoss("ns3::LogDistancePropagationLossModel");
+        wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+
+        ns3::YansWifiPhyHelper wifiPhy = ns3::YansWifiPhyHelper::Default();
+        wifiPhy.SetChannel(wifiChannel.Create());
+
+        // Install wifiPhy and link it with STDMA medium access control layer implementation
+        devices = stdma.Install(wifiPhy, stdmaMac, m_nodes);
+      }
+    // Fixed streams keep the random draws of the stations independent of the random variables of the channel
+    stdma::StdmaHelper::AssignStreams(devices, 0);
 
     // Define positions of the two nodes
     ns3::MobilityHelper mobility;
@@ -109,7 +128,7 @@ namespace stdma {
     m_count = 0;
     ns3::Simulator::Run ();
     ns3::Simulator::Destroy ();
-    NS_TEST_EXPECT_MSG_EQ (m_count, 60, "The station should have transmitted exactly 30 packets");
+    NS_TEST_EXPECT_MSG_EQ (m_count, 60, "The stations should have transmitted exactly 30 packets each");
 
   }
 
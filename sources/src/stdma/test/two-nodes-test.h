@@ -33,7 +33,7 @@ namespace stdma {
 class StdmaTwoNodesTest : public ns3::TestCase
 {
 public:
-  StdmaTwoNodesTest ();
+  StdmaTwoNodesTest (bool slotClock = false, bool slotChannel = false);
 
   virtual void DoRun (void);
   void StdmaTxTrace (std::string context, ns3::Ptr<const ns3::Packet> p, uint32_t no, uint8_t timeout, uint32_t offset);
@@ -51,6 +51,8 @@ private:
   uint32_t m_nextRxFromNodeOne;
   uint32_t m_nextRxFromNodeTwo;
   ns3::Time m_slotDuration;
+  bool m_slotClock;
+  bool m_slotChannel;
 
 };
 
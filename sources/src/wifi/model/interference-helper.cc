@@ -91,32 +91,6 @@ InterferenceHelper::Event::GetTxVector (void) const
 }
 
 
-/****************************************************************
- *       Class which records SNIR change events for a
- *       short period of time.
- ****************************************************************/
-
-InterferenceHelper::NiChange::NiChange (Time time, double delta)
-  : m_time (time),
-    m_delta (delta)
-{
-}
-Time
-InterferenceHelper::NiChange::GetTime (void) const
-{
-  return m_time;
-}
-double
-InterferenceHelper::NiChange::GetDelta (void) const
-{
-  return m_delta;
-}
-bool
-InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o) const
-{
-  return (m_time < o.m_time);
-}
-
 /****************************************************************
  *       The actual InterferenceHelper
  ****************************************************************/
@@ -124,7 +98,9 @@ InterferenceHelper::NiChange::operator < (const InterferenceHelper::NiChange& o)
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_firstPower (0.0),
-    m_rxing (false)
+    m_rxing (false),
+    m_cursor (m_niChanges.end ()),
+    m_cursorPower (0.0)
 {
 }
 InterferenceHelper::~InterferenceHelper ()
@@ -179,17 +155,19 @@ Time
 InterferenceHelper::GetEnergyDuration (double energyW)
 {
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
+  // changes before now only matter through their accumulated power, which
+  // is carried over between calls so that each change is summed only once
+  while (m_cursor != m_niChanges.end () && m_cursor->first < now)
+    {
+      m_cursorPower += m_cursor->second;
+      m_cursor++;
+    }
+  double noiseInterferenceW = m_cursorPower;
   Time end = now;
-  noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (NiChanges::const_iterator i = m_cursor; i != m_niChanges.end (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
-      end = i->GetTime ();
-      if (end < now)
-        {
-          continue;
-        }
+      noiseInterferenceW += i->second;
+      end = i->first;
       if (noiseInterferenceW < energyW)
         {
           break;
@@ -198,25 +176,28 @@ InterferenceHelper::GetEnergyDuration (double energyW)
   return end > now ? end - now : MicroSeconds (0);
 }
 
-void
-InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
+double
+InterferenceHelper::GetEnergy (void) const
 {
   Time now = Simulator::Now ();
-  if (!m_rxing)
+  double noiseInterferenceW = m_cursorPower;
+  for (NiChanges::const_iterator i = m_cursor; i != m_niChanges.end () && i->first <= now; i++)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      noiseInterferenceW += i->second;
     }
-  else
+  return noiseInterferenceW;
+}
+
+void
+InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
+{
+  if (!m_rxing)
     {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      // the start of the new event becomes the first change
+      PruneNiChanges (Simulator::Now ());
     }
-  AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
+  AddNiChangeEvent (event->GetStartTime (), event->GetRxPowerW ());
+  AddNiChangeEvent (event->GetEndTime (), -event->GetRxPowerW ());
 
 }
 
@@ -236,20 +217,27 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, WifiM
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges::const_iterator *end) const
 {
   double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  NS_ASSERT (!m_niChanges.empty ());
+  // the first change is the start of the event itself; the changes which
+  // affect its reception are those up to its own end
+  NiChanges::const_iterator i = m_niChanges.lower_bound (event->GetEndTime ());
+  if (i == m_niChanges.begin ())
     {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
+      i++;
+    }
+  for (; i != m_niChanges.end () && i->first == event->GetEndTime (); i++)
+    {
+      if (event->GetRxPowerW () == -i->second)
         {
-          break;
+          *end = i;
+          return noiseInterference;
         }
-      ni->push_back (*i);
     }
-  ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
-  ni->push_back (NiChange (event->GetEndTime (), 0));
+  *end = m_niChanges.end ();
   return noiseInterference;
 }
 
@@ -267,11 +255,12 @@ InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiM
 }
 
 double
-InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, double noiseInterferenceW,
+                                  NiChanges::const_iterator end) const
 {
   double psr = 1.0; /* Packet Success Rate */
-  NiChanges::iterator j = ni->begin ();
-  Time previous = (*j).GetTime ();
+  NiChanges::const_iterator j = m_niChanges.begin ();
+  Time previous = event->GetStartTime ();
   WifiMode payloadMode = event->GetPayloadMode ();
   WifiPreamble preamble = event->GetPreambleType ();
  WifiMode MfHeaderMode ;
@@ -281,16 +270,30 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
 
    }
   WifiMode headerMode = WifiPhy::GetPlcpHeaderMode (payloadMode, preamble);
-  Time plcpHeaderStart = (*j).GetTime () + MicroSeconds (WifiPhy::GetPlcpPreambleDurationMicroSeconds (payloadMode, preamble)); //packet start time+ preamble
+  Time plcpHeaderStart = previous + MicroSeconds (WifiPhy::GetPlcpPreambleDurationMicroSeconds (payloadMode, preamble)); //packet start time+ preamble
   Time plcpHsigHeaderStart=plcpHeaderStart+ MicroSeconds (WifiPhy::GetPlcpHeaderDurationMicroSeconds (payloadMode, preamble));//packet start time+ preamble+L SIG
   Time plcpHtTrainingSymbolsStart = plcpHsigHeaderStart + MicroSeconds (WifiPhy::GetPlcpHtSigHeaderDurationMicroSeconds (payloadMode, preamble));//packet start time+ preamble+L SIG+HT SIG
   Time plcpPayloadStart =plcpHtTrainingSymbolsStart + MicroSeconds (WifiPhy::GetPlcpHtTrainingSymbolDurationMicroSeconds (payloadMode, preamble,event->GetTxVector())); //packet start time+ preamble+L SIG+HT SIG+Training
-  double noiseInterferenceW = (*j).GetDelta ();
   double powerW = event->GetRxPowerW ();
-    j++;
-  while (ni->end () != j)
+  j++;
+  bool last = false;
+  while (!last)
     {
-      Time current = (*j).GetTime ();
+      // walk the changes in place, ending with the end of the event
+      Time current;
+      double delta;
+      if (j == end)
+        {
+          current = event->GetEndTime ();
+          delta = 0;
+          last = true;
+        }
+      else
+        {
+          current = j->first;
+          delta = j->second;
+          j++;
+        }
       NS_ASSERT (current >= previous);
       //Case 1: Both prev and curr point to the payload
       if (previous >= plcpPayloadStart)
@@ -528,9 +531,8 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
             }
         }
 
-      noiseInterferenceW += (*j).GetDelta ();
-      previous = (*j).GetTime ();
-      j++;
+      noiseInterferenceW += delta;
+      previous = current;
     }
 
   double per = 1 - psr;
@@ -541,8 +543,8 @@ InterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, Ni
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator end;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &end);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetPayloadMode ());
@@ -550,7 +552,7 @@ InterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePer (event, &ni);
+  double per = CalculatePer (event, noiseInterferenceW, end);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -564,17 +566,31 @@ InterferenceHelper::EraseEvents (void)
   m_niChanges.clear ();
   m_rxing = false;
   m_firstPower = 0.0;
+  m_cursor = m_niChanges.end ();
+  m_cursorPower = 0.0;
 }
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPosition (Time moment)
+void
+InterferenceHelper::PruneNiChanges (Time moment)
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
-
+  NiChanges::iterator last = m_niChanges.upper_bound (moment);
+  for (NiChanges::iterator i = m_niChanges.begin (); i != last; i++)
+    {
+      m_firstPower += i->second;
+    }
+  m_niChanges.erase (m_niChanges.begin (), last);
+  m_cursor = m_niChanges.begin ();
+  m_cursorPower = m_firstPower;
 }
 void
-InterferenceHelper::AddNiChangeEvent (NiChange change)
+InterferenceHelper::AddNiChangeEvent (Time moment, double delta)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  // changes are never added before now, so they never precede the ones
+  // already accumulated by GetEnergyDuration
+  NiChanges::iterator i = m_niChanges.insert (std::make_pair (moment, delta));
+  if (m_cursor == m_niChanges.end () || moment < m_cursor->first)
+    {
+      m_cursor = i;
+    }
 }
 void
 InterferenceHelper::NotifyRxStart ()
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <map>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-phy-standard.h"
@@ -89,6 +90,10 @@ private:
    *          the requested threshold.
    */
   Time GetEnergyDuration (double energyW);
+  /**
+   * \returns the energy (W) currently observed on the medium
+   */
+  double GetEnergy (void) const;
 
 
   Ptr<InterferenceHelper::Event> Add (uint32_t size, WifiMode payloadMode,
@@ -100,27 +105,21 @@ private:
   void NotifyRxEnd ();
   void EraseEvents (void);
 private:
-  class NiChange
-  {
-public:
-    NiChange (Time time, double delta);
-    Time GetTime (void) const;
-    double GetDelta (void) const;
-    bool operator < (const NiChange& o) const;
-private:
-    Time m_time;
-    double m_delta;
-  };
-  typedef std::vector <NiChange> NiChanges;
+  /**
+   * Noise and interference power changes (W), ordered by time. Changes which
+   * happen at the same time are kept in the order they were added.
+   */
+  typedef std::multimap<Time, double> NiChanges;
   typedef std::list<Ptr<Event> > Events;
 
   InterferenceHelper (const InterferenceHelper &o);
   InterferenceHelper &operator = (const InterferenceHelper &o);
   void AppendEvent (Ptr<Event> event);
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *end) const;
   double CalculateSnr (double signal, double noiseInterference, WifiMode mode) const;
   double CalculateChunkSuccessRate (double snir, Time delay, WifiMode mode) const;
-  double CalculatePer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePer (Ptr<const Event> event, double noiseInterferenceW,
+                       NiChanges::const_iterator end) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
@@ -128,9 +127,13 @@ private:
   NiChanges m_niChanges;
   double m_firstPower;
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
-  void AddNiChangeEvent (NiChange change);
+  /// First change which GetEnergyDuration has not yet accumulated
+  NiChanges::iterator m_cursor;
+  /// Power after all changes before m_cursor
+  double m_cursorPower;
+  /// Removes the changes which happened up to moment and adds them to m_firstPower
+  void PruneNiChanges (Time moment);
+  void AddNiChangeEvent (Time moment, double delta);
 };
 
 } // namespace ns3
@@ -29,6 +29,11 @@
 #include "yans-wifi-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
@@ -50,16 +55,63 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange", "The maximum distance in meters at which a transmission can be detected, "
+                   "receivers farther away are not visited at all (0 disables the cutoff).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinRxPower", "The minimum receive power in dBm at which a transmission is delivered to a receiver, "
+                   "weaker receptions are dropped by the channel (the default does not drop any reception).",
+                   DoubleValue (-1000.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_minRxPowerDbm),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("DeliveryBucket", "If strictly positive, the receptions of a transmission whose propagation delays "
+                   "fall into the same multiple of this time are delivered by a single event at the smallest of their delays. "
+                   "Only receptions which notify the listeners of a PHY need another event within the context of its node.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&YansWifiChannel::m_deliveryBucket),
+                   MakeTimeChecker ())
+    .AddAttribute ("PathLossCache", "Whether the receive power calculated by the deterministic propagation loss models "
+                   "is cached for every pair of PHYs.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_pathLossCache),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PathLossCacheThreshold", "The distance in meters a PHY may move before its cached path losses are "
+                   "calculated again (0 recalculates them after any movement).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_pathLossThreshold),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PathLossCacheSize", "The maximum number of PHY pairs whose receive power is cached, "
+                   "channels with more pairs do not use the cache.",
+                   UintegerValue (4194304),
+                   MakeUintegerAccessor (&YansWifiChannel::m_pathLossCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0.0),
+    m_minRxPowerDbm (-1000.0),
+    m_deliveryBucket (Seconds (0)),
+    m_pathLossCache (false),
+    m_pathLossThreshold (0.0),
+    m_pathLossCacheSize (4194304),
+    m_cachedEpoch (0),
+    m_gridValid (false),
+    m_cellSize (0.0),
+    m_maxSpeed (0.0)
 {
 }
 YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  for (uint32_t i = 0; i < m_phyMobility.size (); i++)
+    {
+      m_phyMobility[i]->TraceDisconnectWithoutContext ("CourseChange",
+                                                       MakeBoundCallback (&YansWifiChannel::CourseChanged, (const YansWifiChannel *) this, i));
+    }
+  m_phyMobility.clear ();
   m_phyList.clear ();
 }
 
@@ -80,9 +132,24 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  // Receivers are always visited in the order in which they have been added,
+  // so that culling does not change the order of the scheduled events
+  const std::vector<uint32_t> *receivers = 0;
+  if (m_maxRange > 0)
+    {
+      receivers = &FindReceivers (senderMobility->GetPosition ());
+    }
+  uint32_t n = (receivers != 0) ? receivers->size () : m_phyList.size ();
+  m_batchPhys.clear ();
+  m_batchMobility.clear ();
+  m_batchX.clear ();
+  m_batchY.clear ();
+  m_batchZ.clear ();
+  Vector senderPosition = senderMobility->GetPosition ();
+  for (uint32_t k = 0; k < n; k++)
     {
+      uint32_t j = (receivers != 0) ? (*receivers)[k] : k;
+      PhyList::const_iterator i = m_phyList.begin () + j;
       if (sender != (*i))
         {
           // For now don't account for inter channel interference
@@ -92,35 +159,299 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
             }
 
           Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+          Vector receiverPosition = receiverMobility->GetPosition ();
+          if (m_maxRange > 0 && CalculateDistance (senderPosition, receiverPosition) > m_maxRange)
+            {
+              continue;
+            }
+          m_batchPhys.push_back (j);
+          m_batchMobility.push_back (receiverMobility);
+          m_batchX.push_back (receiverPosition.x);
+          m_batchY.push_back (receiverPosition.y);
+          m_batchZ.push_back (receiverPosition.z);
+        }
+    }
+
+  // The propagation loss of all receivers is calculated at once, unless it is
+  // taken from the cache
+  if (UsePathLossCache ())
+    {
+      uint32_t senderIndex = m_phyIndex.find (PeekPointer (sender))->second;
+      m_batchRxPowerDbm.resize (m_batchPhys.size ());
+      for (uint32_t k = 0; k < m_batchPhys.size (); k++)
+        {
+          m_batchRxPowerDbm[k] = CalcRxPower (senderIndex, m_batchPhys[k], txPowerDbm, senderMobility, m_batchMobility[k]);
+        }
+    }
+  else
+    {
+      m_loss->CalcRxPower (txPowerDbm, senderMobility, m_batchMobility, m_batchX, m_batchY, m_batchZ, m_batchRxPowerDbm);
+    }
+
+  Ptr<const Packet> copy;
+  Ptr<Batch> batch;
+  bool ordered = true;
+  for (uint32_t k = 0; k < m_batchPhys.size (); k++)
+    {
+      uint32_t j = m_batchPhys[k];
+      Ptr<MobilityModel> receiverMobility = m_batchMobility[k];
+      Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      double rxPowerDbm = m_batchRxPowerDbm[k];
+      NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                    "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+      if (rxPowerDbm < m_minRxPowerDbm)
+        {
+          NS_LOG_DEBUG ("dropping reception below the minimum receive power of " << m_minRxPowerDbm << "dbm");
+          continue;
+        }
+      if (copy == 0)
+        {
+          // All receivers share a single copy, each PHY copies it again
+          // only if it synchronizes to the packet
+          copy = packet->Copy ();
+        }
+      if (m_deliveryBucket.IsStrictlyPositive ())
+        {
+          if (batch == 0)
+            {
+              batch = Create<Batch> ();
+              batch->packet = copy;
+              batch->txVector = txVector;
+              batch->preamble = preamble;
+            }
+          Delivery delivery;
+          delivery.phy = j;
+          delivery.rxPowerDbm = rxPowerDbm;
+          delivery.delay = delay;
+          if (!batch->deliveries.empty ()
+              && DeliveryBucketLess (m_deliveryBucket) (delivery, batch->deliveries.back ()))
             {
-              dstNode = 0xffffffff;
+              ordered = false;
             }
-          else
+          batch->deliveries.push_back (delivery);
+          continue;
+        }
+      Simulator::ScheduleWithContext (GetNodeId (j),
+                                      delay, &YansWifiChannel::Receive, this,
+                                      j, copy, rxPowerDbm, txVector, preamble);
+    }
+  if (batch == 0)
+    {
+      return;
+    }
+
+  // Batched delivery: one event per bucket of similar delays, scheduled at
+  // the smallest delay within the bucket
+  std::vector<Delivery> &deliveries = batch->deliveries;
+  if (!ordered)
+    {
+      std::stable_sort (deliveries.begin (), deliveries.end (), DeliveryBucketLess (m_deliveryBucket));
+    }
+  uint32_t first = 0;
+  while (first < deliveries.size ())
+    {
+      int64_t bucket = deliveries[first].delay.GetTimeStep () / m_deliveryBucket.GetTimeStep ();
+      Time delay = deliveries[first].delay;
+      uint32_t last = first;
+      for (; last < deliveries.size () && deliveries[last].delay.GetTimeStep () / m_deliveryBucket.GetTimeStep () == bucket; last++)
+        {
+          delay = std::min (delay, deliveries[last].delay);
+        }
+      Simulator::ScheduleWithContext (GetNodeId (deliveries[first].phy),
+                                      delay, &YansWifiChannel::ReceiveBatch, this,
+                                      batch, first, last);
+      first = last;
+    }
+}
+
+uint32_t
+YansWifiChannel::GetNodeId (uint32_t i) const
+{
+  Ptr<Object> dstNetDevice = m_phyList[i]->GetDevice ();
+  if (dstNetDevice == 0)
+    {
+      return 0xffffffff;
+    }
+  return dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+}
+
+double
+YansWifiChannel::CalcRxPower (uint32_t sender, uint32_t receiver, double txPowerDbm,
+                              Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  if (!UsePathLossCache ())
+    {
+      return m_loss->CalcRxPower (txPowerDbm, a, b);
+    }
+  size_t n = m_phyList.size ();
+  uint64_t epoch = m_loss->GetChangeEpoch ();
+  if (m_pathLoss.size () != n * n || m_cachedLoss != m_loss || m_cachedEpoch != epoch)
+    {
+      PathLoss invalid;
+      invalid.txPowerDbm = 0;
+      invalid.rxPowerDbm = 0;
+      invalid.senderEpoch = 0;
+      invalid.receiverEpoch = 0;
+      m_pathLoss.assign (n * n, invalid);
+      m_epoch.assign (n, 1);
+      m_anchor.resize (n);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          m_anchor[i] = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ()->GetPosition ();
+        }
+      m_cachedLoss = m_loss;
+      m_cachedEpoch = epoch;
+    }
+  PathLoss &entry = m_pathLoss[sender * n + receiver];
+  uint32_t senderEpoch = GetEpoch (sender, a->GetPosition ());
+  uint32_t receiverEpoch = GetEpoch (receiver, b->GetPosition ());
+  if (entry.senderEpoch != senderEpoch || entry.receiverEpoch != receiverEpoch || entry.txPowerDbm != txPowerDbm)
+    {
+      entry.txPowerDbm = txPowerDbm;
+      entry.rxPowerDbm = m_loss->CalcDeterministicRxPower (txPowerDbm, a, b, m_uncachedLoss);
+      entry.senderEpoch = senderEpoch;
+      entry.receiverEpoch = receiverEpoch;
+    }
+  if (m_uncachedLoss != 0)
+    {
+      return m_uncachedLoss->CalcRxPower (entry.rxPowerDbm, a, b);
+    }
+  return entry.rxPowerDbm;
+}
+
+bool
+YansWifiChannel::UsePathLossCache (void) const
+{
+  size_t n = m_phyList.size ();
+  return m_pathLossCache && n * n <= m_pathLossCacheSize;
+}
+
+uint32_t
+YansWifiChannel::GetEpoch (uint32_t i, Vector position) const
+{
+  double dx = position.x - m_anchor[i].x;
+  double dy = position.y - m_anchor[i].y;
+  double dz = position.z - m_anchor[i].z;
+  double moved = dx * dx + dy * dy + dz * dz;
+  if (moved > m_pathLossThreshold * m_pathLossThreshold)
+    {
+      m_anchor[i] = position;
+      m_epoch[i]++;
+    }
+  return m_epoch[i];
+}
+
+const std::vector<uint32_t> &
+YansWifiChannel::FindReceivers (Vector position) const
+{
+  // A PHY moves at most m_maxSpeed meters per second away from the position
+  // it has been sorted in with, which may not exceed half a cell
+  if (!m_gridValid || m_cellSize != m_maxRange
+      || (Simulator::Now () - m_gridRefreshed).GetSeconds () * m_maxSpeed > m_cellSize / 2)
+    {
+      RefreshGrid ();
+    }
+  double radius = m_maxRange + m_cellSize / 2;
+  Cell low = GetCell (Vector (position.x - radius, position.y - radius, 0));
+  Cell high = GetCell (Vector (position.x + radius, position.y + radius, 0));
+  m_receivers.clear ();
+  for (int32_t x = low.first; x <= high.first; x++)
+    {
+      for (int32_t y = low.second; y <= high.second; y++)
+        {
+          Grid::const_iterator cell = m_grid.find (std::make_pair (x, y));
+          if (cell != m_grid.end ())
             {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              m_receivers.insert (m_receivers.end (), cell->second.begin (), cell->second.end ());
             }
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, rxPowerDbm, txVector, preamble);
         }
     }
+  std::sort (m_receivers.begin (), m_receivers.end ());
+  return m_receivers;
+}
+
+void
+YansWifiChannel::RefreshGrid (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_maxRange > 0);
+  for (uint32_t i = m_phyMobility.size (); i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeBoundCallback (&YansWifiChannel::CourseChanged, this, i));
+      m_phyMobility.push_back (mobility);
+    }
+  m_cellSize = m_maxRange;
+  m_grid.clear ();
+  m_phyCell.resize (m_phyList.size ());
+  m_maxSpeed = 0;
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      Vector velocity = m_phyMobility[i]->GetVelocity ();
+      m_maxSpeed = std::max (m_maxSpeed, std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z));
+      m_phyCell[i] = GetCell (m_phyMobility[i]->GetPosition ());
+      m_grid[m_phyCell[i]].push_back (i);
+    }
+  m_gridRefreshed = Simulator::Now ();
+  m_gridValid = true;
+}
+
+YansWifiChannel::Cell
+YansWifiChannel::GetCell (Vector position) const
+{
+  return std::make_pair ((int32_t) std::floor (position.x / m_cellSize), (int32_t) std::floor (position.y / m_cellSize));
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+YansWifiChannel::CourseChanged (const YansWifiChannel *channel, uint32_t i, Ptr<const MobilityModel> mobility)
+{
+  if (!channel->m_gridValid)
+    {
+      return;
+    }
+  Vector velocity = mobility->GetVelocity ();
+  channel->m_maxSpeed = std::max (channel->m_maxSpeed, std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z));
+  Cell cell = channel->GetCell (mobility->GetPosition ());
+  if (cell != channel->m_phyCell[i])
+    {
+      std::vector<uint32_t> &old = channel->m_grid[channel->m_phyCell[i]];
+      old.erase (std::find (old.begin (), old.end (), i));
+      channel->m_grid[cell].push_back (i);
+      channel->m_phyCell[i] = cell;
+    }
+}
+
+void
+YansWifiChannel::Receive (uint32_t i, Ptr<const Packet> packet, double rxPowerDbm,
                           WifiTxVector txVector, WifiPreamble preamble) const
 {
   m_phyList[i]->StartReceivePacket (packet, rxPowerDbm, txVector, preamble);
 }
 
+void
+YansWifiChannel::ReceiveBatch (Ptr<Batch> batch, uint32_t begin, uint32_t end) const
+{
+  uint32_t context = Simulator::GetContext ();
+  for (uint32_t i = begin; i < end; i++)
+    {
+      const Delivery &delivery = batch->deliveries[i];
+      Ptr<YansWifiPhy> phy = m_phyList[delivery.phy];
+      // Receptions which notify the listeners of a PHY have to start within
+      // the context of its node, all others start right away
+      uint32_t node = GetNodeId (delivery.phy);
+      if (node == context || phy->IsInterferenceOnly (delivery.rxPowerDbm))
+        {
+          phy->StartReceivePacket (batch->packet, delivery.rxPowerDbm, batch->txVector, batch->preamble);
+        }
+      else
+        {
+          Simulator::ScheduleWithContext (node, Seconds (0), &YansWifiChannel::Receive, this,
+                                          delivery.phy, batch->packet, delivery.rxPowerDbm, batch->txVector, batch->preamble);
+        }
+    }
+}
+
 uint32_t
 YansWifiChannel::GetNDevices (void) const
 {
@@ -135,7 +466,10 @@ YansWifiChannel::GetDevice (uint32_t i) const
 void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
+  m_phyIndex[PeekPointer (phy)] = m_phyList.size ();
   m_phyList.push_back (phy);
+  m_gridValid = false;
+  m_pathLoss.clear ();
 }
 
 int64_t
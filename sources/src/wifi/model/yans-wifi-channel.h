@@ -21,8 +21,12 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
 #include "wifi-channel.h"
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
@@ -31,6 +35,7 @@
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
@@ -46,6 +51,31 @@ class YansWifiPhy;
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * By default, every transmission is delivered to every other PHY on the same
+ * channel number. If the MaxRange attribute is set, the PHYs are kept in a
+ * uniform grid of their positions (refreshed whenever a mobility model notifies
+ * a course change, and periodically for moving PHYs) and only PHYs within the
+ * maximum range of the sender are visited. If the MinRxPower attribute is set,
+ * receptions below that power are not scheduled at all. Both only make sense
+ * if the propagation loss model guarantees that such receivers cannot detect
+ * the transmission.
+ *
+ * By default, every reception is a separate event. If the DeliveryBucket
+ * attribute is set, the receptions of a transmission whose delays fall into the
+ * same bucket are delivered by a single event at the smallest delay of the
+ * bucket, which moves receptions earlier by less than the bucket size. The
+ * event runs in the context of the node of the first PHY of the bucket. A
+ * reception at another PHY starts directly if it only adds to the interference
+ * (see YansWifiPhy::IsInterferenceOnly), otherwise it is scheduled within the
+ * context of the node of that PHY, since it notifies the listeners of the PHY.
+ *
+ * If the PathLossCache attribute is set, the receive power calculated by the
+ * deterministic models at the beginning of the propagation loss chain (see
+ * PropagationLossModel::IsDeterministic) is kept for every pair of PHYs until
+ * one of them moves more than PathLossCacheThreshold meters, the models after
+ * them are evaluated for every transmission. The cache takes 24 bytes for every
+ * pair of PHYs.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -100,13 +130,148 @@ private:
   YansWifiChannel (const YansWifiChannel &);
 
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
-  void Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+  typedef std::pair<int32_t, int32_t> Cell;
+  typedef std::map<Cell, std::vector<uint32_t> > Grid;
+
+  struct PathLoss
+  {
+    double txPowerDbm;
+    double rxPowerDbm;
+    uint32_t senderEpoch;
+    uint32_t receiverEpoch;
+  };
+  struct Delivery
+  {
+    uint32_t phy;
+    double rxPowerDbm;
+    Time delay;
+  };
+  /**
+   * The receptions of a transmission, ordered by their delay bucket. Each
+   * bucket is delivered by its own event.
+   */
+  struct Batch : public SimpleRefCount<Batch>
+  {
+    Ptr<const Packet> packet;
+    WifiTxVector txVector;
+    WifiPreamble preamble;
+    std::vector<Delivery> deliveries;
+  };
+  /**
+   * Orders deliveries by their delay bucket.
+   */
+  class DeliveryBucketLess
+  {
+  public:
+    DeliveryBucketLess (Time bucket)
+      : m_bucket (bucket.GetTimeStep ())
+    {
+    }
+    bool operator () (const Delivery &a, const Delivery &b) const
+    {
+      return a.delay.GetTimeStep () / m_bucket < b.delay.GetTimeStep () / m_bucket;
+    }
+  private:
+    int64_t m_bucket;
+  };
+
+  void Receive (uint32_t i, Ptr<const Packet> packet, double rxPowerDbm,
                 WifiTxVector txVector, WifiPreamble preamble) const;
+  /**
+   * Starts the receptions of one delay bucket.
+   *
+   * \param batch the receptions of the transmission
+   * \param begin the index of the first reception of the bucket
+   * \param end the index after the last reception of the bucket
+   */
+  void ReceiveBatch (Ptr<Batch> batch, uint32_t begin, uint32_t end) const;
+  /**
+   * \param i the index of a PHY
+   * \return the id of the node of the PHY, or 0xffffffff if it has no device.
+   */
+  uint32_t GetNodeId (uint32_t i) const;
+  /**
+   * \param sender the index of the sending PHY
+   * \param receiver the index of the receiving PHY
+   * \param txPowerDbm the transmit power
+   * \param a the mobility model of the sender
+   * \param b the mobility model of the receiver
+   * \return the receive power, using the path loss cache if enabled.
+   */
+  double CalcRxPower (uint32_t sender, uint32_t receiver, double txPowerDbm,
+                      Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * \return whether the path loss cache is enabled and small enough for the
+   * number of PHYs.
+   */
+  bool UsePathLossCache (void) const;
+  /**
+   * \param i the index of a PHY
+   * \param position the current position of the PHY
+   * \return the number of times the PHY moved farther than the cache
+   * threshold, which invalidates all cached path losses to and from it.
+   */
+  uint32_t GetEpoch (uint32_t i, Vector position) const;
 
+  /**
+   * \param position the position of the sender
+   * \return the indices of all PHYs that might be within the maximum range
+   * of the given position, in increasing order.
+   */
+  const std::vector<uint32_t> & FindReceivers (Vector position) const;
+  /**
+   * Sorts all PHYs into the grid cells of their current positions.
+   */
+  void RefreshGrid (void) const;
+  /**
+   * \param position a position
+   * \return the grid cell which contains the position.
+   */
+  Cell GetCell (Vector position) const;
+  /**
+   * Moves the PHY with the given index to the grid cell of its new position.
+   *
+   * \param channel the channel
+   * \param i the index of the PHY
+   * \param mobility the mobility model of the PHY
+   */
+  static void CourseChanged (const YansWifiChannel *channel, uint32_t i, Ptr<const MobilityModel> mobility);
 
   PhyList m_phyList;
   Ptr<PropagationLossModel> m_loss;
   Ptr<PropagationDelayModel> m_delay;
+  double m_maxRange;
+  double m_minRxPowerDbm;
+  Time m_deliveryBucket;
+  // Receivers of the current transmission, whose propagation loss is
+  // calculated at once
+  mutable std::vector<uint32_t> m_batchPhys;
+  mutable std::vector<Ptr<MobilityModel> > m_batchMobility;
+  mutable std::vector<double> m_batchX;
+  mutable std::vector<double> m_batchY;
+  mutable std::vector<double> m_batchZ;
+  mutable std::vector<double> m_batchRxPowerDbm;
+  std::map<const YansWifiPhy *, uint32_t> m_phyIndex;
+  bool m_pathLossCache;
+  double m_pathLossThreshold;
+  uint32_t m_pathLossCacheSize;
+  mutable Ptr<PropagationLossModel> m_cachedLoss;
+  mutable uint64_t m_cachedEpoch;   // change epoch of m_cachedLoss when the cache was filled
+  mutable Ptr<PropagationLossModel> m_uncachedLoss;
+  mutable std::vector<PathLoss> m_pathLoss;
+  mutable std::vector<uint32_t> m_epoch;
+  mutable std::vector<Vector> m_anchor;
+
+  // The grid is built lazily at the first transmission, since the mobility
+  // models are usually aggregated to the nodes after the PHYs have been added.
+  mutable bool m_gridValid;
+  mutable double m_cellSize;
+  mutable Grid m_grid;
+  mutable std::vector<Cell> m_phyCell;
+  mutable std::vector<Ptr<MobilityModel> > m_phyMobility;
+  mutable double m_maxSpeed;
+  mutable Time m_gridRefreshed;
+  mutable std::vector<uint32_t> m_receivers;
 };
 
 } // namespace ns3
@@ -448,7 +448,7 @@ YansWifiPhy::SetReceiveErrorCallback (RxErrorCallback callback)
   m_state->SetReceiveErrorCallback (callback);
 }
 void
-YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
+YansWifiPhy::StartReceivePacket (Ptr<const Packet> packet,
                                  double rxPowerDbm,
                                  WifiTxVector txVector,
                                  enum WifiPreamble preamble)
@@ -521,7 +521,7 @@ WifiMode txMode=txVector.GetMode();
           NotifyRxBegin (packet);
           m_interference.NotifyRxStart ();
           m_endRxEvent = Simulator::Schedule (rxDuration, &YansWifiPhy::EndReceive, this,
-                                              packet,
+                                              packet->Copy (),
                                               event);
         }
       else
@@ -549,6 +549,27 @@ maybeCcaBusy:
     }
 }
 
+bool
+YansWifiPhy::IsInterferenceOnly (double rxPowerDbm) const
+{
+  double rxPowerW = DbmToW (rxPowerDbm + m_rxGainDb);
+  switch (m_state->GetState ())
+    {
+    case YansWifiPhy::CCA_BUSY:
+    case YansWifiPhy::IDLE:
+      if (rxPowerW > m_edThresholdW)
+        {
+          return false;
+        }
+      break;
+    default:
+      break;
+    }
+  // Otherwise StartReceivePacket reports the medium as busy only if the
+  // energy including the packet reaches the CCA threshold
+  return m_interference.GetEnergy () + rxPowerW < m_ccaMode1ThresholdW;
+}
+
 void
 YansWifiPhy::SendPacket (Ptr<const Packet> packet, WifiMode txMode, WifiPreamble preamble, WifiTxVector txVector)
 {
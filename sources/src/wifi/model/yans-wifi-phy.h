@@ -92,10 +92,27 @@ public:
   /// Return current center channel frequency in MHz, see SetChannelNumber()
   double GetChannelFrequencyMhz () const;
 
-  void StartReceivePacket (Ptr<Packet> packet,
+  /**
+   * \param packet the packet which starts to arrive, which may be shared with
+   * other receivers and is only copied if the PHY synchronizes to it
+   * \param rxPowerDbm the receive power
+   * \param txVector the tx vector of the transmission
+   * \param preamble the preamble of the transmission
+   */
+  void StartReceivePacket (Ptr<const Packet> packet,
                            double rxPowerDbm,
                            WifiTxVector txVector,
                            WifiPreamble preamble);
+  /**
+   * A packet which arrives while the PHY cannot synchronize to it, and which
+   * does not make the medium busy, only adds to the interference. Such a
+   * reception neither changes the state of the PHY nor notifies its listeners.
+   *
+   * \param rxPowerDbm the receive power of a packet which starts to arrive now
+   * \return true if the packet only adds to the interference, false if it
+   * may change the state of the PHY.
+   */
+  bool IsInterferenceOnly (double rxPowerDbm) const;
 
   void SetRxNoiseFigure (double noiseFigureDb);
   void SetTxPowerStart (double start);
@@ -236,9 +253,11 @@ public:
   */
   virtual WifiMode McsToWifiMode (uint8_t mcs);
 
+protected:
+  virtual void DoDispose (void);
+
 private:
   YansWifiPhy (const YansWifiPhy &o);
-  virtual void DoDispose (void);
   void Configure80211a (void);
   void Configure80211b (void);
   void Configure80211g (void);
@@ -25,19 +25,28 @@
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/arf-wifi-manager.h"
+#include "ns3/constant-rate-wifi-manager.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
+#include "ns3/interference-helper.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/object-factory.h"
+#include "ns3/map-scheduler.h"
 #include "ns3/dca-txop.h"
 #include "ns3/mac-rx-middle.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
+#include <sstream>
+#include <cstdlib>
 
 namespace ns3 {
 
@@ -288,6 +297,114 @@ InterferenceHelperSequenceTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Check the noise and interference bookkeeping of InterferenceHelper: the
+ * energy durations reported while signals overlap, before and during a
+ * reception, and the SNR of a reception which started over interference.
+ */
+class InterferenceHelperEnergyDurationTest : public TestCase
+{
+public:
+  InterferenceHelperEnergyDurationTest ();
+
+  virtual void DoRun (void);
+private:
+  void AddEvent (double rxPowerW, Time duration, bool startRx);
+  void EndRx (void);
+  void CheckEnergyDuration (double energyW, Time expected);
+
+  InterferenceHelper m_interference;
+  WifiMode m_mode;
+  Ptr<InterferenceHelper::Event> m_rxEvent;
+  struct InterferenceHelper::SnrPer m_snrPer;
+};
+
+InterferenceHelperEnergyDurationTest::InterferenceHelperEnergyDurationTest ()
+  : TestCase ("InterferenceHelper energy duration and interference")
+{
+}
+
+void
+InterferenceHelperEnergyDurationTest::AddEvent (double rxPowerW, Time duration, bool startRx)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (m_mode);
+  Ptr<InterferenceHelper::Event> event = m_interference.Add (100, m_mode, WIFI_PREAMBLE_LONG,
+                                                             duration, rxPowerW, txVector);
+  if (startRx)
+    {
+      m_interference.NotifyRxStart ();
+      m_rxEvent = event;
+    }
+}
+
+void
+InterferenceHelperEnergyDurationTest::EndRx (void)
+{
+  m_snrPer = m_interference.CalculateSnrPer (m_rxEvent);
+  m_interference.NotifyRxEnd ();
+}
+
+void
+InterferenceHelperEnergyDurationTest::CheckEnergyDuration (double energyW, Time expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_interference.GetEnergyDuration (energyW), expected,
+                         "Got unexpected energy duration at " << Simulator::Now ());
+}
+
+void
+InterferenceHelperEnergyDurationTest::DoRun (void)
+{
+  m_mode = WifiPhy::GetOfdmRate6Mbps ();
+  m_interference.SetNoiseFigure (1.0);
+  m_interference.SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+
+  // two overlapping signals without reception: 1nW in [0, 100us) and
+  // 2nW in [10us, 60us)
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperEnergyDurationTest::AddEvent, this,
+                       1e-9, MicroSeconds (100), false);
+  Simulator::Schedule (MicroSeconds (0), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       0.5e-9, MicroSeconds (100));
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperEnergyDurationTest::AddEvent, this,
+                       2e-9, MicroSeconds (50), false);
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       2.5e-9, MicroSeconds (50));
+  Simulator::Schedule (MicroSeconds (10), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       0.5e-9, MicroSeconds (90));
+
+  // a reception of 1nW in [20us, 220us) which is hit by 4nW in [30us, 40us)
+  Simulator::Schedule (MicroSeconds (20), &InterferenceHelperEnergyDurationTest::AddEvent, this,
+                       1e-9, MicroSeconds (200), true);
+  Simulator::Schedule (MicroSeconds (30), &InterferenceHelperEnergyDurationTest::AddEvent, this,
+                       4e-9, MicroSeconds (10), false);
+  Simulator::Schedule (MicroSeconds (30), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       4.5e-9, MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (50), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       1.5e-9, MicroSeconds (50));
+  Simulator::Schedule (MicroSeconds (50), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       0.5e-9, MicroSeconds (170));
+  Simulator::Schedule (MicroSeconds (220), &InterferenceHelperEnergyDurationTest::EndRx, this);
+
+  // changes which expired before a new signal arrives are dropped
+  Simulator::Schedule (MicroSeconds (230), &InterferenceHelperEnergyDurationTest::AddEvent, this,
+                       1e-9, MicroSeconds (20), false);
+  Simulator::Schedule (MicroSeconds (230), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       0.5e-9, MicroSeconds (20));
+  Simulator::Schedule (MicroSeconds (260), &InterferenceHelperEnergyDurationTest::CheckEnergyDuration, this,
+                       0.5e-9, MicroSeconds (0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // the reception started over 3nW of interference
+  double noiseFloorW = 1.3803e-23 * 290.0 * m_mode.GetBandwidth ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_snrPer.snr, 1e-9 / (noiseFloorW + 3e-9), 1e-9, "Got unexpected snr");
+  // the 4nW signal overlaps the PLCP header
+  NS_TEST_EXPECT_MSG_GT (m_snrPer.per, 0.5, "Got unexpected per");
+  m_interference.EraseEvents ();
+}
+
 //-----------------------------------------------------------------------------
 /**
  * Make sure that when multiple broadcast packets are queued on the same
@@ -433,6 +550,396 @@ Bug555TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_secondTransmissionTime, expectedSecondTransmissionTime, "The second transmission time not correct!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * A map scheduler which counts the events inserted into it.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual void Insert (const Event &ev);
+
+  static uint32_t m_inserts;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+uint32_t CountingScheduler::m_inserts = 0;
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  m_inserts++;
+  MapScheduler::Insert (ev);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that culling the receivers of a transmission by their distance,
+ * and delivering the receptions in batches, does not change which PHYs start
+ * to receive it, also while they are moving. Batches have to save events.
+ */
+class YansWifiChannelCullingTest : public TestCase
+{
+public:
+  YansWifiChannelCullingTest ();
+
+  virtual void DoRun (void);
+private:
+  void RunOne (double maxRange, Time deliveryBucket);
+  Ptr<WifiNetDevice> CreateOne (Ptr<MobilityModel> mobility, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void NotifyPhyRxBegin (std::string context, Ptr<const Packet> p);
+  void NotifyPhyRxDrop (std::string context, Ptr<const Packet> p);
+
+  std::vector<uint32_t> m_rxBegin;
+  std::vector<uint32_t> m_nodes;
+  uint32_t m_rxDrop;
+  uint32_t m_wrongContext;
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : TestCase ("Culling and batched delivery of receptions in the YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelCullingTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelCullingTest::NotifyPhyRxBegin (std::string context, Ptr<const Packet> p)
+{
+  uint32_t i = atoi (context.c_str ());
+  m_rxBegin[i]++;
+  if (Simulator::GetContext () != m_nodes[i])
+    {
+      m_wrongContext++;
+    }
+}
+
+void
+YansWifiChannelCullingTest::NotifyPhyRxDrop (std::string context, Ptr<const Packet> p)
+{
+  m_rxDrop++;
+}
+
+Ptr<WifiNetDevice>
+YansWifiChannelCullingTest::CreateOne (Ptr<MobilityModel> mobility, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = CreateObject<AdhocWifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+
+  std::ostringstream index;
+  index << m_rxBegin.size ();
+  m_rxBegin.push_back (0);
+  m_nodes.push_back (node->GetId ());
+  phy->TraceConnect ("PhyRxBegin", index.str (), MakeCallback (&YansWifiChannelCullingTest::NotifyPhyRxBegin, this));
+  phy->TraceConnect ("PhyRxDrop", index.str (), MakeCallback (&YansWifiChannelCullingTest::NotifyPhyRxDrop, this));
+
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+  return dev;
+}
+
+void
+YansWifiChannelCullingTest::RunOne (double maxRange, Time deliveryBucket)
+{
+  m_rxBegin.clear ();
+  m_nodes.clear ();
+  m_rxDrop = 0;
+  m_wrongContext = 0;
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  Simulator::SetScheduler (scheduler);
+  CountingScheduler::m_inserts = 0;
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  channel->SetAttribute ("DeliveryBucket", TimeValue (deliveryBucket));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<RangePropagationLossModel> propLoss = CreateObject<RangePropagationLossModel> ();
+  propLoss->SetAttribute ("MaxRange", DoubleValue (250.0));
+  channel->SetPropagationLossModel (propLoss);
+
+  double positions[] = { 0.0, 100.0, 1000.0, 2000.0, 3000.0 };
+  Ptr<WifiNetDevice> sender;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (positions[i], 0.0, 0.0));
+      Ptr<WifiNetDevice> dev = CreateOne (mobility, channel);
+      if (i == 0)
+        {
+          sender = dev;
+        }
+    }
+  // The moving station passes the sender, speeds up and then stops far away from it
+  Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+  mobility->SetPosition (Vector (1500.0, 10.0, 0.0));
+  mobility->SetVelocity (Vector (-100.0, 0.0, 0.0));
+  CreateOne (mobility, channel);
+  Simulator::Schedule (Seconds (17.05), &ConstantVelocityMobilityModel::SetVelocity, mobility, Vector (-200.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (25.05), &ConstantVelocityMobilityModel::SetVelocity, mobility, Vector (0.0, 0.0, 0.0));
+
+  for (uint32_t i = 1; i < 40; i++)
+    {
+      Simulator::Schedule (Seconds (i), &YansWifiChannelCullingTest::SendOnePacket, this, sender);
+    }
+  Simulator::Stop (Seconds (41.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  RunOne (0.0, Seconds (0));
+  std::vector<uint32_t> expected = m_rxBegin;
+  uint32_t drops = m_rxDrop;
+  uint32_t events = CountingScheduler::m_inserts;
+  RunOne (300.0, Seconds (0));
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.size (), expected.size (), "Both runs should have the same number of PHYs");
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxBegin[i], expected[i], "PHY " << i << " should receive the same packets with culling");
+    }
+  NS_TEST_EXPECT_MSG_GT (expected[5], 0, "The moving station should have received packets while passing the sender");
+  NS_TEST_EXPECT_MSG_LT (m_rxDrop, drops, "Distant receivers should not have been visited with culling");
+
+  // All receivers are within 10 microseconds of the sender
+  RunOne (0.0, MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.size (), expected.size (), "Both runs should have the same number of PHYs");
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxBegin[i], expected[i], "PHY " << i << " should receive the same packets in batches");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_rxDrop, drops, "All receivers should have been visited in batches");
+  NS_TEST_EXPECT_MSG_EQ (m_wrongContext, 0, "Every reception should start within the context of its node");
+  // Each of the 39 packets reaches at most two PHYs within range, the
+  // receptions of the other PHYs have to share the event of the batch
+  NS_TEST_EXPECT_MSG_LT (CountingScheduler::m_inserts, events - 3 * 39, "Every batch should save the events of the receivers out of range");
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * A propagation loss model with a fixed loss, which counts how often it has
+ * been evaluated.
+ */
+class CountingPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::CountingPropagationLossModel")
+      .SetParent<PropagationLossModel> ()
+    ;
+    return tid;
+  }
+  CountingPropagationLossModel (bool deterministic)
+    : m_deterministic (deterministic),
+      m_loss (30.0),
+      m_calls (0)
+  {
+  }
+  void SetLoss (double loss)
+  {
+    m_loss = loss;
+    NotifyChange ();
+  }
+  virtual bool IsDeterministic (void) const
+  {
+    return m_deterministic;
+  }
+  uint32_t GetCalls (void) const
+  {
+    return m_calls;
+  }
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    m_calls++;
+    return txPowerDbm - m_loss;
+  }
+  virtual int64_t DoAssignStreams (int64_t stream)
+  {
+    return 0;
+  }
+  bool m_deterministic;
+  double m_loss;
+  mutable uint32_t m_calls;
+};
+
+/**
+ * Make sure that the path loss cache only evaluates the deterministic models
+ * again once a PHY has moved or a model has changed, and that it does not
+ * change the receptions.
+ */
+class YansWifiChannelPathLossCacheTest : public TestCase
+{
+public:
+  YansWifiChannelPathLossCacheTest ();
+
+  virtual void DoRun (void);
+private:
+  void RunOne (bool cache, uint32_t cacheSize);
+  void CreateOne (Ptr<MobilityModel> mobility, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void NotifyPhyRxBegin (Ptr<const Packet> p);
+
+  Ptr<WifiNetDevice> m_sender;
+  uint32_t m_rxBegin;
+  uint32_t m_deterministicCalls;
+  uint32_t m_randomCalls;
+};
+
+YansWifiChannelPathLossCacheTest::YansWifiChannelPathLossCacheTest ()
+  : TestCase ("Path loss cache of the YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelPathLossCacheTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelPathLossCacheTest::NotifyPhyRxBegin (Ptr<const Packet> p)
+{
+  m_rxBegin++;
+}
+
+void
+YansWifiChannelPathLossCacheTest::CreateOne (Ptr<MobilityModel> mobility, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = CreateObject<AdhocWifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  phy->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&YansWifiChannelPathLossCacheTest::NotifyPhyRxBegin, this));
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+  if (m_sender == 0)
+    {
+      m_sender = dev;
+    }
+}
+
+void
+YansWifiChannelPathLossCacheTest::RunOne (bool cache, uint32_t cacheSize)
+{
+  m_sender = 0;
+  m_rxBegin = 0;
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("PathLossCache", BooleanValue (cache));
+  channel->SetAttribute ("PathLossCacheSize", UintegerValue (cacheSize));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<CountingPropagationLossModel> deterministic = CreateObject<CountingPropagationLossModel> (true);
+  Ptr<CountingPropagationLossModel> random = CreateObject<CountingPropagationLossModel> (false);
+  deterministic->SetNext (random);
+  channel->SetPropagationLossModel (deterministic);
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (10.0 * i, 0.0, 0.0));
+      CreateOne (mobility, channel);
+    }
+  Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+  mobility->SetPosition (Vector (0.0, 10.0, 0.0));
+  mobility->SetVelocity (Vector (1.0, 0.0, 0.0));
+  CreateOne (mobility, channel);
+
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      Simulator::Schedule (Seconds (i), &YansWifiChannelPathLossCacheTest::SendOnePacket, this, m_sender);
+    }
+  // A change of the model invalidates all cached path losses
+  Simulator::Schedule (Seconds (5.5), &CountingPropagationLossModel::SetLoss, deterministic, 20.0);
+  Simulator::Stop (Seconds (11.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_deterministicCalls = deterministic->GetCalls ();
+  m_randomCalls = random->GetCalls ();
+}
+
+void
+YansWifiChannelPathLossCacheTest::DoRun (void)
+{
+  RunOne (false, 16);
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin, 30, "All receivers should have received all packets");
+  NS_TEST_EXPECT_MSG_EQ (m_deterministicCalls, 30, "The deterministic model should be evaluated for every reception");
+  NS_TEST_EXPECT_MSG_EQ (m_randomCalls, 30, "The random model should be evaluated for every reception");
+
+  RunOne (true, 16);
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin, 30, "All receivers should have received all packets with the cache");
+  NS_TEST_EXPECT_MSG_EQ (m_deterministicCalls, 14, "The deterministic model should only be evaluated again for the moving receiver "
+                         "and once the model has changed");
+  NS_TEST_EXPECT_MSG_EQ (m_randomCalls, 30, "The random model should still be evaluated for every reception");
+
+  RunOne (true, 15);
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin, 30, "All receivers should have received all packets without a cache of sufficient size");
+  NS_TEST_EXPECT_MSG_EQ (m_deterministicCalls, 30, "A channel with more PHY pairs than the cache size should not use the cache");
+
+  // The attributes of the deterministic models advance the change epoch
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<RangePropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  logDistance->SetNext (range);
+  uint64_t epoch = logDistance->GetChangeEpoch ();
+  logDistance->SetAttribute ("Exponent", DoubleValue (2.0));
+  NS_TEST_EXPECT_MSG_GT (logDistance->GetChangeEpoch (), epoch, "Setting the exponent should change the epoch");
+  epoch = logDistance->GetChangeEpoch ();
+  range->SetAttribute ("MaxRange", DoubleValue (100.0));
+  NS_TEST_EXPECT_MSG_GT (logDistance->GetChangeEpoch (), epoch, "Changing a chained model should change the epoch of the chain");
+}
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -446,7 +953,10 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new WifiTest, TestCase::QUICK);
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); // Bug 991
+  AddTestCase (new InterferenceHelperEnergyDurationTest, TestCase::QUICK);
   AddTestCase (new Bug555TestCase, TestCase::QUICK); // Bug 555
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelPathLossCacheTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
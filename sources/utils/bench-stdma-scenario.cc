@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * End-to-end benchmark of a STDMA highway scenario. The number of vehicles is
+ * swept over a list of values, each value is simulated in a child process of
+ * its own such that the reported peak resident set size refers to that run
+ * only. For each run the wall clock time, the number of simulator events per
+ * wall clock second and the peak RSS are reported.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/stdma-module.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/on-off-helper.h"
+
+using namespace ns3;
+
+/**
+ * Default scheduler of the simulator that additionally counts the number of executed events
+ */
+class CountingMapScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual Event RemoveNext (void);
+  static uint64_t m_events;
+};
+
+uint64_t CountingMapScheduler::m_events = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingMapScheduler);
+
+TypeId
+CountingMapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingMapScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CountingMapScheduler> ();
+  return tid;
+}
+
+Scheduler::Event
+CountingMapScheduler::RemoveNext (void)
+{
+  m_events++;
+  return MapScheduler::RemoveNext ();
+}
+
+static void
+RunScenario (uint32_t nodes, double length, double duration, uint32_t rate, bool slotChannel)
+{
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::CountingMapScheduler");
+  Simulator::SetScheduler (factory);
+  SeedManager::SetSeed (1);
+
+  stdma::StdmaHelper stdma;
+  stdma.SetStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  stdma::StdmaMacHelper stdmaMac = stdma::StdmaMacHelper::Default ();
+  Config::SetDefault ("stdma::StdmaMac::FrameDuration", TimeValue (Seconds (1.0)));
+  Config::SetDefault ("stdma::StdmaMac::MaximumPacketSize", UintegerValue (400));
+  Config::SetDefault ("stdma::StdmaMac::ReportRate", UintegerValue (rate));
+
+  NodeContainer c;
+  c.Create (nodes);
+
+  if (slotChannel)
+    {
+      Ptr<stdma::StdmaSlotChannel> channel = CreateObject<stdma::StdmaSlotChannel> ();
+      Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
+      loss->SetAttribute ("Exponent", DoubleValue (1.85));
+      loss->SetAttribute ("ReferenceLoss", DoubleValue (59.7));
+      channel->SetPropagationLossModel (loss);
+      stdma::StdmaSlotPhyHelper slotPhy = stdma::StdmaSlotPhyHelper::Default ();
+      slotPhy.SetChannel (channel);
+      stdma.Install (slotPhy, stdmaMac, c);
+    }
+  else
+    {
+      YansWifiChannelHelper wifiChannel;
+      wifiChannel.AddPropagationLoss ("ns3::LogDistancePropagationLossModel",
+                                      "Exponent", DoubleValue (1.85),
+                                      "ReferenceLoss", DoubleValue (59.7));
+      wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+      YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+      wifiPhy.SetChannel (wifiChannel.Create ());
+      stdma.Install (wifiPhy, stdmaMac, c);
+    }
+
+  // Vehicles are placed uniformly at random along a highway with four lanes
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      positions->Add (Vector (x->GetValue (0, length), 4.0 * (i % 4), 0.0));
+    }
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (c);
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (c);
+  PacketSocketAddress socket;
+  socket.SetAllDevices ();
+  socket.SetPhysicalAddress (Mac48Address::GetBroadcast ());
+  socket.SetProtocol (1);
+
+  OnOffHelper onOff ("ns3::PacketSocketFactory", Address (socket));
+  onOff.SetAttribute ("PacketSize", UintegerValue (300));
+  onOff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+  onOff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+  std::ostringstream dataRate;
+  dataRate << (300 * 8 * rate) << "b/s";
+  onOff.SetAttribute ("DataRate", DataRateValue (DataRate (dataRate.str ())));
+  ApplicationContainer apps = onOff.Install (c);
+  apps.Start (Seconds (0.0));
+  apps.Stop (Seconds (duration));
+
+  Simulator::Stop (Seconds (duration));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  double elapsed = clock.End () / 1000.0;
+  Simulator::Destroy ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  std::cout << std::setw (8) << nodes
+            << std::setw (12) << std::fixed << std::setprecision (2) << elapsed
+            << std::setw (14) << CountingMapScheduler::m_events
+            << std::setw (14) << std::setprecision (0) << (CountingMapScheduler::m_events / std::max (elapsed, 0.001))
+            << std::setw (14) << (usage.ru_maxrss / 1024.0)
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string sweep = "100,1000,10000";
+  double length = 5000;
+  double duration = 5.0;
+  uint32_t rate = 10;
+  bool slotChannel = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark a STDMA highway scenario for a varying number of vehicles.\n");
+  cmd.AddValue ("nodes", "comma separated list of node counts", sweep);
+  cmd.AddValue ("length", "length of the highway in meters", length);
+  cmd.AddValue ("duration", "simulated time in seconds", duration);
+  cmd.AddValue ("rate", "report rate, i.e. number of transmissions per second", rate);
+  cmd.AddValue ("slot-channel", "use the slot-level abstract channel instead of the YansWifiChannel", slotChannel);
+  cmd.Parse (argc, argv);
+
+  std::vector<uint32_t> counts;
+  std::istringstream list (sweep);
+  std::string item;
+  while (std::getline (list, item, ','))
+    {
+      counts.push_back (atoi (item.c_str ()));
+    }
+
+  std::cout << std::setw (8) << "nodes" << std::setw (12) << "wall [s]" << std::setw (14) << "events"
+            << std::setw (14) << "events/s" << std::setw (14) << "peak RSS [MB]" << std::endl;
+  std::cout.flush ();
+  for (uint32_t i = 0; i < counts.size (); i++)
+    {
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "fork() failed");
+      if (pid == 0)
+        {
+          RunScenario (counts[i], length, duration, rate, slotChannel);
+          std::cout.flush ();
+          _exit (0);
+        }
+      int status;
+      waitpid (pid, &status, 0);
+      NS_ABORT_MSG_IF (!WIFEXITED (status) || WEXITSTATUS (status) != 0, "run with " << counts[i] << " nodes failed");
+    }
+  return 0;
+}
@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Microbenchmark of the hot paths of the STDMA slot manager: initial slot
+ * reservation, re-reservation, network entry, CCA busy marking and frame
+ * rollover. For each operation the wall clock time and the number of heap
+ * allocations per operation are reported.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <time.h>
+#include <new>
+
+#include "ns3/core-module.h"
+#include "ns3/stdma-slot-manager.h"
+
+using namespace ns3;
+
+// Every heap allocation performed by the process is counted
+static uint64_t g_allocations = 0;
+
+void *
+operator new (size_t size)
+{
+  g_allocations++;
+  void *p = malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+// Not inlined, such that the compiler does not pair the free below with the new expressions of the callers
+void __attribute__ ((noinline))
+operator delete (void *p) throw ()
+{
+  free (p);
+}
+
+static double
+GetNanoSecondsNow (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+class BenchStdma
+{
+public:
+  BenchStdma (uint32_t slots, uint32_t rate, double occupancy, uint32_t managers, uint32_t iterations);
+  void Run (void);
+
+private:
+  Ptr<stdma::StdmaSlotManager> CreateManager (void);
+  void Report (std::string name, double start, uint64_t allocations, uint64_t ops);
+  void RunManagerBenchmarks (void);
+  void BenchReservation (void);
+  void BenchReReservation (void);
+  void BenchNetworkEntry (void);
+  void BenchCcaBusy (void);
+  void BenchRollover (void);
+  void Rollover (Ptr<stdma::StdmaSlotManager> manager, uint32_t left);
+
+  uint32_t m_slots;
+  uint32_t m_rate;
+  double m_occupancy;
+  uint32_t m_managers;
+  uint32_t m_iterations;
+  Time m_slotDuration;
+  Ptr<UniformRandomVariable> m_rng;
+  std::vector<Ptr<stdma::StdmaSlotManager> > m_reserved;
+};
+
+BenchStdma::BenchStdma (uint32_t slots, uint32_t rate, double occupancy, uint32_t managers, uint32_t iterations)
+  : m_slots (slots),
+    m_rate (rate),
+    m_occupancy (occupancy),
+    m_managers (managers),
+    m_iterations (iterations),
+    m_slotDuration (MicroSeconds (566))
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+}
+
+Ptr<stdma::StdmaSlotManager>
+BenchStdma::CreateManager (void)
+{
+  Ptr<stdma::StdmaSlotManager> manager = CreateObject<stdma::StdmaSlotManager> ();
+  manager->Setup (Seconds (0), NanoSeconds (m_slotDuration.GetNanoSeconds () * m_slots), m_slotDuration, 4);
+  manager->SetReportRate (m_rate);
+  manager->SetSelectionIntervalRatio (0.2);
+  manager->SetPosition (Vector (0, 0, 0));
+
+  // Occupy the requested fraction of the frame by other stations at random distances
+  for (uint32_t i = 0; i < m_slots; i++)
+    {
+      if (m_rng->GetValue () < m_occupancy)
+        {
+          uint8_t mac[6] = { 0, 0, 0, 0, (uint8_t) (i >> 8), (uint8_t) i };
+          Mac48Address owner;
+          owner.CopyFrom (mac);
+          manager->MarkSlotAsAllocated (i, 8, owner, Vector (m_rng->GetValue (0, 1000), 0, 0));
+        }
+    }
+  return manager;
+}
+
+void
+BenchStdma::Report (std::string name, double start, uint64_t allocations, uint64_t ops)
+{
+  double elapsed = GetNanoSecondsNow () - start;
+  std::cout << std::setw (16) << std::left << name << std::right
+            << std::setw (12) << ops
+            << std::setw (14) << std::fixed << std::setprecision (1) << (elapsed / ops)
+            << std::setw (14) << std::setprecision (3) << ((double) allocations / ops)
+            << std::endl;
+}
+
+void
+BenchStdma::BenchReservation (void)
+{
+  m_reserved.clear ();
+  for (uint32_t i = 0; i < m_managers; i++)
+    {
+      m_reserved.push_back (CreateManager ());
+      m_reserved.back ()->SelectNominalSlots ();
+    }
+  uint64_t allocations = g_allocations;
+  double start = GetNanoSecondsNow ();
+  for (uint32_t i = 0; i < m_managers; i++)
+    {
+      for (uint32_t n = 0; n < m_rate; n++)
+        {
+          m_reserved[i]->SelectTransmissionSlotForReservationWithNo (n, 8);
+        }
+    }
+  Report ("reservation", start, g_allocations - allocations, (uint64_t) m_managers * m_rate);
+}
+
+void
+BenchStdma::BenchReReservation (void)
+{
+  uint64_t allocations = g_allocations;
+  double start = GetNanoSecondsNow ();
+  for (uint32_t k = 0; k < m_iterations / m_managers + 1; k++)
+    {
+      for (uint32_t i = 0; i < m_managers; i++)
+        {
+          for (uint32_t n = 0; n < m_rate; n++)
+            {
+              m_reserved[i]->ReSelectTransmissionSlotForReservationWithNo (n, 8);
+            }
+        }
+    }
+  Report ("re-reservation", start, g_allocations - allocations, (uint64_t) (m_iterations / m_managers + 1) * m_managers * m_rate);
+}
+
+void
+BenchStdma::BenchNetworkEntry (void)
+{
+  Ptr<stdma::StdmaSlotManager> manager = CreateManager ();
+  uint32_t remaining = m_slots / m_rate;
+  // Grow the scratch buffers once, as the MAC layer does during the initialization phase
+  manager->GetNetworkEntryTimestamp (remaining, 0.0);
+  uint64_t allocations = g_allocations;
+  double start = GetNanoSecondsNow ();
+  for (uint32_t k = 0; k < m_iterations; k++)
+    {
+      manager->GetNetworkEntryTimestamp (remaining, 0.0);
+    }
+  Report ("network-entry", start, g_allocations - allocations, m_iterations);
+}
+
+void
+BenchStdma::BenchCcaBusy (void)
+{
+  Ptr<stdma::StdmaSlotManager> manager = CreateManager ();
+  std::vector<uint32_t> first (m_iterations);
+  for (uint32_t k = 0; k < m_iterations; k++)
+    {
+      first[k] = m_rng->GetInteger (0, m_slots - 1);
+    }
+  uint64_t allocations = g_allocations;
+  double start = GetNanoSecondsNow ();
+  for (uint32_t k = 0; k < m_iterations; k++)
+    {
+      manager->MarkSlotRangeAsBusy (first[k], 1 + (k % 3));
+    }
+  Report ("cca-busy", start, g_allocations - allocations, m_iterations);
+}
+
+void
+BenchStdma::Rollover (Ptr<stdma::StdmaSlotManager> manager, uint32_t left)
+{
+  // Any access to the slot table at the beginning of a frame performs the rollover
+  manager->GetCurrentSlotIndex ();
+  if (left > 0)
+    {
+      Simulator::Schedule (NanoSeconds (m_slotDuration.GetNanoSeconds () * m_slots), &BenchStdma::Rollover, this, manager, left - 1);
+    }
+}
+
+void
+BenchStdma::BenchRollover (void)
+{
+  // The frames are driven by the simulator, hence the numbers include the cost of one event per frame
+  uint32_t frames = m_iterations / 100 + 1;
+  Ptr<stdma::StdmaSlotManager> manager = m_reserved.front ();
+  Simulator::Schedule (Seconds (0), &BenchStdma::Rollover, this, manager, frames - 1);
+  uint64_t allocations = g_allocations;
+  double start = GetNanoSecondsNow ();
+  Simulator::Run ();
+  Report ("rollover", start, g_allocations - allocations, frames);
+}
+
+void
+BenchStdma::RunManagerBenchmarks (void)
+{
+  BenchReservation ();
+  BenchReReservation ();
+  BenchNetworkEntry ();
+  BenchCcaBusy ();
+}
+
+void
+BenchStdma::Run (void)
+{
+  std::cout << "slots/frame = " << m_slots << ", report rate = " << m_rate << ", occupancy = " << m_occupancy << std::endl;
+  std::cout << std::setw (16) << std::left << "operation" << std::right
+            << std::setw (12) << "ops" << std::setw (14) << "ns/op" << std::setw (14) << "allocs/op" << std::endl;
+  // The slot manager is always used from within simulation events. Outside of a running simulation, every
+  // ns3::Time instance would additionally be recorded for a potential change of the time resolution.
+  Simulator::Schedule (Seconds (0), &BenchStdma::RunManagerBenchmarks, this);
+  Simulator::Run ();
+  BenchRollover ();
+  m_reserved.clear ();
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t slots = 1766;
+  uint32_t rate = 10;
+  double occupancy = 0.5;
+  uint32_t managers = 1000;
+  uint32_t iterations = 1000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the hot paths of the STDMA slot manager.\n");
+  cmd.AddValue ("slots", "number of slots per frame", slots);
+  cmd.AddValue ("rate", "report rate, i.e. number of transmissions per frame", rate);
+  cmd.AddValue ("occupancy", "fraction of the slots allocated by other stations", occupancy);
+  cmd.AddValue ("managers", "number of slot managers used for the (re-)reservations", managers);
+  cmd.AddValue ("iterations", "number of operations per benchmark", iterations);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (rate == 0 || slots < rate, "the report rate has to be between 1 and the number of slots");
+  NS_ABORT_MSG_IF (managers == 0, "at least one slot manager is required");
+
+  BenchStdma bench (slots, rate, occupancy, managers, iterations);
+  bench.Run ();
+  return 0;
+}